@@ -1,12 +1,20 @@
 #include <interpret/Runner.h>
 #include <filesystem>
 
+using Core::Engine;
 using Core::Runner;
 
 // ---------------------------------------------------------------------------------------------------------------------
 
 int main(int argc, const char* argv[])
 {
+    if (argc > 1 && std::string(argv[1]) == "--vm")
+    {
+        Runner::SetEngine(Engine::Bytecode);
+        --argc;
+        ++argv;
+    }
+
     if (argc == 2)
     {
         std::string fileName = argv[1];
@@ -0,0 +1,167 @@
+#include <regexp/CodeGenerator.h>
+#include <regexp/Lexer.h>
+
+#include <filesystem>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <optional>
+#include <sstream>
+
+using Regex::CodeGenerator;
+using Regex::Lexer;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr const char* kUsage =
+    "Usage: noname-regexgen (--pattern <regex> | --lexer <spec>) --name <name> [--namespace <namespace>]\n"
+    "                       [--kind-type <enum>] [--include <header>]... --output <header>\n";
+
+struct Arguments
+{
+    std::string pattern = {};
+    std::string lexer = {};
+    std::string output = {};
+    CodeGenerator::Options options = {};
+};
+
+std::optional<Arguments> ParseArguments(int argc, const char* argv[])
+{
+    Arguments result;
+
+    for (int idx = 1; idx + 1 < argc; idx += 2)
+    {
+        std::string option = argv[idx];
+        std::string value = argv[idx + 1];
+
+        if (option == "--pattern")
+            result.pattern = value;
+        else if (option == "--lexer")
+            result.lexer = value;
+        else if (option == "--name")
+            result.options.name = value;
+        else if (option == "--namespace")
+            result.options.nameSpace = value;
+        else if (option == "--kind-type")
+            result.options.kindType = value;
+        else if (option == "--include")
+            result.options.includes.push_back(value);
+        else if (option == "--output")
+            result.output = value;
+        else
+            return std::nullopt;
+    }
+
+    if (argc % 2 == 0 || result.pattern.empty() == result.lexer.empty() || result.output.empty())
+        return std::nullopt;
+
+    return result;
+}
+
+// A lexer spec has one rule per line, the kind of its lexemes followed by blanks and the pattern, which runs to the end
+// of the line. Rules listed first win ties. Empty lines and lines starting with # are skipped.
+std::vector<std::pair<std::string, std::string>> ReadLexerSpec(const std::string& path)
+{
+    std::ifstream file(path);
+
+    if (!file)
+        throw std::runtime_error(std::format("Error: file {} is not found.", path));
+
+    std::vector<std::pair<std::string, std::string>> result;
+    std::string line;
+
+    for (size_t number = 1; std::getline(file, line); ++number)
+    {
+        if (line.ends_with('\r'))
+            line.pop_back();
+
+        if (line.empty() || line.front() == '#')
+            continue;
+
+        auto kindEnd = line.find_first_of(" \t");
+        auto patternStart = line.find_first_not_of(" \t", kindEnd);
+
+        if (patternStart == std::string::npos)
+            throw std::runtime_error(std::format("Error: {}:{}: a rule needs a kind and a pattern.", path, number));
+
+        result.emplace_back(line.substr(0, kindEnd), line.substr(patternStart));
+    }
+
+    return result;
+}
+
+// Leaves the file alone if it is up to date already, so that what includes it is not rebuilt.
+void WriteIfChanged(const std::string& path, const std::string& contents)
+{
+    if (std::ifstream existing(path, std::ios::binary); existing)
+    {
+        std::ostringstream buffer;
+        buffer << existing.rdbuf();
+
+        if (buffer.str() == contents)
+            return;
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+
+    if (!(file << contents))
+        throw std::runtime_error(std::format("Error: cannot write file {}.", path));
+}
+
+std::string Generate(Arguments& arguments)
+{
+    std::vector<Lexer::Rule> rules;
+    std::vector<std::string> kinds;
+
+    if (arguments.lexer.empty())
+    {
+        arguments.options.source = std::format("the pattern \"{}\"", arguments.pattern);
+        rules.push_back({ arguments.pattern, 0 });
+    }
+    else
+    {
+        arguments.options.source = std::filesystem::path(arguments.lexer).filename().string();
+
+        for (auto& [kind, pattern] : ReadLexerSpec(arguments.lexer))
+        {
+            rules.push_back({ pattern, static_cast<uint32_t>(rules.size()) });
+            kinds.push_back(kind);
+        }
+    }
+
+    CodeGenerator generator(arguments.options);
+    Lexer lexer(rules);
+
+    if (arguments.lexer.empty())
+        return generator.GenerateMatcher(lexer.Dfa());
+
+    return generator.GenerateLexer(lexer.Dfa(), kinds);
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+int main(int argc, const char* argv[])
+{
+    auto arguments = ParseArguments(argc, argv);
+
+    if (!arguments.has_value())
+    {
+        std::cerr << kUsage;
+        return -1;
+    }
+
+    try
+    {
+        WriteIfChanged(arguments->output, Generate(*arguments));
+    }
+    catch (const std::exception& error)
+    {
+        std::cerr << error.what() << "\n";
+        return -1;
+    }
+
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+# ----------------------------------------------------------------------------------------------------------------------
+# MATCHERS GENERATED AT BUILD TIME
+# ----------------------------------------------------------------------------------------------------------------------
+
+# regexgen_add_header(<target> NAME <name> OUTPUT <header>
+#                     (PATTERN <regex> | LEXER <spec>)
+#                     [NAMESPACE <namespace>] [KIND_TYPE <enum>] [INCLUDES <header>...])
+#
+# Runs noname-regexgen during the build to compile a pattern or a lexer spec into a header, and adds the header to the
+# sources of the target. The header is written to the generated directory of the current binary directory, which is
+# added to the include directories of the target. A pattern must not contain a semicolon, use a lexer spec for those.
+function(regexgen_add_header TARGET)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "" "NAME;OUTPUT;PATTERN;LEXER;NAMESPACE;KIND_TYPE" "INCLUDES")
+
+    if(NOT ARG_NAME OR NOT ARG_OUTPUT
+        OR (DEFINED ARG_PATTERN AND DEFINED ARG_LEXER) OR (NOT DEFINED ARG_PATTERN AND NOT DEFINED ARG_LEXER))
+        message(FATAL_ERROR "regexgen_add_header: NAME, OUTPUT and one of PATTERN and LEXER are required.")
+    endif()
+
+    set(GENERATED_DIR ${CMAKE_CURRENT_BINARY_DIR}/generated)
+    set(OUTPUT_PATH ${GENERATED_DIR}/${ARG_OUTPUT})
+    set(ARGUMENTS --name ${ARG_NAME} --output ${OUTPUT_PATH})
+    set(DEPENDENCIES noname-regexgen)
+
+    if(DEFINED ARG_PATTERN)
+        list(APPEND ARGUMENTS --pattern "${ARG_PATTERN}")
+    else()
+        get_filename_component(SPEC_PATH ${ARG_LEXER} ABSOLUTE)
+        list(APPEND ARGUMENTS --lexer ${SPEC_PATH})
+        list(APPEND DEPENDENCIES ${SPEC_PATH})
+    endif()
+
+    if(ARG_NAMESPACE)
+        list(APPEND ARGUMENTS --namespace ${ARG_NAMESPACE})
+    endif()
+
+    if(ARG_KIND_TYPE)
+        list(APPEND ARGUMENTS --kind-type ${ARG_KIND_TYPE})
+    endif()
+
+    foreach(INCLUDE ${ARG_INCLUDES})
+        list(APPEND ARGUMENTS --include ${INCLUDE})
+    endforeach()
+
+    file(MAKE_DIRECTORY ${GENERATED_DIR})
+
+    add_custom_command(
+        OUTPUT ${OUTPUT_PATH}
+        COMMAND noname-regexgen ${ARGUMENTS}
+        DEPENDS ${DEPENDENCIES}
+        COMMENT "Generating ${ARG_OUTPUT}"
+        VERBATIM
+    )
+
+    target_sources(${TARGET} PRIVATE ${OUTPUT_PATH})
+    target_include_directories(${TARGET} PRIVATE ${GENERATED_DIR})
+endfunction()
\ No newline at end of file
@@ -0,0 +1,126 @@
+#pragma once
+#include "Common.h"
+#include "Object.h"
+#include "Token.h"
+
+namespace Core { struct Prototype; }
+
+namespace Core
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+enum class OpCode : uint8_t
+{
+    Constant,       // [u16 constant]         push constants[idx]
+    Null,           //                        push Null
+    True,           //                        push True
+    False,          //                        push False
+    Pop,            //                        drop top
+    PopResult,      //                        pop top into the result register
+    Result,         //                        copy top into the result register
+    GetLocal,       // [u8 slot]              push frame slot
+    SetLocal,       // [u8 slot]              frame slot = top
+    GetGlobal,      // [u16 global]           push global
+    SetGlobal,      // [u16 global]           global = top
+    DefineGlobal,   // [u16 global]           global = pop
+    GetUpvalue,     // [u8 upvalue]           push captured variable
+    SetUpvalue,     // [u8 upvalue]           captured variable = top
+    CloseUpvalue,   //                        hoist top into its upvalue and drop it
+    Equal,
+    NotEqual,
+    Less,
+    LessEqual,
+    More,
+    MoreEqual,
+    Add,
+    Subtract,
+    Multiply,
+    Divide,
+    Not,
+    Negate,
+    Print,          //                        print and drop top
+    Jump,           // [u16 offset]           ip += offset
+    JumpIfFalse,    // [u16 offset]           ip += offset if top is falsy (keeps top)
+    JumpIfTrue,     // [u16 offset]           ip += offset if top is truthy (keeps top)
+    PopJumpIfFalse, // [u16 offset]           pop, ip += offset if it was falsy
+    Loop,           // [u16 offset]           ip -= offset
+    Call,           // [u8 argc]              call the value below the arguments
+    MakeClosure,    // [u16 proto] [u8 isLocal, u8 index]*  wrap a prototype into a closure
+    Return          //                        leave the current frame with top as the result
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class Chunk
+{
+    Vector<uint8_t> code_ = {};
+    Vector<Object> constants_ = {};
+    Vector<Ptr<const Prototype>> prototypes_ = {};
+    std::unordered_map<size_t, Token> sites_ = {};
+
+public:
+    const uint8_t* Code() const noexcept
+    {
+        return code_.data();
+    }
+
+    size_t Size() const noexcept
+    {
+        return code_.size();
+    }
+
+    const Object& ConstantAt(size_t idx) const
+    {
+        return constants_[idx];
+    }
+
+    const Ptr<const Prototype>& PrototypeAt(size_t idx) const
+    {
+        return prototypes_[idx];
+    }
+
+public:
+    void Write(uint8_t byte)
+    {
+        code_.push_back(byte);
+    }
+
+    void Write(OpCode op)
+    {
+        code_.push_back(static_cast<uint8_t>(op));
+    }
+
+    void WriteShort(uint16_t value)
+    {
+        code_.push_back(static_cast<uint8_t>(value >> 8));
+        code_.push_back(static_cast<uint8_t>(value & 0xff));
+    }
+
+    void PatchShort(size_t offset, uint16_t value)
+    {
+        code_[offset] = static_cast<uint8_t>(value >> 8);
+        code_[offset + 1] = static_cast<uint8_t>(value & 0xff);
+    }
+
+    size_t AddConstant(const Object& value);
+
+    size_t AddPrototype(Ptr<const Prototype> proto)
+    {
+        prototypes_.push_back(std::move(proto));
+        return prototypes_.size() - 1;
+    }
+
+    // Remembers the source token of the instruction at the current offset, so that a runtime error raised by it
+    // can be reported with a line number. Only instructions that can fail are marked.
+    void MarkSite(const Token& token)
+    {
+        sites_.insert_or_assign(code_.size(), token);
+    }
+
+    Token SiteAt(size_t offset) const;
+
+    std::string Disassemble(const std::string& name) const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Core
\ No newline at end of file
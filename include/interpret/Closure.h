@@ -0,0 +1,50 @@
+#pragma once
+#include "Chunk.h"
+#include "Common.h"
+#include "Object.h"
+
+namespace Core
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct Prototype
+{
+    std::string name = {};
+    int arity = 0;
+    int upvalueCount = 0;
+    Chunk chunk = {};
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// A variable captured by a closure. While the declaring frame is alive the value lives on the VM stack at `slot`;
+// once the frame returns the value is hoisted into `closed`.
+struct Upvalue
+{
+    size_t slot = 0;
+    bool isOpen = true;
+    Object closed = {};
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+struct Closure
+{
+    Ptr<const Prototype> proto = {};
+    PtrVector<Upvalue> upvalues = {};
+
+public:
+    explicit Closure(Ptr<const Prototype> proto)
+        : proto(std::move(proto))
+    {
+        upvalues.reserve(this->proto->upvalueCount);
+    }
+
+    std::string ToString() const
+    {
+        return "<fn " + proto->name + ">";
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Core
\ No newline at end of file
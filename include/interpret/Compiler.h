@@ -0,0 +1,103 @@
+#pragma once
+#include "Closure.h"
+#include "Common.h"
+#include "Token.h"
+#include "Visitor.h"
+
+namespace Core { class VM; }
+
+namespace Core
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Lowers resolved statements into bytecode for the VM. Locals live in stack slots of the enclosing call frame,
+// variables captured by nested functions become upvalues and top-level names become global slots owned by the VM.
+class Compiler : public ExprVisitor, public StmtVisitor
+{
+    struct Local
+    {
+        std::string name = {};
+        int depth = 0;
+        bool isCaptured = false;
+    };
+
+    struct UpvalueRef
+    {
+        uint8_t index = 0;
+        bool isLocal = false;
+    };
+
+    struct FunctionState
+    {
+        FunctionState* enclosing = nullptr;
+        Ptr<Prototype> proto = {};
+        Vector<Local> locals = {};
+        Vector<UpvalueRef> upvalues = {};
+        int scopeDepth = 0;
+    };
+
+    constexpr static size_t kMaxLocals = 256;
+    constexpr static size_t kMaxIndex = UINT16_MAX;
+
+private:
+    VM& vm_;
+    FunctionState* current_ = nullptr;
+
+public:
+    explicit Compiler(VM& vm)
+        : vm_(vm)
+    {}
+
+    ~Compiler() override = default;
+
+public:
+    Ptr<const Prototype> Compile(const PtrVector<StmtAst>& statements);
+
+    void Visit(const AssignExpr* expr) override;
+    void Visit(const BinaryExpr* expr) override;
+    void Visit(const CallExpr* expr) override;
+    void Visit(const GroupingExpr* expr) override;
+    void Visit(const LiteralExpr* expr) override;
+    void Visit(const LogicalExpr* expr) override;
+    void Visit(const UnaryExpr* expr) override;
+    void Visit(const VariableExpr* expr) override;
+
+    void Visit(const BlockStmt* stmt) override;
+    void Visit(const ExpressionStmt* stmt) override;
+    void Visit(const FunctionStmt* stmt) override;
+    void Visit(const IfStmt* stmt) override;
+    void Visit(const PrintStmt* stmt) override;
+    void Visit(const ReturnStmt* stmt) override;
+    void Visit(const VarStmt* stmt) override;
+    void Visit(const WhileStmt* stmt) override;
+
+private:
+    void Compile(const Ptr<StmtAst>& stmt);
+    void Compile(const Ptr<ExprAst>& expr);
+    void CompileFunction(const FunctionStmt* stmt);
+
+    void BeginScope();
+    void EndScope();
+
+    void AddLocal(const Token& name);
+    void DefineVariable(const Token& name);
+    void EmitGet(const Token& name);
+    void EmitSet(const Token& name);
+
+    int ResolveLocal(FunctionState* state, const std::string& name) const;
+    int ResolveUpvalue(FunctionState* state, const std::string& name);
+    int AddUpvalue(FunctionState* state, uint8_t index, bool isLocal);
+
+    Chunk& CurrentChunk();
+
+    void Emit(OpCode op);
+    void Emit(OpCode op, uint8_t operand);
+    void EmitShort(OpCode op, size_t operand);
+    void EmitConstant(const Object& value);
+    void EmitLoop(size_t loopStart);
+    size_t EmitJump(OpCode op);
+    void PatchJump(size_t offset);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Core
\ No newline at end of file
@@ -2,7 +2,7 @@
 #include "ObjectType.h"
 #include "Common.h"
 
-namespace Core { class Function; }
+namespace Core { class Function; struct Closure; }
 
 namespace Core
 {
@@ -10,7 +10,7 @@ namespace Core
 
 class Object
 {
-    using Variant = std::variant<double, bool, std::string, nullptr_t, std::shared_ptr<Function>>;
+    using Variant = std::variant<double, bool, std::string, nullptr_t, std::shared_ptr<Function>, std::shared_ptr<Closure>>;
 
     Variant value_ = nullptr;
     ObjectType type_ = ObjectType::Null;
@@ -42,6 +42,11 @@ public:
         , type_(ObjectType::Function)
     {}
 
+    Object(std::shared_ptr<Closure>&& value_ptr)
+        : value_(std::move(value_ptr))
+        , type_(ObjectType::Closure)
+    {}
+
     template <typename T>
     requires std::is_convertible_v<T, double>
     Object(T value)
@@ -59,6 +64,7 @@ public:
     std::string TypeName() const;
 
     bool IsBool() const noexcept;
+    bool IsClosure() const noexcept;
     bool IsDouble() const noexcept;
     bool IsFunction() const noexcept;
     bool IsNull() const noexcept;
@@ -68,6 +74,7 @@ public:
     double ToDouble() const;
     std::string ToString() const;
     std::shared_ptr<Function> ToFunction() const;
+    std::shared_ptr<Closure> ToClosure() const;
 
     friend bool operator!(const Object& rhs);
     friend Object operator-(const Object& rhs);
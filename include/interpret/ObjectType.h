@@ -10,7 +10,8 @@ enum class ObjectType
     String,
     Bool,
     Null,
-    Function
+    Function,
+    Closure
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
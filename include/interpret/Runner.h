@@ -1,17 +1,29 @@
 #pragma once
 #include "Common.h"
+#include "Compiler.h"
 #include "Interpreter.h"
 #include "Parser.h"
 #include "Resolver.h"
 #include "Scanner.h"
+#include "VM.h"
 
 namespace Core
 {
 // ---------------------------------------------------------------------------------------------------------------------
 
+enum class Engine
+{
+    TreeWalker,
+    Bytecode
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
 class Runner
 {
     inline static Interpreter interpreter_ = {};
+    inline static VM vm_ = {};
+    inline static Engine engine_ = Engine::TreeWalker;
     inline static bool hadError_ = false;
     inline static bool hadRuntimeError_ = false;
 
@@ -27,6 +39,9 @@ public:
         if (hadError_)
             return {};
 
+        if (engine_ == Engine::Bytecode)
+            return RunBytecode(statements);
+
         Resolver resolver(interpreter_);
         resolver.Resolve(statements);
 
@@ -38,6 +53,28 @@ public:
         return interpreter_.Result();
     }
 
+    static Object RunBytecode(const PtrVector<StmtAst>& statements)
+    {
+        // The compiler does its own slot resolution, the resolver only reports semantic errors here.
+        Interpreter unused;
+        Resolver resolver(unused);
+        resolver.Resolve(statements);
+
+        // Resolution error.
+        if (hadError_)
+            return {};
+
+        Compiler compiler(vm_);
+        auto script = compiler.Compile(statements);
+
+        // Compilation error.
+        if (hadError_)
+            return {};
+
+        vm_.Interpret(script);
+        return vm_.Result();
+    }
+
     static void RunFile(const std::string& file)
     {
         std::stringstream src;
@@ -73,6 +110,17 @@ public:
     static void Reset()
     {
         interpreter_.Reset();
+        vm_.Reset();
+    }
+
+    static void SetEngine(Engine engine)
+    {
+        engine_ = engine;
+    }
+
+    static Engine CurrentEngine()
+    {
+        return engine_;
     }
 
     static void Report(size_t line, const std::string& where, const std::string& msg)
@@ -24,10 +24,6 @@ public:
 private:
     void ScanToken();
 
-    void AddNumber();
-    void AddString();
-    void AddIdentifier();
-
 private:
     bool IsAtEnd() const noexcept
     {
@@ -41,32 +37,6 @@ private:
 
         return source_[pos_];
     }
-
-    char Advance()
-    {
-        if (IsAtEnd())
-            return EOF;
-
-        ++pos_;
-        return source_[pos_ - 1];
-    }
-
-private:
-    inline const static std::unordered_map<std::string, TokenType> kwMap = {
-        {"and",    TokenType::And},
-        {"else",   TokenType::Else},
-        {"False",  TokenType::False},
-        {"for",    TokenType::For},
-        {"func",   TokenType::Func},
-        {"if",     TokenType::If},
-        {"Null",   TokenType::Null},
-        {"or",     TokenType::Or},
-        {"print",  TokenType::Print},
-        {"return", TokenType::Return},
-        {"True",   TokenType::True},
-        {"var",    TokenType::Var},
-        {"while",  TokenType::While}
-    };
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -62,8 +62,7 @@ public:
 
 public:
     static Token EndOfFile(size_t line);
-    static Token FromSymbol(char symbol, size_t line);
-    static Token FromTwoSymbols(const std::string& twoSymbols, size_t line);
+    static Token FromSymbol(TokenType type, const std::string& symbols, size_t line);
     static Token FromIdentifier(const std::string& str, size_t line);
     static Token FromKeyword(TokenType kwType, const std::string& kwStr, size_t line);
     static Token FromNumber(const std::string& str, size_t line);
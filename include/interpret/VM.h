@@ -0,0 +1,69 @@
+#pragma once
+#include "Closure.h"
+#include "Common.h"
+#include "Object.h"
+#include "Token.h"
+
+namespace Core
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Stack-based virtual machine executing prototypes produced by the Compiler. The value stack and the call-frame array
+// are allocated once, so calls and blocks do not allocate environments.
+class VM
+{
+    struct CallFrame
+    {
+        const Closure* closure = nullptr;
+        const uint8_t* ip = nullptr;
+        Object* slots = nullptr;
+    };
+
+    constexpr static size_t kFramesMax = 1024;
+    constexpr static size_t kFrameSlotsMax = 512;
+    constexpr static size_t kStackMax = 64 * 1024;
+
+private:
+    Vector<Object> stack_;
+    Object* top_ = nullptr;
+
+    Vector<CallFrame> frames_;
+    size_t frameCount_ = 0;
+
+    PtrVector<Upvalue> openUpvalues_ = {};
+
+    Vector<Object> globals_ = {};
+    Vector<bool> isDefined_ = {};
+    Vector<std::string> globalNames_ = {};
+    std::unordered_map<std::string, uint16_t> globalSlots_ = {};
+
+    Object result_;
+
+public:
+    VM();
+
+public:
+    Object Result() const;
+    void Reset();
+
+    void Interpret(const Ptr<const Prototype>& script);
+    uint16_t GlobalSlot(const std::string& name);
+
+private:
+    void Run();
+    void ResetStack();
+
+    void Call(const Object& callee, int argCount);
+    Token CurrentSite() const;
+    Ptr<Upvalue> CaptureUpvalue(Object* local);
+    void CloseUpvalues(const Object* last);
+
+    Object& UpvalueValue(Upvalue& upvalue);
+
+    static bool IsTruthy(const Object& obj);
+    static bool IsEqual(const Object& l, const Object& r);
+    static std::string Stringify(const Object& object);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Core
\ No newline at end of file
@@ -0,0 +1,116 @@
+#pragma once
+#include "AstNode.h"
+#include "ByteClasses.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Automaton over a set of literals that finds all of them in one pass over the input. Its states are the prefixes of
+// the literals, and a byte with no edge from a state goes on from the longest suffix of that state that is a prefix
+// too. Every literal carries a tag, the index of the pattern it comes from.
+//
+// Sparse automata keep the edges of the trie and follow the suffix links while searching. Dense ones resolve the links
+// up front into a table with one row per state and byte class, as long as the table stays small. Packed ones hold few
+// literals and look for all of them at once, 16 bytes at a time.
+class AhoCorasick
+{
+public:
+    using StateId = uint32_t;
+
+    enum class Kind
+    {
+        Sparse,
+        Dense,
+        Packed
+    };
+
+    struct Literal
+    {
+        std::string text = {};
+        uint32_t tag = 0;
+    };
+
+    struct Match
+    {
+        size_t offset = 0;
+        size_t length = 0;
+    };
+
+    constexpr static StateId kRoot = 0;
+
+    // Largest finite language taken for a set of literals, and largest dense table in entries.
+    constexpr static size_t kMaxLiterals = 256;
+    constexpr static size_t kMaxDenseTableSize = 1 << 18;
+    constexpr static size_t kMaxPackedLiterals = 8;
+
+private:
+    struct Edge
+    {
+        uint8_t byte = 0;
+        StateId target = 0;
+    };
+
+    Kind kind_ = Kind::Sparse;
+
+    // Trie edges sorted by byte and grouped by source state, with per-state offsets into them.
+    std::vector<Edge> edges_ = {};
+    std::vector<uint32_t> edgeOffsets_ = {};
+
+    std::vector<StateId> suffixLinks_ = {};
+    std::vector<uint32_t> depths_ = {};
+
+    // Length of the longest literal that ends the prefix of a state, 0 if none does, and the tags of the literals equal
+    // to the prefix.
+    std::vector<uint32_t> matchLengths_ = {};
+    std::vector<std::vector<uint32_t>> tags_ = {};
+
+    ByteClasses byteClasses_ = {};
+    size_t stride_ = 256;
+    std::vector<StateId> table_ = {};
+
+    // Non-empty literals of a packed automaton, longest first.
+    std::vector<std::string> packed_ = {};
+
+public:
+    explicit AhoCorasick(const std::vector<Literal>& literals);
+
+public:
+    // Leftmost-longest non-empty match starting in [from, to), the same one RegExp::FindMatches picks.
+    std::optional<Match> Find(std::string_view str, size_t from, size_t to) const;
+
+    // Same as the LazyDFA methods of the same names: tags of the literals equal to the string, and the longest literal
+    // per tag that the string starts with.
+    std::vector<uint32_t> MatchingTags(std::string_view str) const;
+    std::vector<size_t> LongestMatchPerTag(std::string_view str, size_t tagCount) const;
+
+    Kind GetKind() const noexcept;
+    size_t StateCount() const noexcept;
+
+    // Length of the longest literal.
+    size_t MaxLength() const noexcept;
+
+public:
+    // The strings a pattern matches if it matches at most kMaxLiterals strings, all of them spelled out in it: an
+    // alternation of literals, possibly factored or with optional parts and small character sets. Returns
+    // std::nullopt for any pattern with a closure or a counter.
+    static std::optional<std::vector<std::string>> Literals(const AstNode::AstNodePtr& root);
+
+private:
+    StateId Next(StateId state, uint8_t byte) const;
+
+    // Target of the trie edge, kRoot if there is none since no edge leads to the root.
+    StateId Goto(StateId state, uint8_t byte) const;
+
+    // Searches block by block while a whole block fits, moving from past the blocks without a match.
+    std::optional<Match> FindPacked(std::string_view str, size_t& from, size_t to) const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
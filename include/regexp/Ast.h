@@ -1,5 +1,6 @@
 #pragma once
 #include "AstNode.h"
+#include "Token.h"
 
 namespace Regex
 {
@@ -11,9 +12,12 @@ public:
     ~EmptyAst() override = default;
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     std::string ToString() const override;
     size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
 
 public:
     static AstNodePtr Make();
@@ -33,9 +37,18 @@ public:
     ~SymbolAst() override = default;
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     std::string ToString() const override;
     size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    char Symbol() const noexcept
+    {
+        return symbol_;
+    }
 
 public:
     static AstNodePtr Make(char symbol);
@@ -43,55 +56,110 @@ public:
 
 // ---------------------------------------------------------------------------------------------------------------------
 
+class CharSetAst final : public AstNode
+{
+    CharSet symbols_ = {};
+
+public:
+    explicit CharSetAst(const CharSet& symbols)
+        : symbols_(symbols)
+    {}
+
+    ~CharSetAst() override = default;
+
+public:
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
+    std::string ToString() const override;
+    size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const CharSet& Symbols() const noexcept
+    {
+        return symbols_;
+    }
+
+public:
+    static AstNodePtr Make(const CharSet& symbols);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
 class AlternationAst final : public AstNode
 {
-    AstNodePtr patternX_;
-    AstNodePtr patternY_;
+    AstNodeList patterns_;
 
 public:
     AlternationAst(AstNodePtr lhs, AstNodePtr rhs)
-        : patternX_(lhs)
-        , patternY_(rhs)
+        : patterns_({ lhs, rhs })
+    {}
+
+    explicit AlternationAst(AstNodeList patterns)
+        : patterns_(std::move(patterns))
     {}
 
     ~AlternationAst() override = default;
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     std::string ToString() const override;
     size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodeList& Patterns() const noexcept
+    {
+        return patterns_;
+    }
 
 public:
     static AstNodePtr Make(AstNodePtr lhs, AstNodePtr rhs);
+    static AstNodePtr Make(AstNodeList patterns);
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
 
 class ConcatenationAst final : public AstNode
 {
-    AstNodePtr patternX_;
-    AstNodePtr patternY_;
+    AstNodeList patterns_;
 
 public:
     ConcatenationAst(AstNodePtr lhs, AstNodePtr rhs)
-        : patternX_(lhs)
-        , patternY_(rhs)
+        : patterns_({ lhs, rhs })
+    {}
+
+    explicit ConcatenationAst(AstNodeList patterns)
+        : patterns_(std::move(patterns))
     {}
 
     ~ConcatenationAst() override = default;
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     size_t Precedence() const noexcept override;
     std::string ToString() const override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodeList& Patterns() const noexcept
+    {
+        return patterns_;
+    }
 
 public:
     static AstNodePtr Make(AstNodePtr lhs, AstNodePtr rhs);
+    static AstNodePtr Make(AstNodeList patterns);
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-class RepetitionAst : public AstNode
+class RepetitionAst final : public AstNode
 {
     AstNodePtr pattern_;
 
@@ -101,9 +169,18 @@ public:
     {}
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     std::string ToString() const override;
     size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodePtr& Pattern() const noexcept
+    {
+        return pattern_;
+    }
 
 public:
     static AstNodePtr Make(AstNodePtr pattern);
@@ -121,9 +198,18 @@ public:
     {}
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     size_t Precedence() const noexcept override;
     std::string ToString() const override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodePtr& Pattern() const noexcept
+    {
+        return pattern_;
+    }
 
 public:
     static AstNodePtr Make(AstNodePtr pattern);
@@ -141,13 +227,109 @@ public:
     {}
 
 public:
-    NFA ToNFA() const override;
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
     std::string ToString() const override;
     size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodePtr& Pattern() const noexcept
+    {
+        return pattern_;
+    }
 
 public:
     static AstNodePtr Make(AstNodePtr pattern);
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Pattern repeated from minCount to maxCount times, maxCount is Token::kUnbounded for {m,}.
+class CountedRepetitionAst final : public AstNode
+{
+    AstNodePtr pattern_;
+    size_t minCount_ = 0;
+    size_t maxCount_ = 0;
+
+public:
+    CountedRepetitionAst(AstNodePtr pattern, size_t minCount, size_t maxCount)
+        : pattern_(pattern)
+        , minCount_(minCount)
+        , maxCount_(maxCount)
+    {}
+
+public:
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
+    std::string ToString() const override;
+    size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodePtr& Pattern() const noexcept
+    {
+        return pattern_;
+    }
+
+    size_t MinCount() const noexcept
+    {
+        return minCount_;
+    }
+
+    size_t MaxCount() const noexcept
+    {
+        return maxCount_;
+    }
+
+    bool IsUnbounded() const noexcept
+    {
+        return maxCount_ == Token::kUnbounded;
+    }
+
+public:
+    static AstNodePtr Make(AstNodePtr pattern, size_t minCount, size_t maxCount);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Parenthesized pattern, numbered as a capture group. It builds the same automaton as the pattern itself; only the
+// submatch extraction of the RegExp tells the groups apart, the Optimizer removes them.
+class CaptureAst final : public AstNode
+{
+    AstNodePtr pattern_;
+    size_t group_ = 0;
+
+public:
+    CaptureAst(AstNodePtr pattern, size_t group)
+        : pattern_(pattern)
+        , group_(group)
+    {}
+
+public:
+    Fragment BuildNFA(NFA& nfa) const override;
+    Glushkov::Positions BuildPositions(Glushkov& glushkov) const override;
+    std::string ToString() const override;
+    size_t Precedence() const noexcept override;
+    AstType Type() const noexcept override;
+    size_t ExpandedSize() const noexcept override;
+
+public:
+    const AstNodePtr& Pattern() const noexcept
+    {
+        return pattern_;
+    }
+
+    size_t Group() const noexcept
+    {
+        return group_;
+    }
+
+public:
+    static AstNodePtr Make(AstNodePtr pattern, size_t group);
+};
+
 // ---------------------------------------------------------------------------------------------------------------------
 } // namespace Regex
\ No newline at end of file
@@ -1,4 +1,5 @@
 #pragma once
+#include "Glushkov.h"
 #include "NFA.h"
 #include <format>
 
@@ -10,16 +11,50 @@ class AstNode
 {
 public:
     using AstNodePtr = std::shared_ptr<AstNode>;
+    using AstNodeList = std::vector<AstNodePtr>;
+
+public:
+    enum class AstType
+    {
+        Empty,
+        Symbol,
+        CharSet,
+        Alternation,
+        Concatenation,
+        Repetition,
+        OneOrMore,
+        Optional,
+        CountedRepetition,
+        Capture
+    };
 
 public:
     virtual ~AstNode() = default;
 
 public:
-    virtual NFA ToNFA() const = 0;
+    // Appends the states of the node to the NFA and returns their entry and exit state.
+    virtual Fragment BuildNFA(NFA& nfa) const = 0;
+    virtual Glushkov::Positions BuildPositions(Glushkov& glushkov) const = 0;
     virtual std::string ToString() const = 0;
     virtual size_t Precedence() const noexcept = 0;
+    virtual AstType Type() const noexcept = 0;
+
+    // Number of symbols, character sets and empty strings the node compiles to, with every counted repetition expanded
+    // into its copies. Saturates at SIZE_MAX.
+    virtual size_t ExpandedSize() const noexcept = 0;
 
 public:
+    NFA ToNFA() const
+    {
+        NFA nfa(0);
+        auto fragment = BuildNFA(nfa);
+
+        nfa.SetStart(fragment.start);
+        nfa.ResetFinalStates({ fragment.end });
+
+        return nfa;
+    }
+
     virtual bool Matches(const std::string& text) const
     {
         NFA nfa = ToNFA();
@@ -0,0 +1,88 @@
+#pragma once
+#include "FullDFA.h"
+#include "PikeVM.h"
+#include "Prefilter.h"
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Binary file holding a compiled FullDFA together with the patterns it was compiled from. A RegExp file also holds
+// what its unanchored search needs, so that loading it builds nothing. The file only holds offsets, never pointers, and
+// every table is aligned, so a loaded DFA searches the memory mapping of the file directly.
+//
+// Layout, all integers in the byte order of the writing machine, every section padded to 8 bytes:
+//   header:    magic "NNREGEX", format version, byte order mark, kind, pattern section size, checksum
+//   patterns:  count, then length and bytes of every pattern
+//   search:    RegExp files only. The leftmost DFA, the reverse DFA and the reversed prefix DFA, each laid out as the
+//              DFA below; the prefilter kind, prefix length, first byte set and prefix; the capture program's
+//              instruction count, character set count, start and group count, then its instructions as op code,
+//              next and argument, and its character sets
+//   DFA:       state count, class count, start state, first final state, tag count, then the 256 byte classes,
+//              the transition table, the per-state tag offsets and the tags
+//
+// Files of another format version or another byte order are rejected, and so are files whose header, pattern table,
+// DFA tables or capture program do not fit together, so that no search can leave the tables. The checksum is the
+// FNV-1a hash of everything after the header; it is only compared on request, as hashing reads the whole file where
+// the checks above do not.
+class AutomatonFile
+{
+public:
+    enum class Kind : uint32_t
+    {
+        RegExp = 1,
+        RegexSet = 2
+    };
+
+    // Structure only runs the checks every search relies on, Checksum also hashes the file to find damage in it.
+    enum class Verify
+    {
+        Structure,
+        Checksum
+    };
+
+    constexpr static uint32_t kVersion = 2;
+
+    // Unanchored search of a RegExp: the DFAs RegExp::FindMatches runs, the one StreamMatcher trims its buffer with,
+    // and the submatch extraction of a pattern with groups.
+    struct Search
+    {
+        FullDFA leftmostDfa;
+        FullDFA reverseDfa;
+        FullDFA prefixDfa;
+        Prefilter prefilter = {};
+        std::optional<CaptureProgram> captures = {};
+    };
+
+    struct Contents
+    {
+        std::vector<std::string> patterns = {};
+        FullDFA dfa;
+
+        // Always there in RegExp files, never in the others.
+        std::optional<Search> search = {};
+    };
+
+public:
+    static void Write(const std::string& path, Kind kind, const std::vector<std::string>& patterns, const FullDFA& dfa,
+        const Search* search = nullptr);
+    static Contents Read(const std::string& path, Kind kind, Verify verify = Verify::Structure);
+
+private:
+    class Reader;
+
+    static void AppendDfa(std::string& bytes, const FullDFA& dfa);
+    static void AppendSearch(std::string& bytes, const Search& search);
+
+    // Tags of the DFA have to be less than the tag count.
+    static FullDFA ReadDfa(Reader& reader, size_t tagCount);
+    static Search ReadSearch(Reader& reader);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -0,0 +1,58 @@
+#pragma once
+#include "CharSet.h"
+
+#include <array>
+#include <cstdint>
+#include <optional>
+#include <span>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Partition of the 256 byte values into classes that no character set of a pattern tells apart. Automaton tables are
+// indexed by class instead of by byte, so they are only as wide as the number of classes.
+class ByteClasses
+{
+    std::array<uint8_t, 256> classes_ = {};
+    std::array<uint8_t, 256> representatives_ = {};
+    size_t count_ = 1;
+
+public:
+    ByteClasses() = default;
+
+public:
+    // Splits every class that has bytes both inside and outside of the set.
+    void Add(const CharSet& set);
+
+    uint8_t operator[](uint8_t byte) const noexcept
+    {
+        return classes_[byte];
+    }
+
+    // Smallest byte of the class.
+    uint8_t Representative(size_t cls) const noexcept
+    {
+        return representatives_[cls];
+    }
+
+    size_t Count() const noexcept
+    {
+        return count_;
+    }
+
+    const std::array<uint8_t, 256>& Table() const noexcept
+    {
+        return classes_;
+    }
+
+public:
+    static ByteClasses FromSets(std::span<const CharSet> sets);
+
+    // Restores the classes from Table(). Returns std::nullopt unless the classes are numbered in the order of their
+    // smallest byte, as Add numbers them.
+    static std::optional<ByteClasses> FromTable(std::span<const uint8_t, 256> classes);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
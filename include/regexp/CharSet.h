@@ -0,0 +1,34 @@
+#pragma once
+#include <bitset>
+#include <optional>
+#include <string>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Set of bytes a single transition can read.
+using CharSet = std::bitset<256>;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class CharClass
+{
+public:
+    static CharSet Single(char ch);
+    static CharSet Range(char from, char to);
+
+    static CharSet Digits();
+    static CharSet Word();
+    static CharSet Whitespace();
+    static CharSet AnyButNewline();
+
+    // Class of the escape sequence '\' + ch, such as \d or \W, if it stands for one.
+    static std::optional<CharSet> FromEscape(char ch);
+
+    // Pattern syntax of the set: '.', a bracket expression, or a negated one if that is shorter.
+    static std::string ToString(const CharSet& set);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -0,0 +1,66 @@
+#pragma once
+#include "FullDFA.h"
+
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Turns a FullDFA into C++ source, for patterns known at build time. The generated header holds a struct with the byte
+// classes of the DFA and inline functions that walk it with one label per state: each state tests for the end of the
+// input, switches on the class of the next byte and jumps to the label of the next state. Nothing is compiled at run
+// time, no table of states is looked up, and every state has a branch of its own for the predictor to learn.
+class CodeGenerator
+{
+public:
+    struct Options
+    {
+        // Name of the generated struct, and the namespace around it, e.g. Core or Regex::Generated, if any.
+        std::string name = {};
+        std::string nameSpace = {};
+
+        // Enum the kinds of a lexer are enumerators of, e.g. Core::TokenType. If empty, the struct defines its own.
+        std::string kindType = {};
+
+        // Headers included by the generated one, and the input it was generated from for its first line.
+        std::vector<std::string> includes = {};
+        std::string source = {};
+    };
+
+private:
+    using StateId = FullDFA::StateId;
+
+    // Statements of a walk: the one run on entering a final state, if any, the one returning at the end of the input
+    // and the one returning on a byte with no way on.
+    struct Walk
+    {
+        std::function<std::string(StateId)> accept = {};
+        std::function<std::string(StateId)> end = {};
+        std::string dead = {};
+        bool acceptAtStart = true;
+    };
+
+    Options options_;
+
+public:
+    explicit CodeGenerator(Options options);
+
+public:
+    // Header with Matches and LongestMatch, the same as FullDFA::Accepts and FullDFA::LongestMatch.
+    std::string GenerateMatcher(const FullDFA& dfa) const;
+
+    // Header with Next, the same as Lexer::Next. The DFA is tagged with rule indices, kinds holds the enumerator name
+    // of every rule.
+    std::string GenerateLexer(const FullDFA& dfa, const std::vector<std::string>& kinds) const;
+
+private:
+    std::string Header(const FullDFA& dfa, const std::string& members) const;
+
+    static std::string GenerateWalk(const FullDFA& dfa, const Walk& walk);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
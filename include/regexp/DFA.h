@@ -0,0 +1,183 @@
+#pragma once
+#include "ByteClasses.h"
+#include "NFA.h"
+
+#include <array>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Copy of the arena of an NFA, the DFAs built from it outlive moves of the NFA. It never changes, so copies of a DFA
+// share it and only have state caches of their own.
+struct NfaArena
+{
+    std::vector<CharSet> charSets = {};
+    std::vector<Transition> transitions = {};
+    std::vector<uint32_t> transitionOffsets = {};
+    std::vector<uint32_t> epsilon = {};
+    std::vector<uint32_t> epsilonOffsets = {};
+    std::vector<bool> isFinal = {};
+    std::vector<uint32_t> finalTags = {};
+    std::vector<uint32_t> finalTagOffsets = {};
+    uint32_t start = 0;
+
+    explicit NfaArena(const NFA& nfa);
+
+    size_t Size() const noexcept
+    {
+        return isFinal.size();
+    }
+
+    // Replaces the states with their epsilon closure, sorted.
+    void Closure(std::vector<uint32_t>& nfaStates) const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// DFA built on the fly from an NFA by subset construction. Every DFA state is a cached set of NFA states with a
+// transition table row which is filled in lazily, the first time a byte is read in that state. Rows have one entry per
+// byte class of the NFA rather than per byte.
+//
+// The cache is bounded by a memory budget. When a search would exceed it, the cache is dropped and the search gives
+// up by returning std::nullopt, so that the caller can fall back to the NFA simulation.
+class LazyDFA
+{
+public:
+    constexpr static size_t kDefaultMemoryBudget = 1 << 20;
+
+    using StateId = int32_t;
+
+    constexpr static StateId kUnknown = -1;
+    constexpr static StateId kDead = 0;
+
+private:
+    using NfaStateSet = std::vector<uint32_t>;
+
+    struct DState
+    {
+        NfaStateSet nfaStates = {};
+        bool isFinal = false;
+        std::vector<uint32_t> tags = {};
+    };
+
+    std::shared_ptr<const NfaArena> nfa_;
+    ByteClasses byteClasses_ = {};
+    size_t stride_ = 256;
+
+    std::vector<DState> states_ = {};
+    std::vector<StateId> table_ = {};
+    std::map<NfaStateSet, StateId> cache_ = {};
+    StateId start_ = kUnknown;
+
+    size_t memoryBudget_ = kDefaultMemoryBudget;
+    size_t memoryUsed_ = 0;
+
+public:
+    explicit LazyDFA(const NFA& nfa, size_t memoryBudget = kDefaultMemoryBudget);
+
+public:
+    std::optional<bool> Accepts(std::string_view str);
+    std::optional<size_t> LongestMatch(std::string_view str);
+
+    // Same as LongestMatch, reading the string from its last byte towards the first one. With the DFA of a reversed
+    // NFA this is the length of the longest match that ends where the string does.
+    std::optional<size_t> LongestMatchBackward(std::string_view str);
+
+    // Same as the NFA methods of the same names, for NFAs whose final states are tagged.
+    std::optional<std::vector<uint32_t>> MatchingTags(std::string_view str);
+    std::optional<std::vector<size_t>> LongestMatchPerTag(std::string_view str, size_t tagCount);
+
+    size_t StateCount() const noexcept;
+    size_t MemoryUsed() const noexcept;
+    const ByteClasses& GetByteClasses() const noexcept;
+
+public:
+    // Step by step walk, for callers that keep the automaton state between calls. Both return kUnknown when the budget
+    // is exceeded; the cache is dropped then, and every state id handed out before becomes invalid.
+    StateId Start();
+    StateId Next(StateId state, uint8_t byte);
+
+    bool IsFinal(StateId state) const noexcept;
+
+private:
+    StateId AddState(NfaStateSet&& nfaStates);
+    void ResetCache();
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Lazily built DFA that finds where the leftmost-longest match of an unanchored search ends, in one forward pass.
+//
+// A state keeps the NFA threads in groups ordered by the position they started at, every byte read starts a new group
+// behind the others, and an NFA state reached by several groups stays in the earliest one only. Once a group reaches a
+// final state the groups behind it are dropped and no more groups are started, so the last final state seen before the
+// DFA dies ends a match of the leftmost start. The start itself is found by running the reversed pattern backwards from
+// there. Matches are never empty, a group that is final as it starts does not count.
+class LeftmostDFA
+{
+public:
+    using StateId = LazyDFA::StateId;
+
+    constexpr static StateId kUnknown = LazyDFA::kUnknown;
+    constexpr static StateId kDead = LazyDFA::kDead;
+
+private:
+    using NfaStateSet = std::vector<uint32_t>;
+
+    // A flags word followed by the NFA states of every group, each group sorted and closed by kGroupEnd.
+    using StateKey = std::vector<uint32_t>;
+
+    constexpr static uint32_t kGroupEnd = UINT32_MAX;
+    constexpr static uint32_t kHasMatched = 1;
+    constexpr static uint32_t kIsFinal = 2;
+
+    struct DState
+    {
+        StateKey key = {};
+        bool isFinal = false;
+    };
+
+    std::shared_ptr<const NfaArena> nfa_;
+    ByteClasses byteClasses_ = {};
+    size_t stride_ = 256;
+    NfaStateSet startClosure_ = {};
+
+    std::vector<DState> states_ = {};
+    std::vector<StateId> table_ = {};
+    std::map<StateKey, StateId> cache_ = {};
+    StateId start_ = kUnknown;
+
+    size_t memoryBudget_ = LazyDFA::kDefaultMemoryBudget;
+    size_t memoryUsed_ = 0;
+
+public:
+    explicit LeftmostDFA(const NFA& nfa, size_t memoryBudget = LazyDFA::kDefaultMemoryBudget);
+
+public:
+    // End of the leftmost-longest match in the string, 0 if there is none, std::nullopt when the budget is exceeded.
+    std::optional<size_t> FindEnd(std::string_view str);
+
+    size_t StateCount() const noexcept;
+    const ByteClasses& GetByteClasses() const noexcept;
+
+public:
+    // Step by step walk, as with the LazyDFA. While the walk is in the start state no match is under way, so a caller
+    // may skip ahead to the next offset where a match can start and carry on from the start state there.
+    StateId Start();
+    StateId Next(StateId state, uint8_t byte);
+
+    bool IsFinal(StateId state) const noexcept;
+
+private:
+    StateId AddState(StateKey&& key);
+    void ResetCache();
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -0,0 +1,120 @@
+#pragma once
+#include "ByteClasses.h"
+#include "NFA.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// DFA built ahead of time from an NFA: complete subset construction over the byte classes, then Hopcroft
+// minimization. The result is a dense table with one row per state and one entry per byte class. State 0 is the dead
+// state, into which every state that cannot reach a final state has been merged, and the final states are numbered
+// last, so that a search needs no extra lookup to tell whether it has to stop or remember a match.
+//
+// Unlike the LazyDFA the table never changes after construction, so one FullDFA can be searched from any number of
+// threads without locking. The tables are only viewed by the DFA, the memory behind them is either owned by it or
+// belongs to a file mapped by AutomatonFile.
+class FullDFA
+{
+public:
+    using StateId = uint32_t;
+
+    constexpr static StateId kDead = 0;
+    constexpr static uint32_t kNoTag = UINT32_MAX;
+    constexpr static size_t kDefaultMaxStates = 1 << 14;
+
+    struct Stats
+    {
+        size_t subsetStates = 0;
+        size_t minimizedStates = 0;
+        size_t tableBytes = 0;
+    };
+
+private:
+    // Tables of a DFA built in memory. Every state has the sorted list of tags of its final NFA states, the lists are
+    // stored one after another with per-state offsets.
+    struct Tables
+    {
+        std::vector<StateId> table = {};
+        std::vector<uint32_t> tagOffsets = {};
+        std::vector<uint32_t> tags = {};
+    };
+
+    ByteClasses byteClasses_ = {};
+    size_t stride_ = 1;
+
+    std::shared_ptr<const void> storage_ = {};
+    std::span<const StateId> table_ = {};
+    std::span<const uint32_t> tagOffsets_ = {};
+    std::span<const uint32_t> tags_ = {};
+    StateId start_ = kDead;
+    StateId firstFinal_ = 1;
+
+    Stats stats_ = {};
+
+public:
+    // DFA states are told apart by the set of tags of their final NFA states.
+    static std::optional<FullDFA> Make(const NFA& nfa, size_t maxStates = kDefaultMaxStates);
+
+    // Every state of the LeftmostDFA of the NFA, minimized into a table that is searched the same way. Its final states
+    // end a match and carry tag 0. The start state is never merged with another one, so that it still tells that no
+    // match is under way.
+    static std::optional<FullDFA> MakeLeftmost(const NFA& nfa, size_t maxStates = kDefaultMaxStates);
+
+public:
+    bool Accepts(std::string_view str) const noexcept;
+    size_t LongestMatch(std::string_view str) const noexcept;
+
+    // Same as LazyDFA::LongestMatchBackward.
+    size_t LongestMatchBackward(std::string_view str) const noexcept;
+
+    StateId Start() const noexcept
+    {
+        return start_;
+    }
+
+    StateId Next(StateId state, uint8_t byte) const noexcept
+    {
+        return table_[state * stride_ + byteClasses_[byte]];
+    }
+
+    bool IsFinal(StateId state) const noexcept
+    {
+        return state >= firstFinal_;
+    }
+
+    // Smallest tag of a final state, kNoTag for the other states.
+    uint32_t Tag(StateId state) const noexcept
+    {
+        return tagOffsets_[state] == tagOffsets_[state + 1] ? kNoTag : tags_[tagOffsets_[state]];
+    }
+
+    std::span<const uint32_t> Tags(StateId state) const noexcept
+    {
+        return tags_.subspan(tagOffsets_[state], tagOffsets_[state + 1] - tagOffsets_[state]);
+    }
+
+    size_t StateCount() const noexcept;
+    const Stats& GetStats() const noexcept;
+    const ByteClasses& GetByteClasses() const noexcept;
+
+private:
+    friend class AutomatonFile;
+
+    FullDFA() = default;
+
+    bool Determinize(const NFA& nfa, size_t maxStates, Tables& tables);
+    bool Explore(const NFA& nfa, size_t maxStates, Tables& tables);
+    void Minimize(Tables& tables, bool isStartKept = false);
+    void Adopt(std::shared_ptr<const Tables> tables);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
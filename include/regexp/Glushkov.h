@@ -0,0 +1,101 @@
+#pragma once
+#include "ByteClasses.h"
+#include "CharSet.h"
+
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Epsilon-free position automaton of a pattern. Every symbol occurrence is a position, a transition into a position
+// reads one of its symbols. A character class is a single position, and so are alternations of single symbols.
+class Glushkov
+{
+public:
+    using PositionList = std::vector<uint32_t>;
+
+    struct Positions
+    {
+        PositionList first = {};
+        PositionList last = {};
+        bool nullable = false;
+    };
+
+private:
+    std::vector<CharSet> symbols_ = {};
+    std::vector<PositionList> follow_ = {};
+    Positions root_ = {};
+
+public:
+    Positions Empty() const;
+    Positions Symbol(char symbol);
+    Positions Class(const CharSet& symbols);
+    Positions Alternation(Positions&& lhs, Positions&& rhs);
+    Positions Concatenation(Positions&& lhs, Positions&& rhs);
+    Positions Repetition(Positions&& pattern);
+    Positions OneOrMore(Positions&& pattern);
+    Positions Optional(Positions&& pattern) const;
+
+    void SetRoot(Positions&& root);
+
+public:
+    size_t Size() const noexcept;
+
+    const Positions& Root() const noexcept;
+    const CharSet& Symbols(uint32_t position) const;
+    const PositionList& Follow(uint32_t position) const;
+
+private:
+    void AddFollow(const PositionList& from, const PositionList& to);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Simulates a Glushkov automaton with the set of active positions packed into machine words. Bit 0 is the initial
+// state and bit i + 1 is position i. A step ORs precomputed follow sets, looked up one byte of the active set at a
+// time, and masks them with the positions that can read the next symbol.
+class BitParallelMatcher
+{
+public:
+    constexpr static size_t kMaxPositions = 127;
+
+private:
+    using Word = uint64_t;
+
+    constexpr static size_t kWordBits = 64;
+    constexpr static size_t kChunkBits = 8;
+    constexpr static size_t kChunksPerWord = kWordBits / kChunkBits;
+
+    size_t words_ = 1;
+    size_t chunks_ = 1;
+
+    ByteClasses byteClasses_ = {};
+
+    std::vector<Word> followTable_ = {};
+    std::vector<Word> symbolMasks_ = {};
+    std::vector<Word> finalMask_ = {};
+
+public:
+    explicit BitParallelMatcher(const Glushkov& glushkov);
+
+public:
+    bool Accepts(std::string_view str) const;
+    size_t LongestMatch(std::string_view str) const;
+
+    size_t MemoryUsage() const noexcept;
+    const ByteClasses& GetByteClasses() const noexcept;
+
+public:
+    static std::optional<BitParallelMatcher> Make(const Glushkov& glushkov);
+
+private:
+    bool Step(Word* active, Word* next, uint8_t byte) const;
+    bool IsFinal(const Word* active) const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
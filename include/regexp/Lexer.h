@@ -0,0 +1,60 @@
+#pragma once
+#include "FullDFA.h"
+#include "Scanner.h"
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Tokenizer compiled from an ordered list of rules. All rules are unioned into one NFA whose final states are tagged
+// with the index of their rule, and turned into a minimized FullDFA. A DFA state carries the smallest rule index it
+// accepts, so scanning a token is a single table walk that keeps the longest match (maximal munch), with ties going to
+// the rule listed first.
+class Lexer
+{
+public:
+    struct Rule
+    {
+        std::string pattern = {};
+        uint32_t kind = 0;
+    };
+
+    struct Lexeme
+    {
+        uint32_t kind = 0;
+        size_t length = 0;
+    };
+
+    constexpr static uint32_t kNoMatch = UINT32_MAX;
+
+private:
+    FullDFA dfa_;
+    std::vector<uint32_t> kinds_ = {};
+
+public:
+    // Counted repetitions of every rule may expand to at most maxRepeatCount symbols, see Scanner.
+    explicit Lexer(const std::vector<Rule>& rules, size_t maxRepeatCount = Scanner::kDefaultMaxRepeatCount);
+
+public:
+    // Longest non-empty lexeme starting at the position. If no rule matches, the kind is kNoMatch and the length is 0.
+    Lexeme Next(std::string_view str, size_t pos = 0) const noexcept;
+
+    size_t StateCount() const noexcept;
+
+    // The minimized DFA, tagged with the index of the rule every final state accepts.
+    const FullDFA& Dfa() const noexcept
+    {
+        return dfa_;
+    }
+
+private:
+    static FullDFA Compile(const std::vector<Rule>& rules, size_t maxRepeatCount);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
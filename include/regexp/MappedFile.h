@@ -0,0 +1,33 @@
+#pragma once
+#include <string>
+#include <string_view>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Read-only memory mapping of a whole file, advised for sequential access. The contents are only valid as long as the
+// mapping lives. On platforms without mmap the file is read into memory instead.
+class MappedFile
+{
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+
+#if !defined(__unix__) && !defined(__APPLE__)
+    std::string contents_ = {};
+#endif
+
+public:
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+
+public:
+    std::string_view View() const noexcept;
+    size_t Size() const noexcept;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
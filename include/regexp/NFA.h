@@ -1,13 +1,19 @@
 #pragma once
+#include "SparseSet.h"
 #include "State.h"
 
 #include <memory>
+#include <span>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace Regex
 {
 // ---------------------------------------------------------------------------------------------------------------------
 
+// NFA stored as an arena of integer states. Symbol transitions and epsilon transitions are kept in two separate
+// contiguous arrays, grouped by source state, with per-state offsets into them.
 class NFA
 {
     struct Impl;
@@ -19,6 +25,18 @@ public:
 
     constexpr static char kEpsilon = '\0';
 
+    // Thread lists of one simulation. A search only writes to its scratch, never to the NFA, so one NFA can be searched
+    // from several threads at once with a scratch each. The methods without a scratch argument use one per thread.
+    class Scratch
+    {
+        friend class NFA;
+        friend struct Impl;
+
+        SparseSet current_ = {};
+        SparseSet next_ = {};
+        std::vector<StateId> stack_ = {};
+    };
+
 public:
     explicit NFA(size_t stateCount = 1);
     ~NFA();
@@ -30,28 +48,68 @@ public:
     NFA& operator=(NFA&& rhs) noexcept = default;
 
 public:
-    State& operator[](Index idx);
-    const StatePtr& At(Index idx) const;
-
     bool Accepts(const std::string& str) const;
+    bool Accepts(std::string_view str, Scratch& scratch) const;
     MatchList FindMatches(const std::string& str) const;
     std::string LongestMatch(const std::string& str, size_t pos = 0) const;
+    size_t LongestMatchLength(std::string_view str) const;
+    size_t LongestMatchLength(std::string_view str, Scratch& scratch) const;
+
+    // Also tells whether some thread was still running after the last byte, that is whether more input could make
+    // the match longer.
+    size_t LongestMatchLength(std::string_view str, bool& isAlive) const;
+
+    // Tags of the final states reached by the whole string, and the longest match of the string's prefix per tag.
+    std::vector<uint32_t> MatchingTags(std::string_view str) const;
+    std::vector<size_t> LongestMatchPerTag(std::string_view str, size_t tagCount) const;
+
+    // Equivalent NFA without epsilon transitions. Its states are the start state and the targets of symbol
+    // transitions, each with the transitions of its whole epsilon closure; a state whose closure holds several final
+    // states takes the tags of all of them.
+    NFA EliminateEpsilon() const;
+
+    // NFA of the reversed language: every transition turned around, a new start state with epsilon transitions to the
+    // former final states, and the former start state as the only final one. Tags are not kept.
+    NFA Reverse() const;
+
+    // Same as Reverse, with every state final in the NFA taken as a former final state: the reversed prefixes of the
+    // strings the NFA matches.
+    NFA ReversePrefixes() const;
 
     size_t Size() const noexcept;
+    size_t MemoryUsage() const;
+
+    StateId Start() const noexcept;
+    bool IsFinal(StateId state) const;
+    // Tags of a final state, sorted. A state made final without a tag has the tag 0, states that are not final none.
+    std::span<const uint32_t> FinalTags(StateId state) const;
+    std::span<const StateId> FinalStates() const;
+
+    const CharSet& CharSetAt(uint32_t idx) const;
+    size_t CharSetCount() const noexcept;
 
-    const StatePtrSet& FinalStates() const;
-    const StatePtrSet& CurrentStates() const;
+    std::span<const Transition> Transitions(StateId state) const;
+    std::span<const StateId> EpsilonTransitions(StateId state) const;
 
+public:
+    StateId AddState();
+
+    void SetStart(StateId state);
     void AddFinalStates(const IndexSet& indices);
     void ResetFinalStates(const IndexSet& indices = {});
 
+    // Makes the state final with the tag as its only one, or adds the tag to the ones the state already has.
+    void SetFinalTag(Index state, uint32_t tag);
+    void AddFinalTag(Index state, uint32_t tag);
+
     void AddTransition(Index state, char symbol, Index nextState);
+    void AddTransition(Index state, const CharSet& symbols, Index nextState);
     void AddEpsilonTransition(Index state, Index nextState);
     void AddStartStateTransition(char symbol, Index nextState);
 
-    void Merge(NFA&& src);
-    void PushBack();
-    void PushFront();
+private:
+    // The implementation with the pending changes applied, ready to be searched.
+    const Impl& Prepared() const;
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
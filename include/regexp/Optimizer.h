@@ -0,0 +1,49 @@
+#pragma once
+#include "Ast.h"
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Rewrites an AST into an equivalent one that builds a smaller automaton: nested alternations and concatenations are
+// flattened into n-ary nodes, single-character alternatives are merged into one character set, common prefixes are
+// factored out of alternations, nested closures and trivial counters are collapsed and redundant empty nodes are
+// removed. Capture groups are dropped.
+class Optimizer
+{
+    using AstNodePtr = AstNode::AstNodePtr;
+    using AstNodeList = AstNode::AstNodeList;
+    using AstType = AstNode::AstType;
+
+    AstNodePtr result_ = {};
+
+public:
+    explicit Optimizer(const AstNodePtr& root)
+        : result_(Optimize(root))
+    {}
+
+public:
+    const AstNodePtr& Result() const noexcept
+    {
+        return result_;
+    }
+
+public:
+    // Structural equality of two subtrees.
+    static bool Equals(const AstNodePtr& lhs, const AstNodePtr& rhs);
+
+private:
+    static AstNodePtr Optimize(const AstNodePtr& node);
+
+    // The Make* functions expect their operands to be optimized already.
+    static AstNodePtr MakeAlternation(const AstNodeList& patterns);
+    static AstNodePtr MakeConcatenation(const AstNodeList& patterns);
+    static AstNodePtr MakeClosure(AstType type, const AstNodePtr& pattern);
+    static AstNodePtr MakeCountedRepetition(const AstNodePtr& pattern, size_t minCount, size_t maxCount);
+
+    static AstNodeList FactorPrefixes(const AstNodeList& alternatives);
+    static AstNodeList MergeCharSets(const AstNodeList& alternatives);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
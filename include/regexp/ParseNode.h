@@ -21,6 +21,7 @@ public:
         Factor,
         Atom,
         Symbol,
+        Counter,
         Empty
     };
 
@@ -60,15 +60,47 @@ public:
 
 // ---------------------------------------------------------------------------------------------------------------------
 
+class CounterNode : public ParseNode
+{
+    Token token_;
+    size_t maxRepeatCount_ = 0;
+
+public:
+    CounterNode(Token token, size_t maxRepeatCount)
+        : ParseNode(NodeType::Counter)
+        , token_(token)
+        , maxRepeatCount_(maxRepeatCount)
+    {}
+
+public:
+    AstNodePtr ConvertToAst() const override;
+
+    // Counted repetition of the atom the counter follows. Throws when it expands to more than maxRepeatCount symbols,
+    // the counters nested in the atom multiplied in.
+    AstNodePtr Apply(AstNodePtr atom) const;
+
+public:
+    static ParseNodePtr Make(Token token, size_t maxRepeatCount)
+    {
+        return std::make_shared<CounterNode>(token, maxRepeatCount);
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
 class AtomNode : public ParseNode
 {
+    // Number of the capture group a parenthesized atom opens, counted from 1 in the order of the opening brackets.
+    size_t group_ = 0;
+
 public:
     explicit AtomNode(ParseNodePtr child)
         : ParseNode(NodeType::Atom, child)
     {}
 
-    explicit AtomNode(ChildNodeList children)
+    AtomNode(ChildNodeList children, size_t group)
         : ParseNode(NodeType::Atom, std::move(children))
+        , group_(group)
     {}
 
     ~AtomNode() override = default;
@@ -76,6 +108,11 @@ public:
 public:
     AstNodePtr ConvertToAst() const override;
 
+    size_t Group() const noexcept
+    {
+        return group_;
+    }
+
 public:
     template <typename... Args>
     static ParseNodePtr Make(Args&&... args)
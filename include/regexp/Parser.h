@@ -1,5 +1,6 @@
 #pragma once
 #include "ParseNode.h"
+#include "Scanner.h"
 
 #include <memory>
 #include <ostream>
@@ -18,15 +19,25 @@ private:
     std::vector<Token> tokens_ = {};
     size_t current_ = 0;
     size_t errorPos_ = -1;
+    size_t groupCount_ = 0;
+    size_t maxRepeatCount_ = Scanner::kDefaultMaxRepeatCount;
 
 public:
-    explicit Parser(const std::vector<Token>& tokens)
+    // Counted repetitions may expand to at most maxRepeatCount symbols, see Scanner::kDefaultMaxRepeatCount.
+    explicit Parser(const std::vector<Token>& tokens, size_t maxRepeatCount = Scanner::kDefaultMaxRepeatCount)
         : tokens_(tokens)
+        , maxRepeatCount_(maxRepeatCount)
     {}
 
 public:
     NodePtr Parse();
 
+    // Number of capture groups in the parsed pattern.
+    size_t GroupCount() const noexcept
+    {
+        return groupCount_;
+    }
+
 private:
     NodePtr Expr();
     NodePtr Term();
@@ -0,0 +1,63 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace Regex
+{
+class RegExp;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Thread-safe cache of compiled patterns keyed by the pattern string. It keeps at most Capacity() entries and evicts
+// the least recently used one when full. The handed out handles stay valid after eviction.
+class PatternCache
+{
+public:
+    using RegExpPtr = std::shared_ptr<const RegExp>;
+
+    constexpr static size_t kDefaultCapacity = 256;
+
+    struct Stats
+    {
+        size_t hits = 0;
+        size_t misses = 0;
+        size_t evictions = 0;
+        size_t size = 0;
+    };
+
+private:
+    using Entry = std::pair<std::string, RegExpPtr>;
+
+    mutable std::mutex mutex_;
+    size_t capacity_ = kDefaultCapacity;
+
+    // Most recently used entries first, the index refers to the keys stored in the list.
+    std::list<Entry> entries_ = {};
+    std::unordered_map<std::string_view, std::list<Entry>::iterator> index_ = {};
+    Stats stats_ = {};
+
+public:
+    explicit PatternCache(size_t capacity = kDefaultCapacity);
+
+public:
+    RegExpPtr Get(std::string_view pattern);
+
+    void Clear();
+    void SetCapacity(size_t capacity);
+
+    size_t Capacity() const;
+    Stats GetStats() const;
+
+public:
+    static PatternCache& Instance();
+
+private:
+    void Evict();
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -0,0 +1,205 @@
+#pragma once
+#include "AstNode.h"
+#include "ByteClasses.h"
+#include "SparseSet.h"
+
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Program for submatch extraction, compiled from the unoptimized AST of a pattern. A Byte instruction reads one byte of
+// a set, a Split continues at two instructions of which the first has priority, a Save records the current position in
+// a capture slot. Group k is captured in slots 2k and 2k + 1, group 0 being the whole match.
+class CaptureProgram
+{
+public:
+    enum class OpCode : uint8_t
+    {
+        Byte,
+        Split,
+        Save,
+        Match
+    };
+
+    struct Instruction
+    {
+        OpCode opCode = OpCode::Match;
+        uint32_t next = 0;
+
+        // Character set of a Byte, slot of a Save, second target of a Split.
+        uint32_t arg = 0;
+    };
+
+    // Slot value of a group that took no part in the match.
+    constexpr static size_t kNoPosition = std::string_view::npos;
+
+private:
+    std::vector<Instruction> instructions_ = {};
+    std::vector<CharSet> charSets_ = {};
+    uint32_t start_ = 0;
+    size_t groupCount_ = 0;
+
+public:
+    CaptureProgram(const AstNode::AstNodePtr& root, size_t groupCount);
+
+public:
+    size_t Size() const noexcept
+    {
+        return instructions_.size();
+    }
+
+    const Instruction& At(uint32_t pc) const noexcept
+    {
+        return instructions_[pc];
+    }
+
+    const CharSet& CharSetAt(uint32_t idx) const noexcept
+    {
+        return charSets_[idx];
+    }
+
+    std::span<const CharSet> CharSets() const noexcept
+    {
+        return charSets_;
+    }
+
+    uint32_t Start() const noexcept
+    {
+        return start_;
+    }
+
+    size_t GroupCount() const noexcept
+    {
+        return groupCount_;
+    }
+
+    size_t SlotCount() const noexcept
+    {
+        return 2 * (groupCount_ + 1);
+    }
+
+private:
+    friend class AutomatonFile;
+
+    CaptureProgram() = default;
+
+    // Appends the instructions of the node, which go on at next, and returns the first of them.
+    uint32_t Compile(const AstNode::AstNodePtr& node, uint32_t next);
+    uint32_t CompileRepetition(const AstNode::AstNodePtr& pattern, uint32_t next);
+    uint32_t Emit(OpCode opCode, uint32_t next, uint32_t arg = 0);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Runs a capture program on all paths at once, keeping its threads in priority order. Every thread carries its own
+// capture slots, and of the threads that reach the same instruction only the one with the highest priority goes on, so
+// a run takes time linear in the input times the program size and never backtracks. Alternatives are preferred from
+// left to right and closures repeat as often as they can.
+class PikeVM
+{
+public:
+    // Thread lists and slots of one run, so that one PikeVM can run in several threads at once.
+    class Scratch
+    {
+        friend class PikeVM;
+
+        struct Job
+        {
+            uint32_t pc = 0;
+
+            // A job with a slot restores its value instead of adding a thread at pc.
+            uint32_t slot = kNoSlot;
+            size_t position = 0;
+        };
+
+        constexpr static uint32_t kNoSlot = UINT32_MAX;
+
+        SparseSet current_ = {};
+        SparseSet next_ = {};
+        std::vector<size_t> currentSlots_ = {};
+        std::vector<size_t> nextSlots_ = {};
+        std::vector<size_t> slots_ = {};
+        std::vector<Job> stack_ = {};
+    };
+
+private:
+    CaptureProgram program_;
+
+public:
+    explicit PikeVM(CaptureProgram program)
+        : program_(std::move(program))
+    {}
+
+public:
+    // Fills the slots from the matching path of the highest priority if the whole string matches. The slots of the
+    // groups outside that path are set to CaptureProgram::kNoPosition.
+    bool Match(std::string_view str, std::span<size_t> slots, Scratch& scratch) const;
+
+    const CaptureProgram& Program() const noexcept
+    {
+        return program_;
+    }
+
+private:
+    // Adds the thread at pc to the list with the slots, followed through splits and saves.
+    void AddThread(SparseSet& list, std::vector<size_t>& listSlots, uint32_t pc, size_t pos, Scratch& scratch) const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Submatch extraction for one-pass patterns, where at every point of a match the next byte alone decides how the
+// pattern goes on: a(b|c)*d is one-pass, (a|ab)(c|bcd) is not. A single thread walks a DFA over the program whose
+// transitions carry the slots to save, with no thread lists at all. Since every string then has at most one matching
+// path, the result is the same as the PikeVM's.
+class OnePassMatcher
+{
+public:
+    using StateId = uint32_t;
+
+    constexpr static StateId kNone = UINT32_MAX;
+    constexpr static size_t kDefaultMaxStates = 1024;
+
+    // The slots to save are kept as a bit mask.
+    constexpr static size_t kMaxGroups = 31;
+
+private:
+    struct Action
+    {
+        StateId next = kNone;
+        uint64_t saves = 0;
+    };
+
+    ByteClasses byteClasses_ = {};
+    size_t stride_ = 256;
+    size_t slotCount_ = 0;
+
+    // Row per state and byte class, and per state the slots saved when the match ends there, next being kNone in
+    // states where it cannot end.
+    std::vector<Action> table_ = {};
+    std::vector<Action> finals_ = {};
+
+public:
+    // Returns std::nullopt if the pattern is not one-pass, has more than kMaxGroups groups or needs more states.
+    static std::optional<OnePassMatcher> Make(const CaptureProgram& program, size_t maxStates = kDefaultMaxStates);
+
+public:
+    // Same as PikeVM::Match.
+    bool Match(std::string_view str, std::span<size_t> slots) const;
+
+    size_t StateCount() const noexcept
+    {
+        return finals_.size();
+    }
+
+private:
+    OnePassMatcher() = default;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -0,0 +1,56 @@
+#pragma once
+#include "CharSet.h"
+#include "Glushkov.h"
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Finds the offsets where a non-empty match of a pattern can start, without running the automaton. Uses the literal
+// prefix every match starts with when there is one, otherwise the set of bytes a match can start with.
+class Prefilter
+{
+public:
+    enum class Kind
+    {
+        None,
+        Literal,
+        FewBytes,
+        ByteSet
+    };
+
+    constexpr static size_t kMaxFewBytes = 3;
+
+private:
+    friend class AutomatonFile;
+
+    Kind kind_ = Kind::None;
+    std::string prefix_ = {};
+    std::vector<char> bytes_ = {};
+    CharSet firstBytes_ = {};
+
+public:
+    Prefilter() = default;
+
+public:
+    // First offset not less than pos where a match can start, or std::string_view::npos.
+    size_t Find(std::string_view str, size_t pos) const;
+
+    Kind GetKind() const noexcept;
+    const std::string& Prefix() const noexcept;
+
+public:
+    static Prefilter Make(const Glushkov& glushkov);
+
+private:
+    size_t FindLiteral(std::string_view str, size_t pos) const;
+    size_t FindFewBytes(std::string_view str, size_t pos) const;
+    size_t FindInSet(std::string_view str, size_t pos) const;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -1,12 +1,24 @@
 #pragma once
+#include "AhoCorasick.h"
 #include "AstNode.h"
+#include "AutomatonFile.h"
+#include "DFA.h"
+#include "FullDFA.h"
+#include "Glushkov.h"
 #include "NFA.h"
+#include "Optimizer.h"
 #include "Parser.h"
-#include "Rewriter.h"
+#include "PatternCache.h"
+#include "PikeVM.h"
+#include "Prefilter.h"
 #include "Scanner.h"
 
 #include <cassert>
+#include <functional>
+#include <iterator>
 #include <memory>
+#include <optional>
+#include <ranges>
 #include <vector>
 
 namespace Regex
@@ -15,50 +27,313 @@ namespace Regex
 
 class RegExp
 {
+public:
+    // Lazy builds DFA states while searching, within the memory budget. Full builds the whole minimized DFA up front,
+    // for hot patterns that are worth the compile time, and so it does with the forward and reverse DFAs that find
+    // matches anywhere in a string. Patterns whose DFAs are too large fall back to the lazy ones.
+    enum class DfaMode
+    {
+        Lazy,
+        Full
+    };
+
+    struct CompileStats
+    {
+        bool isBitParallel = false;
+        bool isFullDfa = false;
+        size_t positions = 0;
+        size_t nfaStates = 0;
+        size_t byteClasses = 0;
+        size_t dfaStates = 0;
+        size_t minimizedDfaStates = 0;
+        size_t dfaTableBytes = 0;
+        bool isFullSearchDfa = false;
+        size_t searchDfaTableBytes = 0;
+        size_t groups = 0;
+        bool isOnePass = false;
+        size_t literals = 0;
+    };
+
+private:
     std::string pattern_ = {};
     AstNode::AstNodePtr node_ = {};
     NFA nfa_;
+    std::shared_ptr<const LazyDFA> dfa_ = {};
+    std::shared_ptr<const LeftmostDFA> leftmostDfa_ = {};
+    std::shared_ptr<const LazyDFA> reverseDfa_ = {};
+    std::shared_ptr<const FullDFA> fullDfa_ = {};
+    std::shared_ptr<const FullDFA> fullLeftmostDfa_ = {};
+    std::shared_ptr<const FullDFA> fullReverseDfa_ = {};
+
+    // Reversed prefixes of the matches for the StreamMatcher of a loaded RegExp, which has no NFA to build them from.
+    std::shared_ptr<const FullDFA> fullPrefixDfa_ = {};
+    std::shared_ptr<BitParallelMatcher> bitParallel_ = {};
+    std::shared_ptr<const PikeVM> pikeVm_ = {};
+    std::shared_ptr<const OnePassMatcher> onePass_ = {};
+    std::shared_ptr<const AhoCorasick> literals_ = {};
+    Prefilter prefilter_ = {};
+    CompileStats stats_ = {};
+    size_t dfaMemoryBudget_ = LazyDFA::kDefaultMemoryBudget;
+
+    // Identifies the compiled program to the scratches made for it, never reused within the process.
+    uint64_t id_ = 0;
 
 public:
-    explicit RegExp(std::string_view pattern)
+    // Counted repetitions may expand to at most maxRepeatCount symbols, nested ones multiplied, see Scanner.
+    explicit RegExp(std::string_view pattern,
+        size_t dfaMemoryBudget = LazyDFA::kDefaultMemoryBudget,
+        size_t maxRepeatCount = Scanner::kDefaultMaxRepeatCount)
     {
-        Initialize(pattern);
+        Initialize(pattern, DfaMode::Lazy, dfaMemoryBudget, maxRepeatCount);
     }
 
-public:
-    bool Matches(const std::string& str) const
+    RegExp(std::string_view pattern,
+        DfaMode dfaMode,
+        size_t dfaMemoryBudget = LazyDFA::kDefaultMemoryBudget,
+        size_t maxRepeatCount = Scanner::kDefaultMaxRepeatCount)
     {
-        return nfa_.Accepts(str);
+        Initialize(pattern, dfaMode, dfaMemoryBudget, maxRepeatCount);
     }
 
+public:
+    // Returns the compiled pattern from the process-wide PatternCache, compiling it on the first use.
+    static PatternCache::RegExpPtr Compile(std::string_view pattern);
+
+public:
+    // Everything a search writes to: the lazy DFA state caches, which share the NFA of the compiled RegExp, and the
+    // NFA and PikeVM thread lists.
+    // Searches leave the compiled RegExp untouched, so any number of threads can share one with a scratch each. A
+    // scratch made for another RegExp is reset on its first use; the methods without a scratch argument take one from
+    // a small pool of the calling thread.
+    class Scratch
+    {
+        friend class RegExp;
+
+        uint64_t id_ = 0;
+        std::optional<LazyDFA> dfa_ = {};
+        std::optional<LeftmostDFA> leftmostDfa_ = {};
+        std::optional<LazyDFA> reverseDfa_ = {};
+        NFA::Scratch nfa_ = {};
+        PikeVM::Scratch pikeVm_ = {};
+        std::vector<size_t> slots_ = {};
+
+    public:
+        Scratch() = default;
+        explicit Scratch(const RegExp& regexp);
+    };
+
+    // Number of scratches each thread keeps for the patterns it searched last.
+    constexpr static size_t kScratchPoolSize = 4;
+
+public:
+    bool Matches(const std::string& str) const;
+    bool Matches(const std::string& str, Scratch& scratch) const;
+
 public:
     using Match = NFA::Match;
     using MatchList = std::vector<Match>;
 
-public:
-    MatchList FindMatches(const std::string& str) const
+    // Match given by its position only, the matched text stays in the searched input.
+    struct MatchRange
     {
-        return nfa_.FindMatches(str);
-    }
+        size_t offset = 0;
+        size_t length = 0;
+
+        bool operator==(const MatchRange& rhs) const = default;
+
+        std::string_view Text(std::string_view str) const
+        {
+            return str.substr(offset, length);
+        }
+    };
 
-    std::string LongestMatch(const std::string& str, size_t pos = 0) const
+    using MatchRangeList = std::vector<MatchRange>;
+
+    // Whole match followed by one entry per capture group, std::nullopt for a group that took no part in the match.
+    using CaptureList = std::vector<std::optional<MatchRange>>;
+    using MatchCallback = std::function<void(size_t offset, size_t length)>;
+
+    // Finds the next match only when it is advanced, so walking the matches of a long input allocates nothing.
+    class MatchIterator
     {
-        return nfa_.LongestMatch(str, pos);
-    }
+        const RegExp* regexp_ = nullptr;
+        std::string_view str_ = {};
+        std::optional<MatchRange> current_ = {};
+
+    public:
+        using iterator_concept = std::input_iterator_tag;
+        using value_type = MatchRange;
+        using difference_type = std::ptrdiff_t;
+
+    public:
+        MatchIterator() = default;
+        MatchIterator(const RegExp& regexp, std::string_view str);
+
+    public:
+        const MatchRange& operator*() const noexcept;
+        const MatchRange* operator->() const noexcept;
+
+        MatchIterator& operator++();
+        void operator++(int);
+
+        bool operator==(std::default_sentinel_t) const noexcept;
+    };
+
+    using MatchSequence = std::ranges::subrange<MatchIterator, std::default_sentinel_t>;
+
+public:
+    // Inputs shorter than this are not split between threads.
+    constexpr static size_t kMinParallelChunk = 1 << 16;
+
+public:
+    MatchList FindMatches(const std::string& str) const;
+    std::string LongestMatch(const std::string& str, size_t pos = 0) const;
+
+    // Same as FindMatches and LongestMatch without copying the matched text, the results refer into the given string.
+    MatchRangeList FindMatchRanges(std::string_view str) const;
+    MatchRangeList FindMatchRanges(std::string_view str, Scratch& scratch) const;
+    std::string_view LongestMatchView(std::string_view str, size_t pos = 0) const;
+
+    // Matches in the same order as FindMatches, each one searched for when the iterator gets to it.
+    MatchSequence Search(std::string_view str) const;
+
+    // Same result as FindMatches. The input is split into one chunk per thread, every chunk is searched as if a match
+    // could start at its first byte, and the results are stitched together afterwards. A thread count of 0 stands for
+    // the number of hardware threads.
+    MatchList FindMatchesParallel(const std::string& str, size_t threadCount = 0) const;
+
+    // Searches the file through a read-only memory mapping, the file is never copied. The second form hands every
+    // match to the callback as soon as it is found instead of collecting them.
+    MatchRangeList FindMatchesInFile(const std::string& path) const;
+    void FindMatchesInFile(const std::string& path, const MatchCallback& callback) const;
+
+    // The match FindMatches finds first from the given position on, with the submatches of its capture groups. The
+    // groups are numbered by their opening brackets from 1. Within the leftmost-longest match, each alternation takes
+    // the first alternative and each closure repeats as often as the rest of the match allows. The submatches are found
+    // without backtracking, by a single thread for patterns where the next byte always tells how the match goes on and
+    // by a PikeVM otherwise.
+    std::optional<CaptureList> FindCaptures(std::string_view str, size_t pos = 0) const;
+    std::optional<CaptureList> FindCaptures(std::string_view str, size_t pos, Scratch& scratch) const;
+
+    // Every match of FindMatches with its submatches.
+    std::vector<CaptureList> FindAllCaptures(std::string_view str) const;
+
+    size_t GroupCount() const noexcept;
+
+    // Writes the pattern to a file together with its minimized DFA, the dense DFAs of the unanchored search and of
+    // streaming, its prefilter and its capture program. The DFAs a pattern was compiled without are built for saving,
+    // and Save throws if one of them is too large. Load maps the DFAs back in and parses nothing, a loaded RegExp
+    // matches, searches and captures with what the file holds. See AutomatonFile for what is verified.
+    void Save(const std::string& path) const;
+    static RegExp Load(const std::string& path, AutomatonFile::Verify verify = AutomatonFile::Verify::Structure);
+
+    const std::string& Pattern() const noexcept;
+    const CompileStats& Stats() const noexcept;
 
 private:
-    void Initialize(std::string_view pattern)
+    friend class StreamMatcher;
+
+    RegExp() = default;
+
+    void SetFullDfa(std::shared_ptr<const FullDFA> fullDfa);
+
+    // Builds the DFAs of the unanchored search from the NFA, the full ones if they fit. They serve every pattern,
+    // whichever engine matches at a given position, so that a search reads the input once instead of once per start
+    // position.
+    void SetSearchDfas(DfaMode dfaMode);
+    void SetFullSearchDfas(std::shared_ptr<const FullDFA> leftmostDfa, std::shared_ptr<const FullDFA> reverseDfa);
+
+    // Compiles the submatch extraction from the AST before the Optimizer removes the groups.
+    void SetCaptures(const AstNode::AstNodePtr& root, size_t groupCount);
+    void SetCaptures(CaptureProgram program);
+
+    CaptureList Captures(std::string_view str, const MatchRange& match, Scratch& scratch) const;
+
+    size_t LongestMatchLength(std::string_view strView) const;
+
+    static uint64_t NextId();
+
+    // The scratch of the calling thread for this RegExp, and the given scratch made ready for it.
+    Scratch& LocalScratch() const;
+    Scratch& Bind(Scratch& scratch) const;
+
+    // Searches for the matches starting in [from, to). Without a scratch the thread's own one is used, looked up again
+    // for every match, so that a callback may search with other patterns in between.
+    MatchList FindMatchesInRange(const std::string& str, size_t from, size_t to, Scratch* scratch) const;
+
+    template <typename Callback>
+    void ForEachMatch(std::string_view str, size_t from, size_t to, Scratch* scratch, Callback&& callback) const;
+
+    std::optional<MatchRange> NextMatch(std::string_view str, size_t from, size_t to, Scratch* scratch) const;
+
+    // Finds the end of the leftmost-longest match starting in [from, to) in one forward pass, then its start by running
+    // the reversed pattern backwards from there. Either both DFAs are lazy or both are full. Sets isOutOfBudget when a
+    // lazy one had to drop its cache.
+    template <typename ForwardDfa, typename ReverseDfa>
+    std::optional<MatchRange> NextLeftmostMatch(std::string_view str, size_t from, size_t to, ForwardDfa& forwardDfa,
+        ReverseDfa& reverseDfa, bool& isOutOfBudget) const;
+
+    size_t LongestMatchLength(std::string_view strView, Scratch* scratch) const;
+
+    void Initialize(std::string_view pattern, DfaMode dfaMode, size_t dfaMemoryBudget, size_t maxRepeatCount)
     {
-        Rewriter rewriter(pattern);
-        pattern_ = rewriter.Result();
+        pattern_ = pattern;
+        dfaMemoryBudget_ = dfaMemoryBudget;
+        id_ = NextId();
 
-        Scanner scanner(pattern_);
+        Scanner scanner(pattern_, maxRepeatCount);
         const auto& tokens = scanner.ScanTokens();
 
-        Parser parser(tokens);
+        Parser parser(tokens, maxRepeatCount);
         auto parseTree = parser.Parse();
-        node_ = parseTree->ConvertToAst();
+        auto ast = parseTree->ConvertToAst();
+
+        SetCaptures(ast, parser.GroupCount());
+        node_ = Optimizer(ast).Result();
+
+        Glushkov glushkov;
+        glushkov.SetRoot(node_->BuildPositions(glushkov));
+        stats_.positions = glushkov.Size();
+        prefilter_ = Prefilter::Make(glushkov);
+
+        // Alternations of literals are searched for with all literals at once.
+        if (auto literals = AhoCorasick::Literals(node_); literals.has_value())
+        {
+            std::vector<AhoCorasick::Literal> tagged;
+
+            for (auto& literal : *literals)
+                tagged.push_back({ std::move(literal) });
+
+            literals_ = std::make_shared<const AhoCorasick>(tagged);
+            stats_.literals = tagged.size();
+        }
+
         nfa_ = std::move(node_->ToNFA());
+        stats_.nfaStates = nfa_.Size();
+
+        if (dfaMode == DfaMode::Full)
+        {
+            if (auto fullDfa = FullDFA::Make(nfa_); fullDfa.has_value())
+            {
+                SetFullDfa(std::make_shared<const FullDFA>(std::move(*fullDfa)));
+                SetSearchDfas(DfaMode::Full);
+                return;
+            }
+        }
+
+        SetSearchDfas(DfaMode::Lazy);
+
+        // Small patterns are matched bit-parallel wherever a match is anchored.
+        if (auto matcher = BitParallelMatcher::Make(glushkov); matcher.has_value())
+        {
+            bitParallel_ = std::make_shared<BitParallelMatcher>(std::move(*matcher));
+            stats_.isBitParallel = true;
+            stats_.byteClasses = bitParallel_->GetByteClasses().Count();
+            return;
+        }
+
+        dfa_ = std::make_shared<LazyDFA>(nfa_, dfaMemoryBudget);
+        stats_.byteClasses = dfa_->GetByteClasses().Count();
     }
 };
 
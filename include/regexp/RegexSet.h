@@ -0,0 +1,100 @@
+#pragma once
+#include "AhoCorasick.h"
+#include "AstNode.h"
+#include "AutomatonFile.h"
+#include "DFA.h"
+#include "FullDFA.h"
+#include "NFA.h"
+#include "Scanner.h"
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Many patterns compiled into one automaton. The final state of every pattern is tagged with the pattern's index, so a
+// single scan of the input tells which of the patterns match.
+class RegexSet
+{
+public:
+    struct SetMatch
+    {
+        size_t id = 0;
+        size_t length = 0;
+
+        bool operator==(const SetMatch& rhs) const = default;
+    };
+
+    // The lazy DFA state cache of one thread, the same as RegExp::Scratch.
+    class Scratch
+    {
+        friend class RegexSet;
+
+        uint64_t id_ = 0;
+        std::optional<LazyDFA> dfa_ = {};
+
+    public:
+        Scratch() = default;
+        explicit Scratch(const RegexSet& set);
+    };
+
+    // Number of scratches each thread keeps for the sets it searched last.
+    constexpr static size_t kScratchPoolSize = 4;
+
+private:
+    std::vector<std::string> patterns_ = {};
+    NFA nfa_;
+    std::shared_ptr<const LazyDFA> dfa_ = {};
+    std::shared_ptr<const FullDFA> fullDfa_ = {};
+
+    // Set when every pattern is an alternation of literals. The literal automaton answers the searches then, there is
+    // no lazy DFA, and the NFA is only kept for Save.
+    std::shared_ptr<const AhoCorasick> literals_ = {};
+
+    // Identifies the compiled set to the scratches made for it, as with RegExp.
+    uint64_t id_ = 0;
+
+public:
+    // Counted repetitions of every pattern may expand to at most maxRepeatCount symbols, see Scanner.
+    explicit RegexSet(const std::vector<std::string>& patterns,
+        size_t dfaMemoryBudget = LazyDFA::kDefaultMemoryBudget,
+        size_t maxRepeatCount = Scanner::kDefaultMaxRepeatCount);
+
+    explicit RegexSet(const std::vector<AstNode::AstNodePtr>& nodes,
+        size_t dfaMemoryBudget = LazyDFA::kDefaultMemoryBudget);
+
+public:
+    // Indices of the patterns matching the whole string, in increasing order.
+    std::vector<size_t> Matches(std::string_view str) const;
+    std::vector<size_t> Matches(std::string_view str, Scratch& scratch) const;
+
+    // Longest non-empty match at the start of the string for every pattern that has one, in increasing order of ids.
+    std::vector<SetMatch> LongestMatches(std::string_view str) const;
+    std::vector<SetMatch> LongestMatches(std::string_view str, Scratch& scratch) const;
+
+    size_t Size() const noexcept;
+    const std::string& Pattern(size_t id) const;
+
+    // Same as RegExp::Save and RegExp::Load. A loaded set searches the mapped DFA.
+    void Save(const std::string& path) const;
+    static RegexSet Load(const std::string& path, AutomatonFile::Verify verify = AutomatonFile::Verify::Structure);
+
+private:
+    RegexSet() = default;
+
+    void Initialize(const std::vector<AstNode::AstNodePtr>& nodes, size_t dfaMemoryBudget);
+
+    // The scratch of the calling thread for this set, and the given scratch made ready for it.
+    Scratch& LocalScratch() const;
+    Scratch& Bind(Scratch& scratch) const;
+
+    static AstNode::AstNodePtr Parse(std::string_view pattern, size_t maxRepeatCount);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
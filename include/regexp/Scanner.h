@@ -1,5 +1,6 @@
 #pragma once
 #include "Token.h"
+#include <optional>
 #include <vector>
 
 namespace Regex
@@ -11,10 +12,18 @@ class Scanner
     std::string src_ = {};
     std::vector<Token> tokens_ = {};
     size_t pos_ = 0;
+    size_t maxRepeatCount_ = kDefaultMaxRepeatCount;
 
 public:
-    explicit Scanner(std::string src)
+    // Counted repetitions are compiled into a copy of their operand per count, so the counts are capped. The Scanner
+    // rejects single counts above the limit, building the AST rejects repetitions that expand to more symbols than the
+    // limit, which covers nested ones like ((a{100}){100}){100}.
+    static constexpr size_t kDefaultMaxRepeatCount = 1000;
+
+public:
+    explicit Scanner(std::string src, size_t maxRepeatCount = kDefaultMaxRepeatCount)
         : src_(std::move(src))
+        , maxRepeatCount_(maxRepeatCount)
     {}
 
 public:
@@ -23,6 +32,11 @@ public:
 private:
     Token ScanToken();
     Token ScanEscaped();
+    Token ScanClass();
+    Token ScanCounter();
+
+    char ScanEscapedChar(char ch);
+    std::optional<size_t> ScanNumber();
 
     bool IsAtEnd() const noexcept;
 };
@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Set of integers below a fixed capacity with O(1) insertion, lookup and clearing. The dense array keeps the members
+// in insertion order, the sparse array maps a member to its position in the dense one. Nothing is allocated after
+// construction.
+class SparseSet
+{
+    std::vector<uint32_t> dense_ = {};
+    std::vector<uint32_t> sparse_ = {};
+    size_t size_ = 0;
+
+public:
+    SparseSet() = default;
+
+    explicit SparseSet(size_t capacity)
+        : dense_(capacity)
+        , sparse_(capacity)
+    {}
+
+public:
+    bool Contains(uint32_t value) const noexcept
+    {
+        auto idx = sparse_[value];
+        return idx < size_ && dense_[idx] == value;
+    }
+
+    bool Insert(uint32_t value) noexcept
+    {
+        if (Contains(value))
+            return false;
+
+        sparse_[value] = static_cast<uint32_t>(size_);
+        dense_[size_++] = value;
+
+        return true;
+    }
+
+    void Clear() noexcept
+    {
+        size_ = 0;
+    }
+
+    void Resize(size_t capacity)
+    {
+        dense_.assign(capacity, 0);
+        sparse_.assign(capacity, 0);
+        size_ = 0;
+    }
+
+public:
+    size_t Size() const noexcept
+    {
+        return size_;
+    }
+
+    size_t Capacity() const noexcept
+    {
+        return dense_.size();
+    }
+
+    bool Empty() const noexcept
+    {
+        return size_ == 0;
+    }
+
+    auto begin() const noexcept
+    {
+        return dense_.begin();
+    }
+
+    auto end() const noexcept
+    {
+        return dense_.begin() + static_cast<std::ptrdiff_t>(size_);
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -1,50 +1,35 @@
 #pragma once
-#include <map>
-#include <memory>
+#include "CharSet.h"
+
+#include <cstdint>
 #include <set>
 
 namespace Regex
 {
 // ---------------------------------------------------------------------------------------------------------------------
 
-class State;
-
 using Index = size_t;
 using IndexSet = std::set<Index>;
-using StatePtr = std::shared_ptr<State>;
-using StatePtrSet = std::set<StatePtr>;
+
+// States of an NFA are plain indices into its arena.
+using StateId = uint32_t;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Transition on any byte of a set, the sets are stored once per NFA and referred to by their index.
+struct Transition
+{
+    uint32_t charSet = 0;
+    StateId target = 0;
+};
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-class State
+// Part of an NFA under construction with a single entry and a single exit state.
+struct Fragment
 {
-    std::map<char, StatePtrSet> transitions_ = {};
-    inline const static StatePtrSet kEmptySet = {};
-
-public:
-    static StatePtr Make()
-    {
-        return std::make_shared<State>();
-    }
-
-public:
-    StatePtrSet& operator[](char symbol)
-    {
-        return transitions_[symbol];
-    }
-
-    const StatePtrSet& At(char symbol) const
-    {
-        if (transitions_.contains(symbol))
-            return kEmptySet;
-
-        return transitions_.at(symbol);
-    }
-
-    void AddTransition(char symbol, const StatePtr& state)
-    {
-        transitions_[symbol].insert(state);
-    }
+    StateId start = 0;
+    StateId end = 0;
 };
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -0,0 +1,103 @@
+#pragma once
+#include "AhoCorasick.h"
+#include "DFA.h"
+#include "FullDFA.h"
+#include "NFA.h"
+#include "Prefilter.h"
+#include "RegExp.h"
+
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace Regex
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Finds the same matches as RegExp::FindMatches over input that arrives in chunks. The matches are reported through
+// the callback with their absolute offsets.
+//
+// The leftmost DFA of the unanchored search reads every byte once, its state carried from one call to Feed to the
+// next. When a match has ended, the reverse DFA finds its start within the buffered bytes. Only the bytes from the
+// start of the earliest group of the search that can still match are buffered: the matcher drops the others whenever
+// the DFA is back in its start state, and otherwise looks for the earliest live group each time the buffer has doubled,
+// so that this stays linear in the input. Alternations of literals are searched for with the RegExp's automaton of
+// them, keeping no more than the longest literal. Patterns whose lazy DFAs do not fit into the memory budget are
+// matched by the NFA, at one start position after another.
+//
+// The matcher owns its own automata, so it needs no locking, but one matcher must not be fed from several threads.
+class StreamMatcher
+{
+public:
+    using Callback = std::function<void(size_t offset, size_t length)>;
+
+    // Bytes a search may buffer before the first look for its earliest live group.
+    constexpr static size_t kMinTrimSize = 256;
+
+private:
+    std::shared_ptr<const AhoCorasick> literals_ = {};
+    std::shared_ptr<const FullDFA> fullLeftmostDfa_ = {};
+    std::shared_ptr<const FullDFA> fullReverseDfa_ = {};
+    std::optional<LeftmostDFA> leftmostDfa_ = {};
+    std::optional<LazyDFA> reverseDfa_ = {};
+
+    // Reversed prefixes of the matches, run backwards to find the earliest live group. The lazy one is built from the
+    // NFA, a loaded RegExp brings the full one.
+    std::shared_ptr<const FullDFA> fullPrefixDfa_ = {};
+    std::optional<LazyDFA> prefixDfa_ = {};
+
+    AstNode::AstNodePtr node_ = {};
+    std::optional<NFA> nfa_ = {};
+    Prefilter prefilter_ = {};
+    Callback callback_ = {};
+
+    // Bytes not consumed yet, the first one at the absolute offset offset_. The search in progress started at from_,
+    // the DFA has read the bytes up to pos_ and the longest match seen so far ends at end_, or end_ is 0. The buffer
+    // may grow to trimSize_ bytes after from_ before the earliest live group is looked for.
+    std::string buffer_ = {};
+    size_t offset_ = 0;
+    size_t from_ = 0;
+    size_t pos_ = 0;
+    size_t end_ = 0;
+    size_t trimSize_ = kMinTrimSize;
+
+    uint32_t state_ = 0;
+    bool useNfa_ = false;
+
+public:
+    StreamMatcher(const RegExp& regexp, Callback callback);
+
+public:
+    void Feed(std::string_view chunk);
+
+    // Reports the matches cut off by the end of the input and resets the matcher for a new stream.
+    void Finish();
+
+    size_t BufferedSize() const noexcept;
+
+private:
+    void Scan(bool isAtEnd);
+    void ScanLiterals(bool isAtEnd);
+    void ScanNfa(bool isAtEnd);
+
+    // Returns false when a lazy DFA ran out of its memory budget.
+    template <typename ForwardDfa, typename ReverseDfa>
+    bool ScanDfa(ForwardDfa& forwardDfa, ReverseDfa& reverseDfa, bool isAtEnd);
+
+    // Reads the search in progress again with the fresh cache of the lazy DFA after it was dropped.
+    bool Replay();
+
+    // Moves from_ up to the start of the earliest group that can still match.
+    void Trim();
+
+    // Bytes from pos on at the end of the buffer that can start a literal prefix cut by the end of the chunk.
+    size_t PrefixTail(size_t pos, bool isAtEnd) const noexcept;
+
+    // Starts the next search at the given position of the buffer.
+    void Restart(size_t from);
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex
\ No newline at end of file
@@ -1,5 +1,8 @@
 #pragma once
+#include "CharSet.h"
+
 #include <algorithm>
+#include <cstdint>
 #include <format>
 #include <set>
 
@@ -11,6 +14,8 @@ enum class TokenType
 {
     Symbol,
     MetaChar,
+    Class,
+    Counter,
     Empty,
     EndOfInput,
     Error
@@ -23,6 +28,13 @@ class Token
     TokenType type_ = TokenType::Empty;
     char symbol_ = 0;
     bool isEscaped_ = false;
+    CharSet charSet_ = {};
+    size_t minCount_ = 0;
+    size_t maxCount_ = 0;
+
+public:
+    // Upper bound of a counter such as {2,} that has none.
+    static constexpr size_t kUnbounded = SIZE_MAX;
 
 private:
     Token() = default;
@@ -65,14 +77,15 @@ private:
     }
 
 public:
+    // Escaped characters and classes never compare equal to the syntax characters the parser looks for.
     bool operator==(char ch) const noexcept
     {
-        return symbol_ == ch;
+        return !isEscaped_ && !IsClass() && !IsCounter() && symbol_ == ch;
     }
 
     bool operator!=(char ch) const noexcept
     {
-        return symbol_ != ch;
+        return !(*this == ch);
     }
 
 public:
@@ -88,7 +101,7 @@ public:
 
     bool IsLiteral() const noexcept
     {
-        return !IsMetaChar() && !IsEndToken();
+        return !IsMetaChar() && !IsCounter() && !IsEndToken();
     }
 
     bool IsEscaped() const noexcept
@@ -96,6 +109,31 @@ public:
         return isEscaped_;
     }
 
+    bool IsClass() const noexcept
+    {
+        return type_ == TokenType::Class;
+    }
+
+    const CharSet& Class() const noexcept
+    {
+        return charSet_;
+    }
+
+    bool IsCounter() const noexcept
+    {
+        return type_ == TokenType::Counter;
+    }
+
+    size_t MinCount() const noexcept
+    {
+        return minCount_;
+    }
+
+    size_t MaxCount() const noexcept
+    {
+        return maxCount_;
+    }
+
     bool IsMetaChar() const noexcept
     {
         const static std::set<char> kMetaChars = { '*', '+', '?' };
@@ -108,7 +146,7 @@ public:
 
     bool IsEmpty() const noexcept
     {
-        return symbol_ == 0;
+        return symbol_ == 0 && !IsClass();
     }
 
     bool IsEndToken() const noexcept
@@ -120,7 +158,7 @@ public:
     {
         return std::ranges::any_of(symbols, [this](char ch)
         {
-            return ch == symbol_;
+            return *this == ch;
         });
     }
 
@@ -128,7 +166,7 @@ public:
     {
         return std::ranges::none_of(symbols, [this](char ch)
         {
-            return ch == symbol_;
+            return *this == ch;
         });
     }
 
@@ -138,6 +176,26 @@ public:
         return Token(ch, isEscaped);
     }
 
+    static Token FromClass(const CharSet& charSet)
+    {
+        Token result;
+        result.type_ = TokenType::Class;
+        result.charSet_ = charSet;
+
+        return result;
+    }
+
+    // Counted repetition {min,max}, the symbol is kept for error messages.
+    static Token FromCounter(size_t minCount, size_t maxCount)
+    {
+        Token result('{');
+        result.type_ = TokenType::Counter;
+        result.minCount_ = minCount;
+        result.maxCount_ = maxCount;
+
+        return result;
+    }
+
     static Token Empty()
     {
         return Token();
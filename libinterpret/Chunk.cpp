@@ -0,0 +1,118 @@
+#include "Chunk.h"
+#include "Closure.h"
+
+using namespace Core;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+size_t Chunk::AddConstant(const Object& value)
+{
+    for (size_t idx = 0; idx < constants_.size(); ++idx)
+    {
+        auto& constant = constants_[idx];
+
+        if (constant.Type() != value.Type())
+            continue;
+
+        if (value.IsDouble() && constant.ToDouble() == value.ToDouble())
+            return idx;
+
+        if (value.IsString() && constant.ToString() == value.ToString())
+            return idx;
+    }
+
+    constants_.push_back(value);
+    return constants_.size() - 1;
+}
+
+Token Chunk::SiteAt(size_t offset) const
+{
+    if (auto it = sites_.find(offset); it != sites_.end())
+        return it->second;
+
+    return Token::EndOfFile(0);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+std::string Chunk::Disassemble(const std::string& name) const
+{
+    using enum OpCode;
+
+    const static std::map<OpCode, std::string> kNames = {
+        {Constant, "Constant"},         {Null, "Null"},                 {True, "True"},
+        {False, "False"},               {Pop, "Pop"},                   {PopResult, "PopResult"},
+        {Result, "Result"},             {GetLocal, "GetLocal"},         {SetLocal, "SetLocal"},
+        {GetGlobal, "GetGlobal"},       {SetGlobal, "SetGlobal"},       {DefineGlobal, "DefineGlobal"},
+        {GetUpvalue, "GetUpvalue"},     {SetUpvalue, "SetUpvalue"},     {CloseUpvalue, "CloseUpvalue"},
+        {Equal, "Equal"},               {NotEqual, "NotEqual"},         {Less, "Less"},
+        {LessEqual, "LessEqual"},       {More, "More"},                 {MoreEqual, "MoreEqual"},
+        {Add, "Add"},                   {Subtract, "Subtract"},         {Multiply, "Multiply"},
+        {Divide, "Divide"},             {Not, "Not"},                   {Negate, "Negate"},
+        {Print, "Print"},               {Jump, "Jump"},                 {JumpIfFalse, "JumpIfFalse"},
+        {JumpIfTrue, "JumpIfTrue"},     {PopJumpIfFalse, "PopJumpIfFalse"},
+        {Loop, "Loop"},                 {Call, "Call"},                 {MakeClosure, "MakeClosure"},
+        {Return, "Return"}
+    };
+
+    std::ostringstream oss;
+    oss << std::format("== {} ==\n", name);
+
+    auto readShort = [this](size_t at)
+    {
+        return static_cast<uint16_t>((code_[at] << 8) | code_[at + 1]);
+    };
+
+    for (size_t offset = 0; offset < code_.size();)
+    {
+        auto op = static_cast<OpCode>(code_[offset]);
+        oss << std::format("{:04} {}", offset, kNames.at(op));
+        ++offset;
+
+        switch (op)
+        {
+            case Constant:
+                oss << std::format(" {}", constants_[readShort(offset)].ToString());
+                offset += 2;
+                break;
+            case GetGlobal:
+            case SetGlobal:
+            case DefineGlobal:
+                oss << std::format(" {}", readShort(offset));
+                offset += 2;
+                break;
+            case Jump:
+            case JumpIfFalse:
+            case JumpIfTrue:
+            case PopJumpIfFalse:
+                oss << std::format(" -> {}", offset + 2 + readShort(offset));
+                offset += 2;
+                break;
+            case Loop:
+                oss << std::format(" -> {}", offset + 2 - readShort(offset));
+                offset += 2;
+                break;
+            case GetLocal:
+            case SetLocal:
+            case GetUpvalue:
+            case SetUpvalue:
+            case Call:
+                oss << std::format(" {}", code_[offset]);
+                offset += 1;
+                break;
+            case MakeClosure:
+            {
+                auto& proto = *prototypes_[readShort(offset)];
+                oss << std::format(" <fn {}>", proto.name);
+                offset += 2 + 2 * proto.upvalueCount;
+                break;
+            }
+            default:
+                break;
+        }
+
+        oss << '\n';
+    }
+
+    return oss.str();
+}
\ No newline at end of file
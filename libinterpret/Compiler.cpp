@@ -0,0 +1,500 @@
+#include "Compiler.h"
+#include "ExpressionAst.h"
+#include "Runner.h"
+#include "StatementAst.h"
+#include "VM.h"
+
+using namespace Core;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+Ptr<const Prototype> Compiler::Compile(const PtrVector<StmtAst>& statements)
+{
+    FunctionState script;
+    script.proto = std::make_shared<Prototype>();
+    script.proto->name = "script";
+    script.locals.push_back({});
+
+    current_ = &script;
+
+    for (auto& stmt : statements)
+    {
+        Compile(stmt);
+    }
+
+    Emit(OpCode::Null);
+    Emit(OpCode::Return);
+
+    current_ = nullptr;
+    return script.proto;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void Compiler::Compile(const Ptr<StmtAst>& stmt)
+{
+    stmt->Accept(*this);
+}
+
+void Compiler::Compile(const Ptr<ExprAst>& expr)
+{
+    expr->Accept(*this);
+}
+
+void Compiler::CompileFunction(const FunctionStmt* stmt)
+{
+    FunctionState function;
+    function.enclosing = current_;
+    function.proto = std::make_shared<Prototype>();
+    function.proto->name = stmt->name.Lexeme();
+    function.proto->arity = static_cast<int>(stmt->params_.size());
+    function.locals.push_back({});
+    function.scopeDepth = 1;
+
+    current_ = &function;
+
+    for (auto& param : stmt->params_)
+    {
+        AddLocal(param);
+    }
+
+    for (auto& bodyStmt : stmt->body)
+    {
+        Compile(bodyStmt);
+    }
+
+    Emit(OpCode::Null);
+    Emit(OpCode::Return);
+
+    current_ = function.enclosing;
+
+    function.proto->upvalueCount = static_cast<int>(function.upvalues.size());
+    auto protoIdx = CurrentChunk().AddPrototype(function.proto);
+
+    EmitShort(OpCode::MakeClosure, protoIdx);
+
+    for (auto& upvalue : function.upvalues)
+    {
+        CurrentChunk().Write(static_cast<uint8_t>(upvalue.isLocal));
+        CurrentChunk().Write(upvalue.index);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void Compiler::BeginScope()
+{
+    ++current_->scopeDepth;
+}
+
+void Compiler::EndScope()
+{
+    auto& locals = current_->locals;
+    --current_->scopeDepth;
+
+    while (!locals.empty() && locals.back().depth > current_->scopeDepth)
+    {
+        Emit(locals.back().isCaptured ? OpCode::CloseUpvalue : OpCode::Pop);
+        locals.pop_back();
+    }
+}
+
+void Compiler::AddLocal(const Token& name)
+{
+    if (current_->locals.size() >= kMaxLocals)
+    {
+        Runner::Error(name, "Too many local variables in function.");
+        return;
+    }
+
+    current_->locals.push_back({name.Lexeme(), current_->scopeDepth, false});
+}
+
+void Compiler::DefineVariable(const Token& name)
+{
+    if (current_->scopeDepth > 0)
+    {
+        // The value is already on top of the stack, which is exactly the slot of the new local.
+        AddLocal(name);
+        return;
+    }
+
+    EmitShort(OpCode::DefineGlobal, vm_.GlobalSlot(name.Lexeme()));
+}
+
+void Compiler::EmitGet(const Token& name)
+{
+    if (int slot = ResolveLocal(current_, name.Lexeme()); slot >= 0)
+    {
+        Emit(OpCode::GetLocal, static_cast<uint8_t>(slot));
+        return;
+    }
+
+    if (int idx = ResolveUpvalue(current_, name.Lexeme()); idx >= 0)
+    {
+        Emit(OpCode::GetUpvalue, static_cast<uint8_t>(idx));
+        return;
+    }
+
+    CurrentChunk().MarkSite(name);
+    EmitShort(OpCode::GetGlobal, vm_.GlobalSlot(name.Lexeme()));
+}
+
+void Compiler::EmitSet(const Token& name)
+{
+    if (int slot = ResolveLocal(current_, name.Lexeme()); slot >= 0)
+    {
+        Emit(OpCode::SetLocal, static_cast<uint8_t>(slot));
+        return;
+    }
+
+    if (int idx = ResolveUpvalue(current_, name.Lexeme()); idx >= 0)
+    {
+        Emit(OpCode::SetUpvalue, static_cast<uint8_t>(idx));
+        return;
+    }
+
+    CurrentChunk().MarkSite(name);
+    EmitShort(OpCode::SetGlobal, vm_.GlobalSlot(name.Lexeme()));
+}
+
+int Compiler::ResolveLocal(FunctionState* state, const std::string& name) const
+{
+    auto& locals = state->locals;
+
+    for (int i = static_cast<int>(locals.size()) - 1; i > 0; --i)
+    {
+        if (locals[i].name == name)
+            return i;
+    }
+
+    return -1;
+}
+
+int Compiler::ResolveUpvalue(FunctionState* state, const std::string& name)
+{
+    if (state->enclosing == nullptr)
+        return -1;
+
+    if (int local = ResolveLocal(state->enclosing, name); local >= 0)
+    {
+        state->enclosing->locals[local].isCaptured = true;
+        return AddUpvalue(state, static_cast<uint8_t>(local), true);
+    }
+
+    if (int upvalue = ResolveUpvalue(state->enclosing, name); upvalue >= 0)
+    {
+        return AddUpvalue(state, static_cast<uint8_t>(upvalue), false);
+    }
+
+    return -1;
+}
+
+int Compiler::AddUpvalue(FunctionState* state, uint8_t index, bool isLocal)
+{
+    auto& upvalues = state->upvalues;
+
+    for (size_t i = 0; i < upvalues.size(); ++i)
+    {
+        if (upvalues[i].index == index && upvalues[i].isLocal == isLocal)
+            return static_cast<int>(i);
+    }
+
+    if (upvalues.size() >= kMaxLocals)
+    {
+        Runner::Error(0, "Too many closure variables in function.");
+        return 0;
+    }
+
+    upvalues.push_back({index, isLocal});
+    return static_cast<int>(upvalues.size() - 1);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+Chunk& Compiler::CurrentChunk()
+{
+    return current_->proto->chunk;
+}
+
+void Compiler::Emit(OpCode op)
+{
+    CurrentChunk().Write(op);
+}
+
+void Compiler::Emit(OpCode op, uint8_t operand)
+{
+    CurrentChunk().Write(op);
+    CurrentChunk().Write(operand);
+}
+
+void Compiler::EmitShort(OpCode op, size_t operand)
+{
+    if (operand > kMaxIndex)
+    {
+        Runner::Error(0, "Too many constants in one chunk.");
+        return;
+    }
+
+    CurrentChunk().Write(op);
+    CurrentChunk().WriteShort(static_cast<uint16_t>(operand));
+}
+
+void Compiler::EmitConstant(const Object& value)
+{
+    EmitShort(OpCode::Constant, CurrentChunk().AddConstant(value));
+}
+
+void Compiler::EmitLoop(size_t loopStart)
+{
+    Emit(OpCode::Loop);
+
+    auto offset = CurrentChunk().Size() - loopStart + 2;
+
+    if (offset > kMaxIndex)
+        Runner::Error(0, "Loop body too large.");
+
+    CurrentChunk().WriteShort(static_cast<uint16_t>(offset));
+}
+
+size_t Compiler::EmitJump(OpCode op)
+{
+    Emit(op);
+    CurrentChunk().WriteShort(UINT16_MAX);
+
+    return CurrentChunk().Size() - 2;
+}
+
+void Compiler::PatchJump(size_t offset)
+{
+    auto jump = CurrentChunk().Size() - offset - 2;
+
+    if (jump > kMaxIndex)
+        Runner::Error(0, "Too much code to jump over.");
+
+    CurrentChunk().PatchShort(offset, static_cast<uint16_t>(jump));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void Compiler::Visit(const BlockStmt* stmt)
+{
+    BeginScope();
+
+    for (auto& inner : stmt->statements)
+    {
+        Compile(inner);
+    }
+
+    EndScope();
+}
+
+void Compiler::Visit(const ExpressionStmt* stmt)
+{
+    Compile(stmt->expr);
+    Emit(OpCode::PopResult);
+}
+
+void Compiler::Visit(const FunctionStmt* stmt)
+{
+    if (current_->scopeDepth > 0)
+    {
+        // Declared up front so that the body can refer to itself through an upvalue.
+        AddLocal(stmt->name);
+        CompileFunction(stmt);
+        return;
+    }
+
+    CompileFunction(stmt);
+    DefineVariable(stmt->name);
+}
+
+void Compiler::Visit(const IfStmt* stmt)
+{
+    Compile(stmt->condition);
+    auto thenJump = EmitJump(OpCode::PopJumpIfFalse);
+
+    Compile(stmt->thenBranch);
+
+    if (!stmt->elseBranch)
+    {
+        PatchJump(thenJump);
+        return;
+    }
+
+    auto elseJump = EmitJump(OpCode::Jump);
+    PatchJump(thenJump);
+
+    Compile(stmt->elseBranch);
+    PatchJump(elseJump);
+}
+
+void Compiler::Visit(const PrintStmt* stmt)
+{
+    Compile(stmt->expression);
+    Emit(OpCode::Print);
+}
+
+void Compiler::Visit(const ReturnStmt* stmt)
+{
+    if (stmt->value)
+    {
+        Compile(stmt->value);
+    }
+    else
+    {
+        Emit(OpCode::Null);
+    }
+
+    Emit(OpCode::Return);
+}
+
+void Compiler::Visit(const VarStmt* stmt)
+{
+    if (stmt->initializer)
+    {
+        Compile(stmt->initializer);
+        Emit(OpCode::Result);
+    }
+    else
+    {
+        Emit(OpCode::Null);
+    }
+
+    DefineVariable(stmt->name);
+}
+
+void Compiler::Visit(const WhileStmt* stmt)
+{
+    auto loopStart = CurrentChunk().Size();
+
+    Compile(stmt->condition);
+    auto exitJump = EmitJump(OpCode::PopJumpIfFalse);
+
+    Compile(stmt->body);
+    EmitLoop(loopStart);
+
+    PatchJump(exitJump);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void Compiler::Visit(const AssignExpr* expr)
+{
+    Compile(expr->value);
+    EmitSet(expr->name);
+}
+
+void Compiler::Visit(const BinaryExpr* expr)
+{
+    Compile(expr->left);
+    Compile(expr->right);
+
+    switch (expr->operatorToken.Type())
+    {
+        case TokenType::EqualEqual:
+            Emit(OpCode::Equal);
+            break;
+        case TokenType::NotEqual:
+            Emit(OpCode::NotEqual);
+            break;
+        case TokenType::Plus:
+            Emit(OpCode::Add);
+            break;
+        case TokenType::Minus:
+            Emit(OpCode::Subtract);
+            break;
+        case TokenType::Slash:
+            Emit(OpCode::Divide);
+            break;
+        case TokenType::Asterisk:
+            Emit(OpCode::Multiply);
+            break;
+        case TokenType::Less:
+            Emit(OpCode::Less);
+            break;
+        case TokenType::LessEqual:
+            Emit(OpCode::LessEqual);
+            break;
+        case TokenType::More:
+            Emit(OpCode::More);
+            break;
+        case TokenType::MoreEqual:
+            Emit(OpCode::MoreEqual);
+            break;
+        default:
+            break;
+    }
+}
+
+void Compiler::Visit(const CallExpr* expr)
+{
+    Compile(expr->callee);
+
+    for (auto& arg : expr->args)
+    {
+        Compile(arg);
+    }
+
+    CurrentChunk().MarkSite(expr->paren);
+    Emit(OpCode::Call, static_cast<uint8_t>(expr->args.size()));
+}
+
+void Compiler::Visit(const GroupingExpr* expr)
+{
+    Compile(expr->expr);
+}
+
+void Compiler::Visit(const LiteralExpr* expr)
+{
+    auto& value = expr->value;
+
+    if (value.IsNull())
+    {
+        Emit(OpCode::Null);
+    }
+    else if (value.IsBool())
+    {
+        Emit(value.ToBool() ? OpCode::True : OpCode::False);
+    }
+    else
+    {
+        EmitConstant(value);
+    }
+}
+
+void Compiler::Visit(const LogicalExpr* expr)
+{
+    Compile(expr->left);
+
+    auto op = expr->op.IsOfType(TokenType::Or) ? OpCode::JumpIfTrue : OpCode::JumpIfFalse;
+    auto endJump = EmitJump(op);
+
+    Emit(OpCode::Pop);
+    Compile(expr->right);
+
+    PatchJump(endJump);
+}
+
+void Compiler::Visit(const UnaryExpr* expr)
+{
+    Compile(expr->right);
+
+    switch (expr->op.Type())
+    {
+        case TokenType::Minus:
+            CurrentChunk().MarkSite(expr->op);
+            Emit(OpCode::Negate);
+            break;
+        case TokenType::Not:
+            Emit(OpCode::Not);
+            break;
+        default:
+            break;
+    }
+}
+
+void Compiler::Visit(const VariableExpr* expr)
+{
+    EmitGet(expr->name);
+}
\ No newline at end of file
@@ -1,4 +1,5 @@
 #include "Object.h"
+#include "Closure.h"
 #include "Common.h"
 #include "Error.h"
 
@@ -21,6 +22,7 @@ std::string Object::TypeName() const
         case Double:   return "Number";
         case String:   return "String";
         case Function: return "Function";
+        case Closure:  return "Function";
         default:       return "Null";
     }
 }
@@ -30,6 +32,11 @@ bool Object::IsBool() const noexcept
     return type_ == ObjectType::Bool;
 }
 
+bool Object::IsClosure() const noexcept
+{
+    return type_ == ObjectType::Closure;
+}
+
 bool Object::IsDouble() const noexcept
 {
     return type_ == ObjectType::Double;
@@ -87,6 +94,12 @@ std::shared_ptr<Function> Object::ToFunction() const
     return std::get<T>(value_);
 }
 
+std::shared_ptr<Closure> Object::ToClosure() const
+{
+    using T = std::shared_ptr<Closure>;
+    return std::get<T>(value_);
+}
+
 std::string Object::ToString() const
 {
     switch (type_)
@@ -97,6 +110,8 @@ std::string Object::ToString() const
             return std::format("{}", ToDouble());
         case ObjectType::String:
             return std::get<std::string>(value_);
+        case ObjectType::Closure:
+            return ToClosure()->ToString();
         default:
             return "Null";
     }
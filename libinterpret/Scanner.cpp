@@ -1,7 +1,8 @@
 #include "Scanner.h"
 #include "Runner.h"
+#include "ScannerLexer.h"
 
-#include <regexp/RegExp.h>
+#include <algorithm>
 
 using namespace Core;
 
@@ -24,103 +25,58 @@ void Scanner::ScanToken()
 {
     using enum TokenType;
 
-    while (std::isspace(Peek()))
-    {
-        if (Peek() == '\n')
-            ++line_;
-        Advance();
-    }
-
-    if (Peek() == '"')
-    {
-        Advance();
-        AddString();
-        return;
-    }
+    // The tokens are those of Scanner.lexer, compiled into a matcher at build time.
+    auto [kind, length] = ScannerLexer::Next(source_, pos_);
 
-    if (std::isdigit(Peek()))
+    if (kind == ScannerLexer::kNoMatch)
     {
-        AddNumber();
-        return;
-    }
+        // A stray EOF byte is skipped silently.
+        if (Peek() != EOF)
+            Runner::Error(line_, std::format("Unexpected character: {}.", Peek()));
 
-    if (std::isalpha(Peek()) || Peek() == '_')
-    {
-        AddIdentifier();
+        ++pos_;
         return;
     }
 
-    if (Peek() == EOF)
-    {
-        Advance();
-        return;
-    }
+    auto lexeme = source_.substr(pos_, length);
+    auto type = static_cast<TokenType>(kind);
 
-    Token token = Token::FromSymbol(Peek(), line_);
-    Advance();
+    pos_ += length;
 
-    if (token.IsOfType(More, Less, Not, Equal))
+    switch (type)
     {
-        if (Peek() == '=')
+        case Empty:
+            line_ += std::ranges::count(lexeme, '\n');
+            break;
+        case Identifier:
+            tokens_.emplace_back(Token::FromIdentifier(lexeme, line_));
+            break;
+        case Number:
+            tokens_.emplace_back(Token::FromNumber(lexeme, line_));
+            break;
+        case String:
         {
-            Advance();
-            std::string twoSymbols = token.Lexeme() + '=';
-            token = Token::FromTwoSymbols(twoSymbols, line_);
+            auto closed = lexeme.size() > 1 && lexeme.back() == '"';
+            tokens_.emplace_back(Token::FromString(lexeme.substr(1, lexeme.size() - (closed ? 2 : 1)), line_));
+            break;
         }
-
-        tokens_.emplace_back(token);
-    }
-    else if (token.IsError())
-    {
-        Runner::Error(line_, std::format("Unexpected character: {}.", Peek()));
-    }
-    else
-    {
-        tokens_.emplace_back(token);
-    }
-}
-
-// ---------------------------------------------------------------------------------------------------------------------
-
-void Scanner::AddIdentifier()
-{
-    Regex::RegExp regexp("[A-Za-z_][A-Za-z0-9_]*");
-    auto str = regexp.LongestMatch(source_, pos_);
-    Token token;
-
-    if (kwMap.contains(str))
-    {
-        token = Token::FromKeyword(kwMap.at(str), str, line_);
-    }
-    else
-    {
-        token = Token::FromIdentifier(str, line_);
-    }
-
-    tokens_.emplace_back(token);
-    pos_ += str.size();
-}
-
-void Scanner::AddNumber()
-{
-    Regex::RegExp regexp("[0-9]+.?[0-9]*");
-
-    auto numStr = regexp.LongestMatch(source_, pos_);
-    pos_ += numStr.size();
-
-    tokens_.emplace_back(Token::FromNumber(numStr, line_));
-}
-
-void Scanner::AddString()
-{
-    std::string str;
-
-    while (Peek() != '"' && !IsAtEnd())
-    {
-        str += Peek();
-        Advance();
+        case And:
+        case Else:
+        case False:
+        case For:
+        case Func:
+        case If:
+        case Null:
+        case Or:
+        case Print:
+        case Return:
+        case True:
+        case Var:
+        case While:
+            tokens_.emplace_back(Token::FromKeyword(type, lexeme, line_));
+            break;
+        default:
+            tokens_.emplace_back(Token::FromSymbol(type, lexeme, line_));
+            break;
     }
-
-    Advance();
-    tokens_.emplace_back(Token::FromString(str, line_));
 }
\ No newline at end of file
@@ -10,43 +10,9 @@ Token Token::EndOfFile(size_t line)
     return {TokenType::Eof, line};
 }
 
-Token Token::FromSymbol(char symbol, size_t line)
+Token Token::FromSymbol(TokenType type, const std::string& symbols, size_t line)
 {
-    using enum TokenType;
-
-    static const std::unordered_map<char, TokenType> kSymbolMap = {
-        {'(', ParenLeft},  {')', ParenRight}, {'{', BraceLeft},
-        {'}', BraceRight}, {'+', Plus},       {'-', Minus},
-        {'*', Asterisk},   {'/', Slash},      {';', Semicolon},
-        {'!', Not},        {'=', Equal},      {'>', More},
-        {'<', Less},       {',', Comma}
-    };
-
-    std::string str(1, symbol);
-
-    if (!kSymbolMap.contains(symbol))
-    {
-        return {Error, line, str};
-    }
-
-    return {kSymbolMap.at(symbol), line, str};
-}
-
-Token Token::FromTwoSymbols(const std::string& twoSymbols, size_t line)
-{
-    using enum TokenType;
-
-    static const std::unordered_map<std::string, TokenType> kSymbolMap = {
-        {"!=", NotEqual},  {"==", EqualEqual},
-        {"<=", LessEqual}, {">=", MoreEqual}
-    };
-
-    if (!kSymbolMap.contains(twoSymbols))
-    {
-        return {Error, line, twoSymbols};
-    }
-
-    return {kSymbolMap.at(twoSymbols), line, twoSymbols};
+    return {type, line, symbols};
 }
 
 Token Token::FromIdentifier(const std::string& id, size_t line)
@@ -0,0 +1,466 @@
+#include "VM.h"
+#include "Error.h"
+#include "Runner.h"
+
+using namespace Core;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+template <typename Op>
+void BinaryOp(Object& lhs, const Object& rhs, Op op)
+{
+    // Numbers take the fast path, everything else goes through the Object operators, which also raise type errors.
+    if (lhs.IsDouble() && rhs.IsDouble())
+    {
+        lhs = op(lhs.ToDouble(), rhs.ToDouble());
+        return;
+    }
+
+    lhs = op(lhs, rhs);
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+VM::VM()
+    : stack_(kStackMax)
+    , frames_(kFramesMax)
+{
+    ResetStack();
+}
+
+Object VM::Result() const
+{
+    return result_;
+}
+
+void VM::Reset()
+{
+    ResetStack();
+
+    globals_.clear();
+    isDefined_.clear();
+    globalNames_.clear();
+    globalSlots_.clear();
+    result_ = {};
+}
+
+void VM::ResetStack()
+{
+    std::fill(stack_.begin(), stack_.end(), Object());
+    top_ = stack_.data();
+    frameCount_ = 0;
+    openUpvalues_.clear();
+}
+
+uint16_t VM::GlobalSlot(const std::string& name)
+{
+    if (auto it = globalSlots_.find(name); it != globalSlots_.end())
+        return it->second;
+
+    auto slot = static_cast<uint16_t>(globals_.size());
+
+    globals_.emplace_back();
+    isDefined_.push_back(false);
+    globalNames_.push_back(name);
+    globalSlots_.emplace(name, slot);
+
+    return slot;
+}
+
+void VM::Interpret(const Ptr<const Prototype>& script)
+{
+    try
+    {
+        auto closure = std::make_shared<Closure>(script);
+
+        *top_++ = Object(std::shared_ptr(closure));
+        Call(stack_[0], 0);
+        Run();
+    }
+    catch (TypeError& err)
+    {
+        std::cerr << err.what() << std::endl;
+        ResetStack();
+    }
+    catch (RuntimeError& err)
+    {
+        Runner::RuntimeError(err);
+        ResetStack();
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void VM::Run()
+{
+    CallFrame* frame = &frames_[frameCount_ - 1];
+    const Chunk* chunk = &frame->closure->proto->chunk;
+    const uint8_t* ip = frame->ip;
+
+    auto readByte = [&ip]()
+    {
+        return *ip++;
+    };
+
+    auto readShort = [&ip]()
+    {
+        ip += 2;
+        return static_cast<uint16_t>((ip[-2] << 8) | ip[-1]);
+    };
+
+    auto loadFrame = [&]()
+    {
+        frame = &frames_[frameCount_ - 1];
+        chunk = &frame->closure->proto->chunk;
+        ip = frame->ip;
+    };
+
+    auto push = [this](Object value)
+    {
+        *top_++ = std::move(value);
+    };
+
+    auto pop = [this]() -> Object
+    {
+        return std::move(*--top_);
+    };
+
+    auto peek = [this](size_t distance = 0) -> Object&
+    {
+        return top_[-1 - static_cast<ptrdiff_t>(distance)];
+    };
+
+    while (true)
+    {
+        frame->ip = ip;
+
+        switch (static_cast<OpCode>(readByte()))
+        {
+            case OpCode::Constant:
+                push(chunk->ConstantAt(readShort()));
+                break;
+            case OpCode::Null:
+                push(nullptr);
+                break;
+            case OpCode::True:
+                push(true);
+                break;
+            case OpCode::False:
+                push(false);
+                break;
+            case OpCode::Pop:
+                --top_;
+                break;
+            case OpCode::PopResult:
+                result_ = pop();
+                break;
+            case OpCode::Result:
+                result_ = peek();
+                break;
+            case OpCode::GetLocal:
+                push(frame->slots[readByte()]);
+                break;
+            case OpCode::SetLocal:
+                frame->slots[readByte()] = peek();
+                break;
+            case OpCode::GetGlobal:
+            {
+                auto slot = readShort();
+
+                if (!isDefined_[slot])
+                    throw RuntimeError(CurrentSite(), "Undefined variable '" + globalNames_[slot] + "'.");
+
+                push(globals_[slot]);
+                break;
+            }
+            case OpCode::SetGlobal:
+            {
+                auto slot = readShort();
+
+                if (!isDefined_[slot])
+                    throw RuntimeError(CurrentSite(), "Undefined variable '" + globalNames_[slot] + "'.");
+
+                globals_[slot] = peek();
+                break;
+            }
+            case OpCode::DefineGlobal:
+            {
+                auto slot = readShort();
+                globals_[slot] = pop();
+                isDefined_[slot] = true;
+                break;
+            }
+            case OpCode::GetUpvalue:
+                push(UpvalueValue(*frame->closure->upvalues[readByte()]));
+                break;
+            case OpCode::SetUpvalue:
+                UpvalueValue(*frame->closure->upvalues[readByte()]) = peek();
+                break;
+            case OpCode::CloseUpvalue:
+                CloseUpvalues(top_ - 1);
+                --top_;
+                break;
+            case OpCode::Equal:
+            {
+                auto r = pop();
+                peek() = IsEqual(peek(), r);
+                break;
+            }
+            case OpCode::NotEqual:
+            {
+                auto r = pop();
+                peek() = !IsEqual(peek(), r);
+                break;
+            }
+            case OpCode::Less:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x < y; });
+                --top_;
+                break;
+            case OpCode::LessEqual:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x <= y; });
+                --top_;
+                break;
+            case OpCode::More:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x > y; });
+                --top_;
+                break;
+            case OpCode::MoreEqual:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x >= y; });
+                --top_;
+                break;
+            case OpCode::Add:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x + y; });
+                --top_;
+                break;
+            case OpCode::Subtract:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x - y; });
+                --top_;
+                break;
+            case OpCode::Multiply:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x * y; });
+                --top_;
+                break;
+            case OpCode::Divide:
+                BinaryOp(peek(1), peek(), [](auto x, auto y) { return x / y; });
+                --top_;
+                break;
+            case OpCode::Not:
+                peek() = !IsTruthy(peek());
+                break;
+            case OpCode::Negate:
+                if (!peek().IsDouble())
+                    throw RuntimeError(CurrentSite(), "Operand must be a number.");
+
+                peek() = -peek().ToDouble();
+                break;
+            case OpCode::Print:
+                std::cout << Stringify(pop()) << std::endl;
+                break;
+            case OpCode::Jump:
+            {
+                auto offset = readShort();
+                ip += offset;
+                break;
+            }
+            case OpCode::JumpIfFalse:
+            {
+                auto offset = readShort();
+
+                if (!IsTruthy(peek()))
+                    ip += offset;
+                break;
+            }
+            case OpCode::JumpIfTrue:
+            {
+                auto offset = readShort();
+
+                if (IsTruthy(peek()))
+                    ip += offset;
+                break;
+            }
+            case OpCode::PopJumpIfFalse:
+            {
+                auto offset = readShort();
+
+                if (!IsTruthy(pop()))
+                    ip += offset;
+                break;
+            }
+            case OpCode::Loop:
+            {
+                auto offset = readShort();
+                ip -= offset;
+                break;
+            }
+            case OpCode::Call:
+            {
+                auto argCount = readByte();
+                Call(peek(argCount), argCount);
+
+                frame->ip = ip;
+                loadFrame();
+                break;
+            }
+            case OpCode::MakeClosure:
+            {
+                auto& proto = chunk->PrototypeAt(readShort());
+                auto closure = std::make_shared<Closure>(proto);
+
+                for (int i = 0; i < proto->upvalueCount; ++i)
+                {
+                    auto isLocal = readByte();
+                    auto index = readByte();
+
+                    if (isLocal)
+                    {
+                        closure->upvalues.push_back(CaptureUpvalue(frame->slots + index));
+                    }
+                    else
+                    {
+                        closure->upvalues.push_back(frame->closure->upvalues[index]);
+                    }
+                }
+
+                push(std::move(closure));
+                break;
+            }
+            case OpCode::Return:
+            {
+                auto result = pop();
+                CloseUpvalues(frame->slots);
+
+                top_ = frame->slots;
+                --frameCount_;
+
+                if (frameCount_ == 0)
+                {
+                    // Drop the script closure itself.
+                    *top_ = {};
+                    return;
+                }
+
+                push(std::move(result));
+                loadFrame();
+                break;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void VM::Call(const Object& callee, int argCount)
+{
+    if (!callee.IsClosure())
+        throw RuntimeError(CurrentSite(), "Can only call functions.");
+
+    auto closure = callee.ToClosure();
+    auto arity = closure->proto->arity;
+
+    if (argCount != arity)
+    {
+        constexpr static auto fmtStr = "Expected {} arguments, but got {}.";
+        throw RuntimeError(CurrentSite(), std::format(fmtStr, arity, argCount));
+    }
+
+    if (frameCount_ == kFramesMax || top_ + kFrameSlotsMax > stack_.data() + stack_.size())
+        throw RuntimeError(CurrentSite(), "Stack overflow.");
+
+    auto& frame = frames_[frameCount_++];
+    frame.closure = closure.get();
+    frame.ip = closure->proto->chunk.Code();
+    frame.slots = top_ - argCount - 1;
+}
+
+Token VM::CurrentSite() const
+{
+    if (frameCount_ == 0)
+        return Token::EndOfFile(0);
+
+    // While an instruction executes, the ip saved in its frame still points at the opcode, which is where the
+    // compiler recorded the site.
+    auto& frame = frames_[frameCount_ - 1];
+    auto& chunk = frame.closure->proto->chunk;
+
+    return chunk.SiteAt(frame.ip - chunk.Code());
+}
+
+Ptr<Upvalue> VM::CaptureUpvalue(Object* local)
+{
+    auto slot = static_cast<size_t>(local - stack_.data());
+
+    // Open upvalues are kept sorted by slot, so the search is mostly a scan over the innermost frame.
+    auto it = openUpvalues_.end();
+
+    while (it != openUpvalues_.begin() && (*(it - 1))->slot >= slot)
+    {
+        if ((*(it - 1))->slot == slot)
+            return *(it - 1);
+
+        --it;
+    }
+
+    auto upvalue = std::make_shared<Upvalue>();
+    upvalue->slot = slot;
+
+    openUpvalues_.insert(it, upvalue);
+    return upvalue;
+}
+
+void VM::CloseUpvalues(const Object* last)
+{
+    auto slot = static_cast<size_t>(last - stack_.data());
+
+    while (!openUpvalues_.empty() && openUpvalues_.back()->slot >= slot)
+    {
+        auto& upvalue = *openUpvalues_.back();
+
+        upvalue.closed = stack_[upvalue.slot];
+        upvalue.isOpen = false;
+
+        openUpvalues_.pop_back();
+    }
+}
+
+Object& VM::UpvalueValue(Upvalue& upvalue)
+{
+    if (upvalue.isOpen)
+        return stack_[upvalue.slot];
+
+    return upvalue.closed;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool VM::IsTruthy(const Object& obj)
+{
+    if (obj.IsNull())
+        return false;
+
+    if (obj.IsBool())
+        return obj.ToBool();
+
+    return true;
+}
+
+bool VM::IsEqual(const Object& l, const Object& r)
+{
+    if (l.IsNull() && r.IsNull())
+        return true;
+
+    if (l.IsNull())
+        return false;
+
+    return l == r;
+}
+
+std::string VM::Stringify(const Object& object)
+{
+    if (object.IsNull())
+        return "Null";
+
+    return object.ToString();
+}
\ No newline at end of file
@@ -0,0 +1,399 @@
+#include "AhoCorasick.h"
+#include "Ast.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+using AstType = AstNode::AstType;
+
+void SortUnique(std::vector<std::string>& strings)
+{
+    std::ranges::sort(strings);
+    strings.erase(std::unique(strings.begin(), strings.end()), strings.end());
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+AhoCorasick::AhoCorasick(const std::vector<Literal>& literals)
+{
+    // The trie keeps a map of edges per state while it grows.
+    std::vector<std::map<uint8_t, StateId>> trie(1);
+
+    depths_.assign(1, 0);
+    tags_.resize(1);
+
+    for (const auto& literal : literals)
+    {
+        StateId state = kRoot;
+
+        for (char ch : literal.text)
+        {
+            auto byte = static_cast<uint8_t>(ch);
+
+            if (auto found = trie[state].find(byte); found != trie[state].end())
+            {
+                state = found->second;
+                continue;
+            }
+
+            auto target = static_cast<StateId>(trie.size());
+
+            trie[state].emplace(byte, target);
+            trie.emplace_back();
+            depths_.push_back(depths_[state] + 1);
+            tags_.emplace_back();
+
+            state = target;
+        }
+
+        tags_[state].push_back(literal.tag);
+    }
+
+    for (const auto& edges : trie)
+    {
+        edgeOffsets_.push_back(static_cast<uint32_t>(edges_.size()));
+
+        for (auto [byte, target] : edges)
+        {
+            edges_.push_back({ byte, target });
+            byteClasses_.Add(CharClass::Single(static_cast<char>(byte)));
+        }
+    }
+
+    edgeOffsets_.push_back(static_cast<uint32_t>(edges_.size()));
+
+    // Breadth first, so the suffix link of a state leads to a state that is done already.
+    suffixLinks_.assign(trie.size(), kRoot);
+    matchLengths_.assign(trie.size(), 0);
+
+    std::vector<StateId> order = { kRoot };
+
+    for (size_t idx = 0; idx < order.size(); ++idx)
+    {
+        auto state = order[idx];
+
+        matchLengths_[state] = tags_[state].empty() ? matchLengths_[suffixLinks_[state]] : depths_[state];
+
+        for (auto pos = edgeOffsets_[state]; pos < edgeOffsets_[state + 1]; ++pos)
+        {
+            auto [byte, target] = edges_[pos];
+
+            suffixLinks_[target] = state == kRoot ? kRoot : Next(suffixLinks_[state], byte);
+            order.push_back(target);
+        }
+    }
+
+    stride_ = byteClasses_.Count();
+
+    if (trie.size() * stride_ <= kMaxDenseTableSize)
+    {
+        table_.resize(trie.size() * stride_);
+
+        for (auto state : order)
+        {
+            for (size_t cls = 0; cls < stride_; ++cls)
+            {
+                auto target = Goto(state, byteClasses_.Representative(cls));
+
+                if (target == kRoot && state != kRoot)
+                    target = table_[suffixLinks_[state] * stride_ + cls];
+
+                table_[state * stride_ + cls] = target;
+            }
+        }
+
+        kind_ = Kind::Dense;
+    }
+
+#if defined(__SSE2__)
+    for (const auto& literal : literals)
+    {
+        if (!literal.text.empty())
+            packed_.push_back(literal.text);
+    }
+
+    SortUnique(packed_);
+    std::ranges::stable_sort(packed_, [](const std::string& lhs, const std::string& rhs)
+    {
+        return lhs.size() > rhs.size();
+    });
+
+    if (!packed_.empty() && packed_.size() <= kMaxPackedLiterals)
+        kind_ = Kind::Packed;
+    else
+        packed_.clear();
+#endif
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto AhoCorasick::Find(std::string_view str, size_t from, size_t to) const -> std::optional<Match>
+{
+    if (kind_ == Kind::Packed)
+    {
+        if (auto match = FindPacked(str, from, to); match.has_value())
+            return match->offset < to ? match : std::nullopt;
+    }
+
+    std::optional<Match> best;
+    StateId state = kRoot;
+
+    for (size_t pos = from; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        // The literals still under way started at earliest or later, they cannot start further left than the best
+        // match found so far, or before the limit if there is none.
+        auto end = pos + 1;
+        auto earliest = end - depths_[state];
+
+        if (best.has_value() ? earliest > best->offset : earliest >= to)
+            break;
+
+        // Of two matches at the same offset the one found later is the longer one.
+        if (auto length = matchLengths_[state]; length > 0 && (!best.has_value() || end - length <= best->offset))
+            best = Match{end - length, length};
+    }
+
+    if (best.has_value() && best->offset >= to)
+        return std::nullopt;
+
+    return best;
+}
+
+std::vector<uint32_t> AhoCorasick::MatchingTags(std::string_view str) const
+{
+    StateId state = kRoot;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        // The walk is only anchored at the start as long as it never takes a suffix link.
+        if (depths_[state] != pos + 1)
+            return {};
+    }
+
+    auto result = tags_[state];
+
+    std::ranges::sort(result);
+    result.erase(std::unique(result.begin(), result.end()), result.end());
+
+    return result;
+}
+
+std::vector<size_t> AhoCorasick::LongestMatchPerTag(std::string_view str, size_t tagCount) const
+{
+    std::vector<size_t> result(tagCount, 0);
+    StateId state = kRoot;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        if (depths_[state] != pos + 1)
+            break;
+
+        for (auto tag : tags_[state])
+            result[tag] = pos + 1;
+    }
+
+    return result;
+}
+
+auto AhoCorasick::GetKind() const noexcept -> Kind
+{
+    return kind_;
+}
+
+size_t AhoCorasick::StateCount() const noexcept
+{
+    return depths_.size();
+}
+
+size_t AhoCorasick::MaxLength() const noexcept
+{
+    return *std::ranges::max_element(depths_);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto AhoCorasick::Literals(const AstNode::AstNodePtr& root) -> std::optional<std::vector<std::string>>
+{
+    switch (root->Type())
+    {
+    case AstType::Empty:
+        return std::vector<std::string>{ {} };
+    case AstType::Symbol:
+        return std::vector<std::string>{ std::string(1, static_cast<const SymbolAst&>(*root).Symbol()) };
+    case AstType::CharSet:
+    {
+        const auto& symbols = static_cast<const CharSetAst&>(*root).Symbols();
+
+        if (symbols.count() > kMaxLiterals)
+            return std::nullopt;
+
+        std::vector<std::string> result;
+
+        for (size_t byte = 0; byte < symbols.size(); ++byte)
+        {
+            if (symbols[byte])
+                result.emplace_back(1, static_cast<char>(byte));
+        }
+
+        return result;
+    }
+    case AstType::Alternation:
+    {
+        std::vector<std::string> result;
+
+        for (const auto& pattern : static_cast<const AlternationAst&>(*root).Patterns())
+        {
+            auto literals = Literals(pattern);
+
+            if (!literals.has_value() || result.size() + literals->size() > kMaxLiterals)
+                return std::nullopt;
+
+            result.insert(result.end(), literals->begin(), literals->end());
+        }
+
+        SortUnique(result);
+        return result;
+    }
+    case AstType::Concatenation:
+    {
+        std::vector<std::string> result = { {} };
+
+        for (const auto& pattern : static_cast<const ConcatenationAst&>(*root).Patterns())
+        {
+            auto literals = Literals(pattern);
+
+            if (!literals.has_value() || result.size() * literals->size() > kMaxLiterals)
+                return std::nullopt;
+
+            std::vector<std::string> product;
+            product.reserve(result.size() * literals->size());
+
+            for (const auto& prefix : result)
+            {
+                for (const auto& suffix : *literals)
+                    product.push_back(prefix + suffix);
+            }
+
+            result = std::move(product);
+        }
+
+        SortUnique(result);
+        return result;
+    }
+    case AstType::Optional:
+    {
+        auto result = Literals(static_cast<const OptionalAst&>(*root).Pattern());
+
+        if (!result.has_value() || result->size() + 1 > kMaxLiterals)
+            return std::nullopt;
+
+        result->emplace_back();
+        SortUnique(*result);
+
+        return result;
+    }
+    case AstType::Capture:
+        return Literals(static_cast<const CaptureAst&>(*root).Pattern());
+    default:
+        return std::nullopt;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto AhoCorasick::Next(StateId state, uint8_t byte) const -> StateId
+{
+    if (!table_.empty())
+        return table_[state * stride_ + byteClasses_[byte]];
+
+    for (;;)
+    {
+        if (auto target = Goto(state, byte); target != kRoot || state == kRoot)
+            return target;
+
+        state = suffixLinks_[state];
+    }
+}
+
+auto AhoCorasick::Goto(StateId state, uint8_t byte) const -> StateId
+{
+    auto first = edges_.begin() + edgeOffsets_[state];
+    auto last = edges_.begin() + edgeOffsets_[state + 1];
+    auto found = std::ranges::lower_bound(first, last, byte, {}, &Edge::byte);
+
+    return found != last && found->byte == byte ? found->target : kRoot;
+}
+
+auto AhoCorasick::FindPacked(std::string_view str, size_t& from, size_t to) const -> std::optional<Match>
+{
+#if defined(__SSE2__)
+    // Candidates are the offsets where both the first and the last byte of a literal match, as in the literal
+    // prefilter, for all literals on the same block.
+    __m128i firsts[kMaxPackedLiterals];
+    __m128i lasts[kMaxPackedLiterals];
+    uint32_t masks[kMaxPackedLiterals];
+
+    for (size_t idx = 0; idx < packed_.size(); ++idx)
+    {
+        firsts[idx] = _mm_set1_epi8(packed_[idx].front());
+        lasts[idx] = _mm_set1_epi8(packed_[idx].back());
+    }
+
+    auto longest = packed_.front().size();
+
+    for (; from < to && from + longest - 1 + 16 <= str.size(); from += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + from));
+        uint32_t candidates = 0;
+
+        for (size_t idx = 0; idx < packed_.size(); ++idx)
+        {
+            auto* lastBytes = str.data() + from + packed_[idx].size() - 1;
+            auto blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lastBytes));
+            auto eq = _mm_and_si128(_mm_cmpeq_epi8(block, firsts[idx]), _mm_cmpeq_epi8(blockLast, lasts[idx]));
+
+            masks[idx] = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+            candidates |= masks[idx];
+        }
+
+        // Offsets from left to right, and at each one the literals from the longest.
+        for (; candidates != 0; candidates &= candidates - 1)
+        {
+            auto bit = std::countr_zero(candidates);
+            auto offset = from + bit;
+
+            for (size_t idx = 0; idx < packed_.size(); ++idx)
+            {
+                auto& literal = packed_[idx];
+
+                if ((masks[idx] >> bit & 1) == 0)
+                    continue;
+
+                if (std::memcmp(str.data() + offset, literal.data(), literal.size()) == 0)
+                    return Match{offset, literal.size()};
+            }
+        }
+    }
+#endif
+
+    return std::nullopt;
+}
\ No newline at end of file
@@ -1,14 +1,46 @@
 #include "Ast.h"
 #include "NFA.h"
 
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+
 using namespace Regex;
 
+namespace
+{
+size_t SaturatingAdd(size_t lhs, size_t rhs) noexcept
+{
+    return lhs > SIZE_MAX - rhs ? SIZE_MAX : lhs + rhs;
+}
+
+size_t SaturatingMultiply(size_t lhs, size_t rhs) noexcept
+{
+    return rhs != 0 && lhs > SIZE_MAX / rhs ? SIZE_MAX : lhs * rhs;
+}
+
+size_t SumOfExpandedSizes(const AstNode::AstNodeList& patterns) noexcept
+{
+    size_t result = 0;
+
+    for (const auto& pattern : patterns)
+        result = SaturatingAdd(result, pattern->ExpandedSize());
+
+    return result;
+}
+} // namespace
+
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA EmptyAst::ToNFA() const
+Fragment EmptyAst::BuildNFA(NFA& nfa) const
+{
+    auto state = nfa.AddState();
+    return { state, state };
+}
+
+Glushkov::Positions EmptyAst::BuildPositions(Glushkov& glushkov) const
 {
-    NFA nfa;
-    return nfa;
+    return glushkov.Empty();
 }
 
 std::string EmptyAst::ToString() const
@@ -21,6 +53,16 @@ size_t EmptyAst::Precedence() const noexcept
     return 3;
 }
 
+auto EmptyAst::Type() const noexcept -> AstType
+{
+    return AstType::Empty;
+}
+
+size_t EmptyAst::ExpandedSize() const noexcept
+{
+    return 1;
+}
+
 auto EmptyAst::Make() -> AstNodePtr
 {
     return std::make_shared<EmptyAst>();
@@ -28,13 +70,18 @@ auto EmptyAst::Make() -> AstNodePtr
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA SymbolAst::ToNFA() const
+Fragment SymbolAst::BuildNFA(NFA& nfa) const
 {
-    NFA nfa(2);
-    nfa.ResetFinalStates({ 1 });
-    nfa.AddTransition(0, symbol_, 1);
+    auto start = nfa.AddState();
+    auto end = nfa.AddState();
+    nfa.AddTransition(start, CharClass::Single(symbol_), end);
 
-    return nfa;
+    return { start, end };
+}
+
+Glushkov::Positions SymbolAst::BuildPositions(Glushkov& glushkov) const
+{
+    return glushkov.Symbol(symbol_);
 }
 
 std::string SymbolAst::ToString() const
@@ -47,6 +94,16 @@ size_t SymbolAst::Precedence() const noexcept
     return 3;
 }
 
+auto SymbolAst::Type() const noexcept -> AstType
+{
+    return AstType::Symbol;
+}
+
+size_t SymbolAst::ExpandedSize() const noexcept
+{
+    return 1;
+}
+
 auto SymbolAst::Make(char symbol) -> AstNodePtr
 {
     return std::make_shared<SymbolAst>(symbol);
@@ -54,26 +111,88 @@ auto SymbolAst::Make(char symbol) -> AstNodePtr
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA AlternationAst::ToNFA() const
+Fragment CharSetAst::BuildNFA(NFA& nfa) const
+{
+    auto start = nfa.AddState();
+    auto end = nfa.AddState();
+    nfa.AddTransition(start, symbols_, end);
+
+    return { start, end };
+}
+
+Glushkov::Positions CharSetAst::BuildPositions(Glushkov& glushkov) const
+{
+    return glushkov.Class(symbols_);
+}
+
+std::string CharSetAst::ToString() const
+{
+    return CharClass::ToString(symbols_);
+}
+
+size_t CharSetAst::Precedence() const noexcept
+{
+    return 3;
+}
+
+auto CharSetAst::Type() const noexcept -> AstType
+{
+    return AstType::CharSet;
+}
+
+size_t CharSetAst::ExpandedSize() const noexcept
+{
+    return 1;
+}
+
+auto CharSetAst::Make(const CharSet& symbols) -> AstNodePtr
+{
+    return std::make_shared<CharSetAst>(symbols);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+Fragment AlternationAst::BuildNFA(NFA& nfa) const
 {
-    auto nfa = patternX_->ToNFA();
-    auto startX = 1;
-    auto startY = nfa.Size() + 1;
+    auto start = nfa.AddState();
+    std::vector<Fragment> fragments;
+    fragments.reserve(patterns_.size());
+
+    for (const auto& pattern : patterns_)
+        fragments.push_back(pattern->BuildNFA(nfa));
+
+    auto end = nfa.AddState();
+
+    for (const auto& fragment : fragments)
+    {
+        nfa.AddEpsilonTransition(start, fragment.start);
+        nfa.AddEpsilonTransition(fragment.end, end);
+    }
+
+    return { start, end };
+}
 
-    nfa.PushFront();
-    nfa.AddStartStateTransition(NFA::kEpsilon, startX);
+Glushkov::Positions AlternationAst::BuildPositions(Glushkov& glushkov) const
+{
+    auto result = patterns_.front()->BuildPositions(glushkov);
 
-    nfa.Merge(patternY_->ToNFA());
-    nfa.AddStartStateTransition(NFA::kEpsilon, startY);
+    for (size_t i = 1; i < patterns_.size(); ++i)
+        result = glushkov.Alternation(std::move(result), patterns_[i]->BuildPositions(glushkov));
 
-    return nfa;
+    return result;
 }
 
 std::string AlternationAst::ToString() const
 {
-    auto result = patternX_->Brackets(Precedence());
-    result += '|';
-    result += patternY_->Brackets(Precedence());
+    std::string result;
+
+    for (size_t i = 0; i < patterns_.size(); ++i)
+    {
+        if (i > 0)
+            result += '|';
+
+        result += patterns_[i]->Brackets(Precedence());
+    }
 
     return result;
 }
@@ -83,36 +202,59 @@ size_t AlternationAst::Precedence() const noexcept
     return 0;
 }
 
+auto AlternationAst::Type() const noexcept -> AstType
+{
+    return AstType::Alternation;
+}
+
+size_t AlternationAst::ExpandedSize() const noexcept
+{
+    return SumOfExpandedSizes(patterns_);
+}
+
 auto AlternationAst::Make(AstNodePtr lhs, AstNodePtr rhs) -> AstNodePtr
 {
     return std::make_shared<AlternationAst>(lhs, rhs);
 }
 
-// ---------------------------------------------------------------------------------------------------------------------
-
-NFA ConcatenationAst::ToNFA() const
+auto AlternationAst::Make(AstNodeList patterns) -> AstNodePtr
 {
-    auto nfaX = patternX_->ToNFA();
-    auto nfaY = patternY_->ToNFA();
+    assert(!patterns.empty());
+    return std::make_shared<AlternationAst>(std::move(patterns));
+}
 
-    auto startY = nfaX.Size();
-    auto oldFinalStates = nfaX.FinalStates();
+// ---------------------------------------------------------------------------------------------------------------------
 
-    nfaX.ResetFinalStates();
-    nfaX.Merge(std::move(nfaY));
+Fragment ConcatenationAst::BuildNFA(NFA& nfa) const
+{
+    auto result = patterns_.front()->BuildNFA(nfa);
 
-    for (auto& state : oldFinalStates)
+    for (size_t i = 1; i < patterns_.size(); ++i)
     {
-        state->AddTransition({}, nfaX.At(startY));
+        auto fragment = patterns_[i]->BuildNFA(nfa);
+        nfa.AddEpsilonTransition(result.end, fragment.start);
+        result.end = fragment.end;
     }
 
-    return nfaX;
+    return result;
+}
+
+Glushkov::Positions ConcatenationAst::BuildPositions(Glushkov& glushkov) const
+{
+    auto result = patterns_.front()->BuildPositions(glushkov);
+
+    for (size_t i = 1; i < patterns_.size(); ++i)
+        result = glushkov.Concatenation(std::move(result), patterns_[i]->BuildPositions(glushkov));
+
+    return result;
 }
 
 std::string ConcatenationAst::ToString() const
 {
-    auto result = patternX_->Brackets(Precedence());
-    result += patternY_->Brackets(Precedence());
+    std::string result;
+
+    for (const auto& pattern : patterns_)
+        result += pattern->Brackets(Precedence());
 
     return result;
 }
@@ -122,27 +264,48 @@ size_t ConcatenationAst::Precedence() const noexcept
     return 1;
 }
 
+auto ConcatenationAst::Type() const noexcept -> AstType
+{
+    return AstType::Concatenation;
+}
+
+size_t ConcatenationAst::ExpandedSize() const noexcept
+{
+    return SumOfExpandedSizes(patterns_);
+}
+
 auto ConcatenationAst::Make(AstNodePtr lhs, AstNodePtr rhs) -> AstNodePtr
 {
     return std::make_shared<ConcatenationAst>(lhs, rhs);
 }
 
+auto ConcatenationAst::Make(AstNodeList patterns) -> AstNodePtr
+{
+    assert(!patterns.empty());
+    return std::make_shared<ConcatenationAst>(std::move(patterns));
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA RepetitionAst::ToNFA() const
+// Closures and options get an entry and an exit of their own. An exit shared with the body would let an epsilon edge
+// that skips the body, such as the one of (ba+)?, land on a state that loops back into it.
+Fragment RepetitionAst::BuildNFA(NFA& nfa) const
 {
-    auto nfa = pattern_->ToNFA();
+    auto start = nfa.AddState();
+    auto fragment = pattern_->BuildNFA(nfa);
+    auto end = nfa.AddState();
 
-    nfa.PushFront();
-    nfa[0].AddTransition({}, nfa.At(1));
-    nfa.AddFinalStates({ 0 });
+    nfa.AddEpsilonTransition(start, fragment.start);
+    nfa.AddEpsilonTransition(start, end);
+    nfa.AddEpsilonTransition(fragment.end, fragment.start);
+    nfa.AddEpsilonTransition(fragment.end, end);
 
-    for (auto& state : nfa.FinalStates())
-    {
-        state->AddTransition({}, nfa.At(1));
-    }
+    return { start, end };
+}
 
-    return nfa;
+Glushkov::Positions RepetitionAst::BuildPositions(Glushkov& glushkov) const
+{
+    return glushkov.Repetition(pattern_->BuildPositions(glushkov));
 }
 
 std::string RepetitionAst::ToString() const
@@ -155,6 +318,16 @@ size_t RepetitionAst::Precedence() const noexcept
     return 2;
 }
 
+auto RepetitionAst::Type() const noexcept -> AstType
+{
+    return AstType::Repetition;
+}
+
+size_t RepetitionAst::ExpandedSize() const noexcept
+{
+    return pattern_->ExpandedSize();
+}
+
 auto RepetitionAst::Make(AstNodePtr pattern) -> AstNodePtr
 {
     return std::make_shared<RepetitionAst>(pattern);
@@ -162,19 +335,22 @@ auto RepetitionAst::Make(AstNodePtr pattern) -> AstNodePtr
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA OneOrMoreAst::ToNFA() const
+Fragment OneOrMoreAst::BuildNFA(NFA& nfa) const
 {
-    auto nfa = pattern_->ToNFA();
+    auto start = nfa.AddState();
+    auto fragment = pattern_->BuildNFA(nfa);
+    auto end = nfa.AddState();
 
-    nfa.PushFront();
-    nfa[0].AddTransition({}, nfa.At(1));
+    nfa.AddEpsilonTransition(start, fragment.start);
+    nfa.AddEpsilonTransition(fragment.end, fragment.start);
+    nfa.AddEpsilonTransition(fragment.end, end);
 
-    for (auto& state : nfa.FinalStates())
-    {
-        state->AddTransition({}, nfa.At(1));
-    }
+    return { start, end };
+}
 
-    return nfa;
+Glushkov::Positions OneOrMoreAst::BuildPositions(Glushkov& glushkov) const
+{
+    return glushkov.OneOrMore(pattern_->BuildPositions(glushkov));
 }
 
 std::string OneOrMoreAst::ToString() const
@@ -187,6 +363,16 @@ size_t OneOrMoreAst::Precedence() const noexcept
     return 2;
 }
 
+auto OneOrMoreAst::Type() const noexcept -> AstType
+{
+    return AstType::OneOrMore;
+}
+
+size_t OneOrMoreAst::ExpandedSize() const noexcept
+{
+    return pattern_->ExpandedSize();
+}
+
 auto OneOrMoreAst::Make(AstNodePtr pattern) -> AstNodePtr
 {
     return std::make_shared<OneOrMoreAst>(pattern);
@@ -194,18 +380,22 @@ auto OneOrMoreAst::Make(AstNodePtr pattern) -> AstNodePtr
 
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA OptionalAst::ToNFA() const
+Fragment OptionalAst::BuildNFA(NFA& nfa) const
 {
-    auto nfa = pattern_->ToNFA();
-    nfa.PushFront();
-    nfa[0].AddTransition({}, nfa.At(1));
+    auto start = nfa.AddState();
+    auto fragment = pattern_->BuildNFA(nfa);
+    auto end = nfa.AddState();
 
-    for (auto& state : nfa.FinalStates())
-    {
-        nfa[0].AddTransition(0, state);
-    }
+    nfa.AddEpsilonTransition(start, fragment.start);
+    nfa.AddEpsilonTransition(start, end);
+    nfa.AddEpsilonTransition(fragment.end, end);
+
+    return { start, end };
+}
 
-    return nfa;
+Glushkov::Positions OptionalAst::BuildPositions(Glushkov& glushkov) const
+{
+    return glushkov.Optional(pattern_->BuildPositions(glushkov));
 }
 
 std::string OptionalAst::ToString() const
@@ -218,7 +408,162 @@ size_t OptionalAst::Precedence() const noexcept
     return 2;
 }
 
+auto OptionalAst::Type() const noexcept -> AstType
+{
+    return AstType::Optional;
+}
+
+size_t OptionalAst::ExpandedSize() const noexcept
+{
+    return pattern_->ExpandedSize();
+}
+
 auto OptionalAst::Make(AstNodePtr pattern) -> AstNodePtr
 {
     return std::make_shared<OptionalAst>(pattern);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// The optional copies of x{m,n} share one exit: x^m followed by (x(x(x)?)?)? is built with an epsilon edge from the
+// entry of each optional copy straight to the common end, so the automaton grows linearly with n.
+Fragment CountedRepetitionAst::BuildNFA(NFA& nfa) const
+{
+    auto start = nfa.AddState();
+    auto current = start;
+
+    for (size_t i = 0; i < minCount_; ++i)
+    {
+        auto fragment = pattern_->BuildNFA(nfa);
+        nfa.AddEpsilonTransition(current, fragment.start);
+        current = fragment.end;
+    }
+
+    if (IsUnbounded())
+    {
+        auto loop = nfa.AddState();
+        auto fragment = pattern_->BuildNFA(nfa);
+        auto end = nfa.AddState();
+
+        nfa.AddEpsilonTransition(current, loop);
+        nfa.AddEpsilonTransition(loop, fragment.start);
+        nfa.AddEpsilonTransition(loop, end);
+        nfa.AddEpsilonTransition(fragment.end, loop);
+
+        return { start, end };
+    }
+
+    auto end = nfa.AddState();
+    nfa.AddEpsilonTransition(current, end);
+
+    for (size_t i = minCount_; i < maxCount_; ++i)
+    {
+        auto fragment = pattern_->BuildNFA(nfa);
+        nfa.AddEpsilonTransition(current, fragment.start);
+        nfa.AddEpsilonTransition(fragment.end, end);
+        current = fragment.end;
+    }
+
+    return { start, end };
+}
+
+Glushkov::Positions CountedRepetitionAst::BuildPositions(Glushkov& glushkov) const
+{
+    auto result = glushkov.Empty();
+
+    for (size_t i = 0; i < minCount_; ++i)
+        result = glushkov.Concatenation(std::move(result), pattern_->BuildPositions(glushkov));
+
+    if (IsUnbounded())
+        return glushkov.Concatenation(std::move(result), glushkov.Repetition(pattern_->BuildPositions(glushkov)));
+
+    std::vector<Glushkov::Positions> copies;
+
+    for (size_t i = minCount_; i < maxCount_; ++i)
+        copies.push_back(pattern_->BuildPositions(glushkov));
+
+    if (copies.empty())
+        return result;
+
+    // Nests the optional copies from the right, (x(x(x)?)?)?, so every copy follows from the same last positions.
+    auto suffix = glushkov.Optional(std::move(copies.back()));
+
+    for (size_t i = copies.size() - 1; i-- > 0;)
+        suffix = glushkov.Optional(glushkov.Concatenation(std::move(copies[i]), std::move(suffix)));
+
+    return glushkov.Concatenation(std::move(result), std::move(suffix));
+}
+
+std::string CountedRepetitionAst::ToString() const
+{
+    auto result = pattern_->Brackets(Precedence() + 1);
+
+    if (IsUnbounded())
+        return result + std::format("{{{},}}", minCount_);
+
+    if (minCount_ == maxCount_)
+        return result + std::format("{{{}}}", minCount_);
+
+    return result + std::format("{{{},{}}}", minCount_, maxCount_);
+}
+
+size_t CountedRepetitionAst::Precedence() const noexcept
+{
+    return 2;
+}
+
+auto CountedRepetitionAst::Type() const noexcept -> AstType
+{
+    return AstType::CountedRepetition;
+}
+
+size_t CountedRepetitionAst::ExpandedSize() const noexcept
+{
+    // {m,} is counted as the Scanner counts it, the closure of one more copy it ends with is not charged.
+    auto copies = IsUnbounded() ? std::max<size_t>(minCount_, 1) : maxCount_;
+    return SaturatingMultiply(pattern_->ExpandedSize(), copies);
+}
+
+auto CountedRepetitionAst::Make(AstNodePtr pattern, size_t minCount, size_t maxCount) -> AstNodePtr
+{
+    assert(minCount <= maxCount);
+    return std::make_shared<CountedRepetitionAst>(pattern, minCount, maxCount);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+Fragment CaptureAst::BuildNFA(NFA& nfa) const
+{
+    return pattern_->BuildNFA(nfa);
+}
+
+Glushkov::Positions CaptureAst::BuildPositions(Glushkov& glushkov) const
+{
+    return pattern_->BuildPositions(glushkov);
+}
+
+std::string CaptureAst::ToString() const
+{
+    return std::format("({})", pattern_->ToString());
+}
+
+size_t CaptureAst::Precedence() const noexcept
+{
+    return 3;
+}
+
+auto CaptureAst::Type() const noexcept -> AstType
+{
+    return AstType::Capture;
+}
+
+size_t CaptureAst::ExpandedSize() const noexcept
+{
+    return pattern_->ExpandedSize();
+}
+
+auto CaptureAst::Make(AstNodePtr pattern, size_t group) -> AstNodePtr
+{
+    assert(group > 0);
+    return std::make_shared<CaptureAst>(pattern, group);
 }
\ No newline at end of file
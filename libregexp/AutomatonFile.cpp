@@ -0,0 +1,487 @@
+#include "AutomatonFile.h"
+#include "MappedFile.h"
+
+#include <array>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <stdexcept>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr char kMagic[8] = "NNREGEX";
+constexpr uint32_t kByteOrderMark = 0x01020304;
+
+struct FileHeader
+{
+    char magic[8] = {};
+    uint32_t version = 0;
+    uint32_t byteOrderMark = 0;
+    uint32_t kind = 0;
+    uint32_t patternBytes = 0;
+    uint64_t checksum = 0;
+};
+
+struct DfaHeader
+{
+    uint32_t stateCount = 0;
+    uint32_t classCount = 0;
+    uint32_t start = 0;
+    uint32_t firstFinal = 0;
+    uint32_t tagCount = 0;
+    uint32_t reserved = 0;
+};
+
+struct PrefilterHeader
+{
+    uint32_t kind = 0;
+    uint32_t prefixSize = 0;
+};
+
+struct ProgramHeader
+{
+    uint32_t instructionCount = 0;
+    uint32_t charSetCount = 0;
+    uint32_t start = 0;
+    uint32_t groupCount = 0;
+};
+
+// Op code, next and argument of an instruction.
+constexpr size_t kInstructionWords = 3;
+
+// A character set is stored as its 256 bits, the lowest byte values first.
+using CharSetWords = std::array<uint64_t, 4>;
+
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(DfaHeader) % 8 == 0);
+static_assert(sizeof(PrefilterHeader) % 8 == 0 && sizeof(ProgramHeader) % 8 == 0);
+
+uint64_t Checksum(std::string_view bytes)
+{
+    uint64_t hash = 0xcbf29ce484222325;
+
+    for (auto ch : bytes)
+    {
+        hash ^= static_cast<uint8_t>(ch);
+        hash *= 0x100000001b3;
+    }
+
+    return hash;
+}
+
+template <typename T>
+void Append(std::string& bytes, const T& value)
+{
+    bytes.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void Append(std::string& bytes, std::span<const T> values)
+{
+    bytes.append(reinterpret_cast<const char*>(values.data()), values.size_bytes());
+}
+
+void Pad(std::string& bytes)
+{
+    bytes.resize((bytes.size() + 7) / 8 * 8, '\0');
+}
+
+CharSetWords ToWords(const CharSet& set)
+{
+    CharSetWords words = {};
+
+    for (size_t byte = 0; byte < set.size(); ++byte)
+    {
+        if (set[byte])
+            words[byte / 64] |= uint64_t{1} << (byte % 64);
+    }
+
+    return words;
+}
+
+CharSet FromWords(std::span<const uint64_t> words)
+{
+    CharSet set;
+
+    for (size_t byte = 0; byte < set.size(); ++byte)
+        set[byte] = (words[byte / 64] >> (byte % 64) & 1) != 0;
+
+    return set;
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+// Reads the file front to back, every read is checked against the end of the file.
+class AutomatonFile::Reader
+{
+    const std::string& path_;
+    std::shared_ptr<const MappedFile> file_;
+    std::string_view bytes_;
+    size_t pos_ = 0;
+
+public:
+    Reader(const std::string& path, std::shared_ptr<const MappedFile> file)
+        : path_(path)
+        , file_(std::move(file))
+        , bytes_(file_->View())
+    {}
+
+    template <typename T>
+    T Read()
+    {
+        T value;
+        std::memcpy(&value, Take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    template <typename T>
+    std::span<const T> View(size_t count)
+    {
+        if (count > bytes_.size() / sizeof(T))
+            Fail("is truncated");
+
+        auto bytes = Take(count * sizeof(T));
+        return {reinterpret_cast<const T*>(bytes.data()), count};
+    }
+
+    std::string_view Take(size_t size)
+    {
+        if (size > bytes_.size() - pos_)
+            Fail("is truncated");
+
+        auto result = bytes_.substr(pos_, size);
+        pos_ += size;
+        return result;
+    }
+
+    size_t Position() const noexcept
+    {
+        return pos_;
+    }
+
+    void Align()
+    {
+        Take((8 - pos_ % 8) % 8);
+    }
+
+    [[noreturn]] void Fail(std::string_view reason) const
+    {
+        throw std::runtime_error(std::format("Error: Automaton file '{}' {}.", path_, reason));
+    }
+
+    const std::shared_ptr<const MappedFile>& File() const noexcept
+    {
+        return file_;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void AutomatonFile::Write(const std::string& path, Kind kind, const std::vector<std::string>& patterns,
+    const FullDFA& dfa, const Search* search)
+{
+    std::string bytes(sizeof(FileHeader), '\0');
+
+    Append(bytes, static_cast<uint32_t>(patterns.size()));
+
+    for (auto& pattern : patterns)
+    {
+        Append(bytes, static_cast<uint32_t>(pattern.size()));
+        bytes += pattern;
+    }
+
+    Pad(bytes);
+
+    auto patternBytes = bytes.size() - sizeof(FileHeader);
+
+    if ((kind == Kind::RegExp) != (search != nullptr))
+        throw std::logic_error("Error: Only RegExp files hold the automata of the unanchored search.");
+
+    if (search != nullptr)
+        AppendSearch(bytes, *search);
+
+    AppendDfa(bytes, dfa);
+
+    FileHeader header;
+    std::memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.byteOrderMark = kByteOrderMark;
+    header.kind = static_cast<uint32_t>(kind);
+    header.patternBytes = static_cast<uint32_t>(patternBytes);
+    header.checksum = Checksum(std::string_view(bytes).substr(sizeof(FileHeader)));
+
+    std::memcpy(bytes.data(), &header, sizeof(header));
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    file.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+
+    if (!file)
+        throw std::runtime_error(std::format("Error: Cannot write file '{}'.", path));
+}
+
+auto AutomatonFile::Read(const std::string& path, Kind kind, Verify verify) -> Contents
+{
+    auto file = std::make_shared<const MappedFile>(path);
+    Reader reader(path, file);
+
+    auto header = reader.Read<FileHeader>();
+
+    if (std::memcmp(header.magic, kMagic, sizeof(kMagic)) != 0)
+        reader.Fail("is not an automaton file");
+
+    if (header.version != kVersion || header.byteOrderMark != kByteOrderMark)
+        reader.Fail(std::format("has format version {}, expected {} in native byte order", header.version, kVersion));
+
+    if (header.kind != static_cast<uint32_t>(kind))
+        reader.Fail("holds another kind of automaton");
+
+    if (header.patternBytes % 8 != 0 || header.patternBytes > file->View().size() - sizeof(FileHeader))
+        reader.Fail("has an invalid pattern section size");
+
+    if (verify == Verify::Checksum && Checksum(file->View().substr(sizeof(FileHeader))) != header.checksum)
+        reader.Fail("is corrupted, the checksum does not match");
+
+    Contents result;
+    auto patternCount = reader.Read<uint32_t>();
+
+    for (uint32_t idx = 0; idx < patternCount; ++idx)
+    {
+        auto size = reader.Read<uint32_t>();
+        result.patterns.emplace_back(reader.Take(size));
+    }
+
+    reader.Align();
+
+    if (reader.Position() != sizeof(FileHeader) + header.patternBytes)
+        reader.Fail("has an invalid pattern section size");
+
+    if (kind == Kind::RegExp)
+        result.search = ReadSearch(reader);
+
+    result.dfa = ReadDfa(reader, result.patterns.size());
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void AutomatonFile::AppendDfa(std::string& bytes, const FullDFA& dfa)
+{
+    DfaHeader dfaHeader;
+    dfaHeader.stateCount = static_cast<uint32_t>(dfa.StateCount());
+    dfaHeader.classCount = static_cast<uint32_t>(dfa.stride_);
+    dfaHeader.start = dfa.start_;
+    dfaHeader.firstFinal = dfa.firstFinal_;
+    dfaHeader.tagCount = static_cast<uint32_t>(dfa.tags_.size());
+
+    Append(bytes, dfaHeader);
+    Append(bytes, std::span<const uint8_t>(dfa.byteClasses_.Table()));
+    Append(bytes, dfa.table_);
+    Append(bytes, dfa.tagOffsets_);
+    Append(bytes, dfa.tags_);
+    Pad(bytes);
+}
+
+void AutomatonFile::AppendSearch(std::string& bytes, const Search& search)
+{
+    AppendDfa(bytes, search.leftmostDfa);
+    AppendDfa(bytes, search.reverseDfa);
+    AppendDfa(bytes, search.prefixDfa);
+
+    auto& prefilter = search.prefilter;
+
+    PrefilterHeader prefilterHeader;
+    prefilterHeader.kind = static_cast<uint32_t>(prefilter.kind_);
+    prefilterHeader.prefixSize = static_cast<uint32_t>(prefilter.prefix_.size());
+
+    Append(bytes, prefilterHeader);
+    Append(bytes, ToWords(prefilter.firstBytes_));
+    bytes += prefilter.prefix_;
+    Pad(bytes);
+
+    ProgramHeader programHeader;
+
+    if (search.captures.has_value())
+    {
+        auto& program = *search.captures;
+
+        programHeader.instructionCount = static_cast<uint32_t>(program.Size());
+        programHeader.charSetCount = static_cast<uint32_t>(program.CharSets().size());
+        programHeader.start = program.Start();
+        programHeader.groupCount = static_cast<uint32_t>(program.GroupCount());
+    }
+
+    Append(bytes, programHeader);
+
+    if (!search.captures.has_value())
+        return;
+
+    for (auto& instruction : search.captures->instructions_)
+    {
+        Append(bytes, static_cast<uint32_t>(instruction.opCode));
+        Append(bytes, instruction.next);
+        Append(bytes, instruction.arg);
+    }
+
+    Pad(bytes);
+
+    for (auto& charSet : search.captures->charSets_)
+        Append(bytes, ToWords(charSet));
+}
+
+FullDFA AutomatonFile::ReadDfa(Reader& reader, size_t tagCount)
+{
+    auto dfaHeader = reader.Read<DfaHeader>();
+    auto classes = reader.View<uint8_t>(256);
+    auto byteClasses = ByteClasses::FromTable(classes.first<256>());
+
+    if (!byteClasses.has_value() || byteClasses->Count() != dfaHeader.classCount || dfaHeader.stateCount == 0)
+        reader.Fail("has an invalid DFA header");
+
+    FullDFA dfa;
+
+    dfa.byteClasses_ = *byteClasses;
+    dfa.stride_ = dfaHeader.classCount;
+    dfa.start_ = dfaHeader.start;
+    dfa.firstFinal_ = dfaHeader.firstFinal;
+    dfa.table_ = reader.View<FullDFA::StateId>(size_t{dfaHeader.stateCount} * dfaHeader.classCount);
+    dfa.tagOffsets_ = reader.View<uint32_t>(size_t{dfaHeader.stateCount} + 1);
+    dfa.tags_ = reader.View<uint32_t>(dfaHeader.tagCount);
+    dfa.storage_ = reader.File();
+
+    reader.Align();
+
+    // The checksum, if compared at all, only guards against damage. The tables are checked so that no search can leave
+    // them.
+    if (dfa.start_ >= dfaHeader.stateCount || dfa.firstFinal_ > dfaHeader.stateCount)
+        reader.Fail("has an invalid DFA header");
+
+    for (auto target : dfa.table_)
+    {
+        if (target >= dfaHeader.stateCount)
+            reader.Fail("has an invalid transition table");
+    }
+
+    for (size_t idx = 0; idx < dfaHeader.stateCount; ++idx)
+    {
+        if (dfa.tagOffsets_[idx] > dfa.tagOffsets_[idx + 1] || dfa.tagOffsets_[idx + 1] > dfa.tags_.size())
+            reader.Fail("has invalid tags");
+    }
+
+    for (auto tag : dfa.tags_)
+    {
+        if (tag >= tagCount)
+            reader.Fail("has invalid tags");
+    }
+
+    dfa.stats_.minimizedStates = dfa.StateCount();
+    dfa.stats_.tableBytes = dfa.table_.size_bytes() + dfa.tagOffsets_.size_bytes() + dfa.tags_.size_bytes();
+
+    return dfa;
+}
+
+auto AutomatonFile::ReadSearch(Reader& reader) -> Search
+{
+    // The DFAs of the search all have the single tag 0.
+    Search search = { ReadDfa(reader, 1), ReadDfa(reader, 1), ReadDfa(reader, 1) };
+
+    auto& prefilter = search.prefilter;
+    auto prefilterHeader = reader.Read<PrefilterHeader>();
+
+    prefilter.firstBytes_ = FromWords(reader.View<uint64_t>(std::tuple_size_v<CharSetWords>));
+    prefilter.prefix_ = reader.Take(prefilterHeader.prefixSize);
+    reader.Align();
+
+    auto byteCount = prefilter.firstBytes_.count();
+
+    switch (static_cast<Prefilter::Kind>(prefilterHeader.kind))
+    {
+        case Prefilter::Kind::None:
+        case Prefilter::Kind::ByteSet:
+            break;
+        case Prefilter::Kind::Literal:
+            if (prefilter.prefix_.size() < 2)
+                reader.Fail("has an invalid prefilter");
+            break;
+        case Prefilter::Kind::FewBytes:
+            if (byteCount == 0 || byteCount > Prefilter::kMaxFewBytes)
+                reader.Fail("has an invalid prefilter");
+
+            for (size_t byte = 0; byte < prefilter.firstBytes_.size(); ++byte)
+            {
+                if (prefilter.firstBytes_[byte])
+                    prefilter.bytes_.push_back(static_cast<char>(byte));
+            }
+            break;
+        default:
+            reader.Fail("has an invalid prefilter");
+    }
+
+    prefilter.kind_ = static_cast<Prefilter::Kind>(prefilterHeader.kind);
+
+    // A pattern without groups has no capture program.
+    auto programHeader = reader.Read<ProgramHeader>();
+
+    if (programHeader.instructionCount == 0)
+    {
+        if (programHeader.groupCount != 0 || programHeader.charSetCount != 0)
+            reader.Fail("has an invalid capture program");
+
+        return search;
+    }
+
+    auto words = reader.View<uint32_t>(size_t{programHeader.instructionCount} * kInstructionWords);
+    reader.Align();
+    auto charSetWords = reader.View<uint64_t>(size_t{programHeader.charSetCount} * std::tuple_size_v<CharSetWords>);
+
+    // Every group saves its two slots, so a valid program has more instructions than groups.
+    CaptureProgram program;
+
+    program.start_ = programHeader.start;
+    program.groupCount_ = programHeader.groupCount;
+
+    if (program.start_ >= programHeader.instructionCount || program.groupCount_ >= programHeader.instructionCount)
+        reader.Fail("has an invalid capture program");
+
+    for (size_t idx = 0; idx < words.size(); idx += kInstructionWords)
+    {
+        CaptureProgram::Instruction instruction;
+        instruction.opCode = static_cast<CaptureProgram::OpCode>(words[idx]);
+        instruction.next = words[idx + 1];
+        instruction.arg = words[idx + 2];
+
+        // The instructions only lead to instructions, character sets and slots that are there.
+        bool isValid = words[idx] <= static_cast<uint32_t>(CaptureProgram::OpCode::Match)
+            && instruction.next < programHeader.instructionCount;
+
+        switch (instruction.opCode)
+        {
+            case CaptureProgram::OpCode::Byte:
+                isValid = isValid && instruction.arg < programHeader.charSetCount;
+                break;
+            case CaptureProgram::OpCode::Split:
+                isValid = isValid && instruction.arg < programHeader.instructionCount;
+                break;
+            case CaptureProgram::OpCode::Save:
+                isValid = isValid && instruction.arg < program.SlotCount();
+                break;
+            default:
+                break;
+        }
+
+        if (!isValid)
+            reader.Fail("has an invalid capture program");
+
+        program.instructions_.push_back(instruction);
+    }
+
+    for (size_t idx = 0; idx < charSetWords.size(); idx += std::tuple_size_v<CharSetWords>)
+        program.charSets_.push_back(FromWords(charSetWords.subspan(idx, std::tuple_size_v<CharSetWords>)));
+
+    search.captures = std::move(program);
+    return search;
+}
\ No newline at end of file
@@ -0,0 +1,65 @@
+#include "ByteClasses.h"
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void ByteClasses::Add(const CharSet& set)
+{
+    // New ids are given in the order of the smallest byte of every class, the old class and the membership in the
+    // set together identify the new class.
+    constexpr static int kUnassigned = -1;
+
+    std::array<std::array<int, 2>, 256> renumbering;
+
+    for (auto& ids : renumbering)
+        ids = { kUnassigned, kUnassigned };
+
+    size_t count = 0;
+
+    for (size_t byte = 0; byte < classes_.size(); ++byte)
+    {
+        auto& id = renumbering[classes_[byte]][set[byte] ? 1 : 0];
+
+        if (id == kUnassigned)
+        {
+            id = static_cast<int>(count);
+            representatives_[count++] = static_cast<uint8_t>(byte);
+        }
+
+        classes_[byte] = static_cast<uint8_t>(id);
+    }
+
+    count_ = count;
+}
+
+ByteClasses ByteClasses::FromSets(std::span<const CharSet> sets)
+{
+    ByteClasses result;
+
+    for (auto& set : sets)
+        result.Add(set);
+
+    return result;
+}
+
+std::optional<ByteClasses> ByteClasses::FromTable(std::span<const uint8_t, 256> classes)
+{
+    ByteClasses result;
+    result.count_ = 0;
+
+    for (size_t byte = 0; byte < classes.size(); ++byte)
+    {
+        auto cls = classes[byte];
+
+        if (cls > result.count_)
+            return std::nullopt;
+
+        if (cls == result.count_)
+            result.representatives_[result.count_++] = static_cast<uint8_t>(byte);
+
+        result.classes_[byte] = cls;
+    }
+
+    return result;
+}
\ No newline at end of file
@@ -0,0 +1,145 @@
+#include "CharSet.h"
+
+#include <format>
+#include <string_view>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+std::string EscapeInClass(unsigned char ch)
+{
+    constexpr static std::string_view kSpecial = "]\\^-[";
+
+    switch (ch)
+    {
+        case '\n':
+            return R"(\n)";
+        case '\r':
+            return R"(\r)";
+        case '\t':
+            return R"(\t)";
+        case '\f':
+            return R"(\f)";
+        case '\v':
+            return R"(\v)";
+        default:
+            break;
+    }
+
+    if (kSpecial.find(static_cast<char>(ch)) != std::string_view::npos)
+        return std::format("\\{}", static_cast<char>(ch));
+
+    if (ch < 0x20 || ch >= 0x7f)
+        return std::format("\\x{:02x}", ch);
+
+    return { static_cast<char>(ch) };
+}
+
+std::string ClassItems(const CharSet& set)
+{
+    std::string result;
+
+    for (size_t from = 0; from < set.size(); ++from)
+    {
+        if (!set[from])
+            continue;
+
+        auto to = from;
+
+        while (to + 1 < set.size() && set[to + 1])
+            ++to;
+
+        result += EscapeInClass(static_cast<unsigned char>(from));
+
+        if (to > from + 1)
+            result += '-';
+
+        if (to > from)
+            result += EscapeInClass(static_cast<unsigned char>(to));
+
+        from = to;
+    }
+
+    return result;
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CharSet CharClass::Single(char ch)
+{
+    CharSet result;
+    result.set(static_cast<unsigned char>(ch));
+
+    return result;
+}
+
+CharSet CharClass::Range(char from, char to)
+{
+    CharSet result;
+
+    for (auto ch = static_cast<unsigned char>(from); ch <= static_cast<unsigned char>(to); ++ch)
+    {
+        result.set(ch);
+
+        if (ch == 0xff)
+            break;
+    }
+
+    return result;
+}
+
+CharSet CharClass::Digits()
+{
+    return Range('0', '9');
+}
+
+CharSet CharClass::Word()
+{
+    return Range('A', 'Z') | Range('a', 'z') | Digits() | Single('_');
+}
+
+CharSet CharClass::Whitespace()
+{
+    return Single(' ') | Single('\n') | Single('\r') | Single('\t') | Single('\f') | Single('\v');
+}
+
+CharSet CharClass::AnyButNewline()
+{
+    return ~Single('\n');
+}
+
+std::optional<CharSet> CharClass::FromEscape(char ch)
+{
+    switch (ch)
+    {
+        case 'd':
+            return Digits();
+        case 'D':
+            return ~Digits();
+        case 'w':
+            return Word();
+        case 'W':
+            return ~Word();
+        case 's':
+            return Whitespace();
+        case 'S':
+            return ~Whitespace();
+        default:
+            return std::nullopt;
+    }
+}
+
+std::string CharClass::ToString(const CharSet& set)
+{
+    if (set == AnyButNewline())
+        return ".";
+
+    if (set.count() > set.size() / 2)
+        return std::format("[^{}]", ClassItems(~set));
+
+    return std::format("[{}]", ClassItems(set));
+}
\ No newline at end of file
@@ -0,0 +1,304 @@
+#include "CodeGenerator.h"
+
+#include <algorithm>
+#include <format>
+#include <map>
+#include <stdexcept>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+const std::string kSeparator = "// " + std::string(117, '-') + "\n";
+
+bool IsIdentifier(std::string_view name)
+{
+    auto isStart = [](char ch)
+    {
+        return (ch >= 'A' && ch <= 'Z') || (ch >= 'a' && ch <= 'z') || ch == '_';
+    };
+
+    return !name.empty() && isStart(name.front()) && std::ranges::all_of(name, [&](char ch)
+    {
+        return isStart(ch) || (ch >= '0' && ch <= '9');
+    });
+}
+
+// Identifiers separated by ::, as names of namespaces and types are written.
+bool IsQualifiedName(std::string_view name)
+{
+    for (size_t pos = 0;;)
+    {
+        auto next = name.find("::", pos);
+
+        if (!IsIdentifier(name.substr(pos, next - pos)))
+            return false;
+
+        if (next == std::string_view::npos)
+            return true;
+
+        pos = next + 2;
+    }
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CodeGenerator::CodeGenerator(Options options)
+    : options_(std::move(options))
+{
+    if (!IsIdentifier(options_.name))
+        throw std::runtime_error(std::format("Error: '{}' is not a valid name for generated code.", options_.name));
+
+    for (const auto& name : { options_.nameSpace, options_.kindType })
+    {
+        if (!name.empty() && !IsQualifiedName(name))
+            throw std::runtime_error(std::format("Error: '{}' is not a valid namespace or type name.", name));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+std::string CodeGenerator::GenerateMatcher(const FullDFA& dfa) const
+{
+    Walk matches = {
+        .end = [&](StateId state) { return dfa.IsFinal(state) ? "return true;" : "return false;"; },
+        .dead = "return false;"
+    };
+
+    Walk longest = {
+        .accept = [](StateId) { return "result = idx;"; },
+        .end = [](StateId) { return "return result;"; },
+        .dead = "return result;"
+    };
+
+    std::string members;
+
+    members += "    // Whether the whole string matches.\n";
+    members += "    static bool Matches(std::string_view str) noexcept\n";
+    members += "    {\n";
+    members += "        size_t idx = 0;\n\n";
+    members += GenerateWalk(dfa, matches);
+    members += "    }\n\n";
+    members += "    // Length of the longest prefix of the string that matches, 0 if none does.\n";
+    members += "    static size_t LongestMatch(std::string_view str) noexcept\n";
+    members += "    {\n";
+    members += "        size_t result = 0;\n";
+    members += "        size_t idx = 0;\n\n";
+    members += GenerateWalk(dfa, longest);
+    members += "    }\n";
+
+    return Header(dfa, members);
+}
+
+std::string CodeGenerator::GenerateLexer(const FullDFA& dfa, const std::vector<std::string>& kinds) const
+{
+    auto kindType = options_.kindType.empty() ? std::string("Kind") : options_.kindType;
+    std::string members;
+
+    for (const auto& kind : kinds)
+    {
+        if (!IsIdentifier(kind))
+            throw std::runtime_error(std::format("Error: '{}' is not a valid name for a lexeme kind.", kind));
+    }
+
+    // Without an enum of its own the kinds are numbered by their first rule.
+    if (options_.kindType.empty())
+    {
+        std::vector<std::string> names;
+
+        for (const auto& kind : kinds)
+        {
+            if (std::ranges::find(names, kind) == names.end())
+                names.push_back(kind);
+        }
+
+        members += "    enum class Kind : uint32_t\n";
+        members += "    {\n";
+
+        for (size_t idx = 0; idx < names.size(); ++idx)
+            members += std::format("        {}{}\n", names[idx], idx + 1 < names.size() ? "," : "");
+
+        members += "    };\n\n";
+    }
+
+    Walk next = {
+        .accept = [&](StateId state)
+        {
+            auto kind = kinds.at(dfa.Tag(state));
+            return std::format("result = {{ static_cast<uint32_t>({}::{}), idx - pos }};", kindType, kind);
+        },
+        .end = [](StateId) { return "return result;"; },
+        .dead = "return result;",
+        .acceptAtStart = false
+    };
+
+    members += "    struct Lexeme\n";
+    members += "    {\n";
+    members += "        uint32_t kind = 0;\n";
+    members += "        size_t length = 0;\n";
+    members += "    };\n\n";
+    members += "    constexpr static uint32_t kNoMatch = UINT32_MAX;\n\n";
+    members += "    // Longest non-empty lexeme starting at the position, ties going to the rule listed first. If no\n";
+    members += "    // rule matches, the kind is kNoMatch and the length is 0.\n";
+    members += "    static Lexeme Next(std::string_view str, size_t pos = 0) noexcept\n";
+    members += "    {\n";
+    members += "        Lexeme result = { kNoMatch, 0 };\n";
+    members += "        size_t idx = pos;\n\n";
+    members += GenerateWalk(dfa, next);
+    members += "    }\n";
+
+    return Header(dfa, members);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+std::string CodeGenerator::Header(const FullDFA& dfa, const std::string& members) const
+{
+    std::string result;
+
+    result += std::format("// Generated by noname-regexgen from {}, do not edit.\n", options_.source);
+    result += "#pragma once\n";
+
+    for (const auto& include : options_.includes)
+        result += std::format("#include \"{}\"\n", include);
+
+    if (!options_.includes.empty())
+        result += "\n";
+
+    result += "#include <cstddef>\n";
+    result += "#include <cstdint>\n";
+    result += "#include <string_view>\n\n";
+
+    if (!options_.nameSpace.empty())
+        result += std::format("namespace {}\n{{\n", options_.nameSpace);
+
+    result += kSeparator + "\n";
+    result += std::format("struct {}\n{{\n", options_.name);
+
+    // The switch of every state is on the class of the byte, the classes are those of the DFA.
+    const auto& classes = dfa.GetByteClasses().Table();
+
+    result += "    constexpr static uint8_t kClasses[256] = {\n";
+
+    for (size_t row = 0; row < classes.size(); row += 16)
+    {
+        result += "       ";
+
+        for (size_t byte = row; byte < row + 16; ++byte)
+            result += std::format(" {},", classes[byte]);
+
+        result += "\n";
+    }
+
+    result += "    };\n\n";
+    result += members;
+    result += "};\n\n";
+    result += kSeparator;
+
+    if (!options_.nameSpace.empty())
+        result += std::format("}} // namespace {}\n", options_.nameSpace);
+
+    return result;
+}
+
+std::string CodeGenerator::GenerateWalk(const FullDFA& dfa, const Walk& walk)
+{
+    const auto indent = std::string(8, ' ');
+    auto start = dfa.Start();
+
+    if (start == FullDFA::kDead)
+        return indent + walk.dead + "\n";
+
+    // States in the order they are reached from the start, which comes first and is entered by falling into it.
+    auto classCount = dfa.GetByteClasses().Count();
+    std::vector<StateId> order = { start };
+    std::vector<bool> isReached(dfa.StateCount(), false);
+    std::vector<bool> isTarget(dfa.StateCount(), false);
+
+    isReached[start] = true;
+
+    for (size_t idx = 0; idx < order.size(); ++idx)
+    {
+        for (size_t cls = 0; cls < classCount; ++cls)
+        {
+            auto target = dfa.Next(order[idx], dfa.GetByteClasses().Representative(cls));
+
+            if (target == FullDFA::kDead)
+                continue;
+
+            isTarget[target] = true;
+
+            if (!isReached[target])
+            {
+                isReached[target] = true;
+                order.push_back(target);
+            }
+        }
+    }
+
+    std::string result;
+
+    for (auto state : order)
+    {
+        if (state != start)
+            result += "\n";
+
+        auto accept = walk.accept && dfa.IsFinal(state) ? walk.accept(state) : std::string();
+        auto label = isTarget[state] ? std::format("    state{}:\n", state) : std::string();
+
+        if (state == start && !walk.acceptAtStart && !accept.empty() && isTarget[state])
+        {
+            // Accepts when a byte leads back to the start but not on entry, so the entry jumps over the accept.
+            result += std::format("{}goto entry{};\n\n{}{}{}\n\n", indent, state, label, indent, accept);
+            result += std::format("    entry{}:\n", state);
+        }
+        else
+        {
+            result += label;
+
+            if (!accept.empty() && (state != start || walk.acceptAtStart))
+                result += indent + accept + "\n\n";
+        }
+
+        result += std::format("{}if (idx >= str.size())\n{}    {}\n\n", indent, indent, walk.end(state));
+
+        // The classes grouped by the state they lead to. The state most of them lead to is the default case.
+        std::map<StateId, std::vector<size_t>> targets;
+
+        for (size_t cls = 0; cls < classCount; ++cls)
+            targets[dfa.Next(state, dfa.GetByteClasses().Representative(cls))].push_back(cls);
+
+        auto jump = [&](StateId target)
+        {
+            return target == FullDFA::kDead ? walk.dead : std::format("goto state{};", target);
+        };
+
+        if (targets.size() == 1 && targets.begin()->first == FullDFA::kDead)
+        {
+            result += indent + walk.dead + "\n";
+            continue;
+        }
+
+        auto fallback = std::ranges::max_element(targets, {}, [](const auto& entry) { return entry.second.size(); });
+
+        result += std::format("{}switch (kClasses[static_cast<uint8_t>(str[idx++])])\n{}{{\n", indent, indent);
+
+        for (const auto& [target, classes] : targets)
+        {
+            if (target == fallback->first)
+                continue;
+
+            for (auto cls : classes)
+                result += std::format("{}case {}:\n", indent, cls);
+
+            result += std::format("{}    {}\n", indent, jump(target));
+        }
+
+        result += std::format("{}default:\n{}    {}\n{}}}\n", indent, indent, jump(fallback->first), indent);
+    }
+
+    return result;
+}
\ No newline at end of file
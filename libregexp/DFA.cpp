@@ -0,0 +1,509 @@
+#include "DFA.h"
+
+#include <algorithm>
+#include <iterator>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+NfaArena::NfaArena(const NFA& nfa)
+    : start(nfa.Start())
+{
+    auto size = static_cast<uint32_t>(nfa.Size());
+
+    transitionOffsets.push_back(0);
+    epsilonOffsets.push_back(0);
+    finalTagOffsets.push_back(0);
+    isFinal.resize(size);
+
+    for (uint32_t idx = 0; idx < nfa.CharSetCount(); ++idx)
+        charSets.push_back(nfa.CharSetAt(idx));
+
+    for (uint32_t idx = 0; idx < size; ++idx)
+    {
+        std::ranges::copy(nfa.Transitions(idx), std::back_inserter(transitions));
+        std::ranges::copy(nfa.EpsilonTransitions(idx), std::back_inserter(epsilon));
+        std::ranges::copy(nfa.FinalTags(idx), std::back_inserter(finalTags));
+
+        transitionOffsets.push_back(static_cast<uint32_t>(transitions.size()));
+        epsilonOffsets.push_back(static_cast<uint32_t>(epsilon.size()));
+        finalTagOffsets.push_back(static_cast<uint32_t>(finalTags.size()));
+    }
+
+    for (auto state : nfa.FinalStates())
+        isFinal[state] = true;
+}
+
+void NfaArena::Closure(std::vector<uint32_t>& nfaStates) const
+{
+    std::vector<bool> seen(Size(), false);
+    std::vector<uint32_t> stack(nfaStates.begin(), nfaStates.end());
+
+    nfaStates.clear();
+
+    while (!stack.empty())
+    {
+        auto idx = stack.back();
+        stack.pop_back();
+
+        if (seen[idx])
+            continue;
+
+        seen[idx] = true;
+        nfaStates.push_back(idx);
+
+        for (auto edge = epsilonOffsets[idx]; edge < epsilonOffsets[idx + 1]; ++edge)
+        {
+            if (!seen[epsilon[edge]])
+                stack.push_back(epsilon[edge]);
+        }
+    }
+
+    std::ranges::sort(nfaStates);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+LazyDFA::LazyDFA(const NFA& nfa, size_t memoryBudget)
+    : nfa_(std::make_shared<const NfaArena>(nfa))
+    , byteClasses_(ByteClasses::FromSets(nfa_->charSets))
+    , stride_(byteClasses_.Count())
+    , memoryBudget_(memoryBudget)
+{
+    ResetCache();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+std::optional<bool> LazyDFA::Accepts(std::string_view str)
+{
+    StateId state = Start();
+
+    if (state == kUnknown)
+        return std::nullopt;
+
+    for (auto ch : str)
+    {
+        state = Next(state, static_cast<uint8_t>(ch));
+
+        if (state == kUnknown)
+            return std::nullopt;
+
+        if (state == kDead)
+            return false;
+    }
+
+    return states_[state].isFinal;
+}
+
+std::optional<size_t> LazyDFA::LongestMatch(std::string_view str)
+{
+    StateId state = Start();
+    size_t result = 0;
+
+    if (state == kUnknown)
+        return std::nullopt;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        if (state == kUnknown)
+            return std::nullopt;
+
+        if (state == kDead)
+            break;
+
+        if (states_[state].isFinal)
+            result = pos + 1;
+    }
+
+    return result;
+}
+
+std::optional<size_t> LazyDFA::LongestMatchBackward(std::string_view str)
+{
+    StateId state = Start();
+    size_t result = 0;
+
+    if (state == kUnknown)
+        return std::nullopt;
+
+    for (size_t length = 1; length <= str.size(); ++length)
+    {
+        state = Next(state, static_cast<uint8_t>(str[str.size() - length]));
+
+        if (state == kUnknown)
+            return std::nullopt;
+
+        if (state == kDead)
+            break;
+
+        if (states_[state].isFinal)
+            result = length;
+    }
+
+    return result;
+}
+
+auto LazyDFA::MatchingTags(std::string_view str) -> std::optional<std::vector<uint32_t>>
+{
+    StateId state = Start();
+
+    if (state == kUnknown)
+        return std::nullopt;
+
+    for (auto ch : str)
+    {
+        state = Next(state, static_cast<uint8_t>(ch));
+
+        if (state == kUnknown)
+            return std::nullopt;
+
+        if (state == kDead)
+            return std::vector<uint32_t>();
+    }
+
+    return states_[state].tags;
+}
+
+auto LazyDFA::LongestMatchPerTag(std::string_view str, size_t tagCount) -> std::optional<std::vector<size_t>>
+{
+    StateId state = Start();
+    std::vector<size_t> result(tagCount, 0);
+
+    if (state == kUnknown)
+        return std::nullopt;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        if (state == kUnknown)
+            return std::nullopt;
+
+        if (state == kDead)
+            break;
+
+        for (auto tag : states_[state].tags)
+            result.at(tag) = pos + 1;
+    }
+
+    return result;
+}
+
+size_t LazyDFA::StateCount() const noexcept
+{
+    return states_.size();
+}
+
+size_t LazyDFA::MemoryUsed() const noexcept
+{
+    return memoryUsed_;
+}
+
+const ByteClasses& LazyDFA::GetByteClasses() const noexcept
+{
+    return byteClasses_;
+}
+
+bool LazyDFA::IsFinal(StateId state) const noexcept
+{
+    return states_[state].isFinal;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto LazyDFA::Start() -> StateId
+{
+    if (start_ != kUnknown)
+        return start_;
+
+    if (nfa_->Size() == 0)
+        return start_ = kDead;
+
+    NfaStateSet startSet = { nfa_->start };
+    nfa_->Closure(startSet);
+
+    start_ = AddState(std::move(startSet));
+    return start_;
+}
+
+auto LazyDFA::Next(StateId state, uint8_t byte) -> StateId
+{
+    auto cls = byteClasses_[byte];
+    auto& cell = table_[state * stride_ + cls];
+
+    if (cell != kUnknown)
+        return cell;
+
+    // All bytes of a class lead to the same states, so the representative stands for the whole class.
+    byte = byteClasses_.Representative(cls);
+
+    NfaStateSet nextStates;
+
+    for (auto nfaState : states_[state].nfaStates)
+    {
+        for (auto idx = nfa_->transitionOffsets[nfaState]; idx < nfa_->transitionOffsets[nfaState + 1]; ++idx)
+        {
+            if (nfa_->charSets[nfa_->transitions[idx].charSet][byte])
+                nextStates.push_back(nfa_->transitions[idx].target);
+        }
+    }
+
+    nfa_->Closure(nextStates);
+
+    auto next = AddState(std::move(nextStates));
+
+    if (next == kUnknown)
+    {
+        ResetCache();
+        return kUnknown;
+    }
+
+    // AddState may have grown the table, so the cell has to be looked up again.
+    table_[state * stride_ + cls] = next;
+    return next;
+}
+
+auto LazyDFA::AddState(NfaStateSet&& nfaStates) -> StateId
+{
+    if (auto it = cache_.find(nfaStates); it != cache_.end())
+        return it->second;
+
+    std::vector<uint32_t> tags;
+
+    for (auto idx : nfaStates)
+    {
+        auto first = nfa_->finalTags.begin();
+        tags.insert(tags.end(), first + nfa_->finalTagOffsets[idx], first + nfa_->finalTagOffsets[idx + 1]);
+    }
+
+    std::ranges::sort(tags);
+    tags.erase(std::ranges::unique(tags).begin(), tags.end());
+
+    auto cost = stride_ * sizeof(StateId) + (2 * nfaStates.size() + tags.size()) * sizeof(uint32_t) + sizeof(DState);
+
+    if (memoryUsed_ + cost > memoryBudget_)
+        return kUnknown;
+
+    memoryUsed_ += cost;
+
+    auto isFinal = !tags.empty();
+    auto id = static_cast<StateId>(states_.size());
+
+    cache_.emplace(nfaStates, id);
+    states_.push_back({std::move(nfaStates), isFinal, std::move(tags)});
+    table_.resize(table_.size() + stride_, kUnknown);
+
+    return id;
+}
+
+void LazyDFA::ResetCache()
+{
+    states_.clear();
+    table_.clear();
+    cache_.clear();
+    memoryUsed_ = 0;
+    start_ = kUnknown;
+
+    // The empty set is the dead state, it is always present and loops onto itself.
+    AddState({});
+    std::ranges::fill(table_, kDead);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+LeftmostDFA::LeftmostDFA(const NFA& nfa, size_t memoryBudget)
+    : nfa_(std::make_shared<const NfaArena>(nfa))
+    , byteClasses_(ByteClasses::FromSets(nfa_->charSets))
+    , stride_(byteClasses_.Count())
+    , memoryBudget_(memoryBudget)
+{
+    if (nfa_->Size() != 0)
+    {
+        startClosure_ = { nfa_->start };
+        nfa_->Closure(startClosure_);
+    }
+
+    ResetCache();
+}
+
+std::optional<size_t> LeftmostDFA::FindEnd(std::string_view str)
+{
+    StateId state = Start();
+    size_t result = 0;
+
+    if (state == kUnknown)
+        return std::nullopt;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        if (state == kUnknown)
+            return std::nullopt;
+
+        if (state == kDead)
+            break;
+
+        if (states_[state].isFinal)
+            result = pos + 1;
+    }
+
+    return result;
+}
+
+size_t LeftmostDFA::StateCount() const noexcept
+{
+    return states_.size();
+}
+
+const ByteClasses& LeftmostDFA::GetByteClasses() const noexcept
+{
+    return byteClasses_;
+}
+
+bool LeftmostDFA::IsFinal(StateId state) const noexcept
+{
+    return states_[state].isFinal;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto LeftmostDFA::Start() -> StateId
+{
+    if (start_ != kUnknown)
+        return start_;
+
+    if (startClosure_.empty())
+        return start_ = kDead;
+
+    StateKey key = { 0 };
+    key.insert(key.end(), startClosure_.begin(), startClosure_.end());
+    key.push_back(kGroupEnd);
+
+    start_ = AddState(std::move(key));
+    return start_;
+}
+
+auto LeftmostDFA::Next(StateId state, uint8_t byte) -> StateId
+{
+    auto cls = byteClasses_[byte];
+    auto& cell = table_[state * stride_ + cls];
+
+    if (cell != kUnknown)
+        return cell;
+
+    byte = byteClasses_.Representative(cls);
+
+    const auto& key = states_[state].key;
+    auto flags = key[0] & kHasMatched;
+
+    StateKey next = { 0 };
+    NfaStateSet group;
+    std::vector<bool> seen(nfa_->Size(), false);
+
+    // Appends the closure of the states to the next key as a group, without the states an earlier group has.
+    auto addGroup = [&](NfaStateSet& states)
+    {
+        nfa_->Closure(states);
+        std::erase_if(states, [&seen](uint32_t nfaState) { return seen[nfaState]; });
+
+        if (states.empty())
+            return false;
+
+        for (auto nfaState : states)
+            seen[nfaState] = true;
+
+        next.insert(next.end(), states.begin(), states.end());
+        next.push_back(kGroupEnd);
+
+        return std::ranges::any_of(states, [this](uint32_t nfaState) { return nfa_->isFinal[nfaState]; });
+    };
+
+    for (size_t idx = 1; idx < key.size(); ++idx)
+    {
+        if (key[idx] != kGroupEnd)
+        {
+            auto nfaState = key[idx];
+
+            for (auto edge = nfa_->transitionOffsets[nfaState]; edge < nfa_->transitionOffsets[nfaState + 1]; ++edge)
+            {
+                if (nfa_->charSets[nfa_->transitions[edge].charSet][byte])
+                    group.push_back(nfa_->transitions[edge].target);
+            }
+
+            continue;
+        }
+
+        // The first group to match wins over all the groups that started after it.
+        if (addGroup(group))
+        {
+            flags = kHasMatched | kIsFinal;
+            break;
+        }
+
+        group.clear();
+    }
+
+    if ((flags & kHasMatched) == 0)
+    {
+        group = startClosure_;
+        addGroup(group);
+    }
+
+    StateId result = kDead;
+
+    if (next.size() > 1)
+    {
+        next[0] = flags;
+        result = AddState(std::move(next));
+    }
+
+    if (result == kUnknown)
+    {
+        ResetCache();
+        return kUnknown;
+    }
+
+    // AddState may have grown the table, so the cell has to be looked up again.
+    table_[state * stride_ + cls] = result;
+    return result;
+}
+
+auto LeftmostDFA::AddState(StateKey&& key) -> StateId
+{
+    if (auto it = cache_.find(key); it != cache_.end())
+        return it->second;
+
+    auto cost = stride_ * sizeof(StateId) + 2 * key.size() * sizeof(uint32_t) + sizeof(DState);
+
+    if (memoryUsed_ + cost > memoryBudget_)
+        return kUnknown;
+
+    memoryUsed_ += cost;
+
+    auto isFinal = (key[0] & kIsFinal) != 0;
+    auto id = static_cast<StateId>(states_.size());
+
+    cache_.emplace(key, id);
+    states_.push_back({std::move(key), isFinal});
+    table_.resize(table_.size() + stride_, kUnknown);
+
+    return id;
+}
+
+void LeftmostDFA::ResetCache()
+{
+    states_.clear();
+    table_.clear();
+    cache_.clear();
+    memoryUsed_ = 0;
+    start_ = kUnknown;
+
+    // A state without groups is dead, it only comes up once a match has stopped new groups from starting.
+    states_.push_back({{ kHasMatched }, false});
+    table_.assign(stride_, kDead);
+}
\ No newline at end of file
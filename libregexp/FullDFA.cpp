@@ -0,0 +1,457 @@
+#include "FullDFA.h"
+#include "DFA.h"
+
+#include <algorithm>
+#include <iterator>
+#include <map>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto FullDFA::Make(const NFA& nfa, size_t maxStates) -> std::optional<FullDFA>
+{
+    FullDFA result;
+    auto tables = std::make_shared<Tables>();
+
+    if (!result.Determinize(nfa, maxStates, *tables))
+        return std::nullopt;
+
+    result.Minimize(*tables);
+    result.Adopt(std::move(tables));
+
+    return result;
+}
+
+auto FullDFA::MakeLeftmost(const NFA& nfa, size_t maxStates) -> std::optional<FullDFA>
+{
+    FullDFA result;
+    auto tables = std::make_shared<Tables>();
+
+    if (!result.Explore(nfa, maxStates, *tables))
+        return std::nullopt;
+
+    result.Minimize(*tables, true);
+    result.Adopt(std::move(tables));
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool FullDFA::Accepts(std::string_view str) const noexcept
+{
+    auto state = start_;
+
+    for (auto ch : str)
+    {
+        state = Next(state, static_cast<uint8_t>(ch));
+
+        if (state == kDead)
+            return false;
+    }
+
+    return IsFinal(state);
+}
+
+size_t FullDFA::LongestMatch(std::string_view str) const noexcept
+{
+    auto state = start_;
+    size_t result = 0;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        state = Next(state, static_cast<uint8_t>(str[pos]));
+
+        if (state == kDead)
+            break;
+
+        if (IsFinal(state))
+            result = pos + 1;
+    }
+
+    return result;
+}
+
+size_t FullDFA::LongestMatchBackward(std::string_view str) const noexcept
+{
+    auto state = start_;
+    size_t result = 0;
+
+    for (size_t length = 1; length <= str.size(); ++length)
+    {
+        state = Next(state, static_cast<uint8_t>(str[str.size() - length]));
+
+        if (state == kDead)
+            break;
+
+        if (IsFinal(state))
+            result = length;
+    }
+
+    return result;
+}
+
+size_t FullDFA::StateCount() const noexcept
+{
+    return tagOffsets_.size() - 1;
+}
+
+auto FullDFA::GetStats() const noexcept -> const Stats&
+{
+    return stats_;
+}
+
+const ByteClasses& FullDFA::GetByteClasses() const noexcept
+{
+    return byteClasses_;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool FullDFA::Determinize(const NFA& nfa, size_t maxStates, Tables& tables)
+{
+    std::vector<CharSet> charSets;
+
+    for (uint32_t idx = 0; idx < nfa.CharSetCount(); ++idx)
+        charSets.push_back(nfa.CharSetAt(idx));
+
+    byteClasses_ = ByteClasses::FromSets(charSets);
+    stride_ = byteClasses_.Count();
+
+    std::vector<bool> isFinal(nfa.Size(), false);
+
+    for (auto state : nfa.FinalStates())
+        isFinal[state] = true;
+
+    std::vector<bool> seen(nfa.Size(), false);
+    std::vector<uint32_t> stack;
+
+    auto closure = [&](std::vector<uint32_t>& states)
+    {
+        stack.assign(states.begin(), states.end());
+        states.clear();
+
+        while (!stack.empty())
+        {
+            auto state = stack.back();
+            stack.pop_back();
+
+            if (seen[state])
+                continue;
+
+            seen[state] = true;
+            states.push_back(state);
+
+            for (auto next : nfa.EpsilonTransitions(state))
+                stack.push_back(next);
+        }
+
+        for (auto state : states)
+            seen[state] = false;
+
+        std::ranges::sort(states);
+    };
+
+    std::map<std::vector<uint32_t>, StateId> ids;
+    std::vector<std::vector<uint32_t>> subsets;
+
+    tables.tagOffsets.push_back(0);
+
+    auto addSubset = [&](std::vector<uint32_t>&& states)
+    {
+        if (auto it = ids.find(states); it != ids.end())
+            return it->second;
+
+        auto id = static_cast<StateId>(subsets.size());
+        auto first = tables.tags.size();
+
+        for (auto state : states)
+        {
+            if (isFinal[state])
+                std::ranges::copy(nfa.FinalTags(state), std::back_inserter(tables.tags));
+        }
+
+        std::sort(tables.tags.begin() + first, tables.tags.end());
+        tables.tags.erase(std::unique(tables.tags.begin() + first, tables.tags.end()), tables.tags.end());
+        tables.tagOffsets.push_back(static_cast<uint32_t>(tables.tags.size()));
+
+        ids.emplace(states, id);
+        subsets.push_back(std::move(states));
+        tables.table.resize(tables.table.size() + stride_, kDead);
+
+        return id;
+    };
+
+    // The empty subset is the dead state.
+    addSubset({});
+
+    if (nfa.Size() == 0)
+        return true;
+
+    std::vector<uint32_t> startSet = { nfa.Start() };
+    closure(startSet);
+    start_ = addSubset(std::move(startSet));
+
+    // New subsets are appended while the earlier ones are processed in order.
+    for (StateId id = 1; id < subsets.size(); ++id)
+    {
+        for (size_t cls = 0; cls < stride_; ++cls)
+        {
+            auto byte = byteClasses_.Representative(cls);
+            std::vector<uint32_t> next;
+
+            for (auto state : subsets[id])
+            {
+                for (auto& transition : nfa.Transitions(state))
+                {
+                    if (nfa.CharSetAt(transition.charSet)[byte])
+                        next.push_back(transition.target);
+                }
+            }
+
+            closure(next);
+
+            auto target = addSubset(std::move(next));
+            tables.table[id * stride_ + cls] = target;
+        }
+
+        if (subsets.size() > maxStates)
+            return false;
+    }
+
+    stats_.subsetStates = subsets.size();
+    return true;
+}
+
+// The lazy LeftmostDFA numbers its states as it finds them, with the dead state first, so walking the ids in order
+// while filling in every row visits them all. Its budget is left unbounded, the state count is what limits the size.
+bool FullDFA::Explore(const NFA& nfa, size_t maxStates, Tables& tables)
+{
+    LeftmostDFA dfa(nfa, SIZE_MAX);
+
+    byteClasses_ = dfa.GetByteClasses();
+    stride_ = byteClasses_.Count();
+    start_ = static_cast<StateId>(dfa.Start());
+
+    tables.tagOffsets.push_back(0);
+
+    for (LeftmostDFA::StateId id = 0; id < static_cast<LeftmostDFA::StateId>(dfa.StateCount()); ++id)
+    {
+        for (size_t cls = 0; cls < stride_; ++cls)
+            tables.table.push_back(static_cast<StateId>(dfa.Next(id, byteClasses_.Representative(cls))));
+
+        if (dfa.IsFinal(id))
+            tables.tags.push_back(0);
+
+        tables.tagOffsets.push_back(static_cast<uint32_t>(tables.tags.size()));
+
+        if (dfa.StateCount() > maxStates)
+            return false;
+    }
+
+    stats_.subsetStates = dfa.StateCount();
+    return true;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Hopcroft's algorithm. The states start out split into one block per tag, the dead state sharing its block with the
+// other non-final states, and the start state in a block of its own if it is kept. A block taken from the worklist is a
+// splitter: for every byte class, each block holding both states that move into the splitter and states that do not
+// is split in two. Only the smaller half needs to be queued unless the split block was queued already.
+// ---------------------------------------------------------------------------------------------------------------------
+
+void FullDFA::Minimize(Tables& tables, bool isStartKept)
+{
+    auto& table = tables.table;
+    auto count = tables.tagOffsets.size() - 1;
+
+    auto tagsOf = [&tables](size_t state)
+    {
+        auto from = tables.tags.begin() + tables.tagOffsets[state];
+        return std::vector<uint32_t>(from, tables.tags.begin() + tables.tagOffsets[state + 1]);
+    };
+
+    // Predecessors of every state per byte class, as offsets into one array.
+    std::vector<uint32_t> inverseOffsets(count * stride_ + 1, 0);
+    std::vector<StateId> inverse(count * stride_);
+
+    for (size_t idx = 0; idx < table.size(); ++idx)
+        ++inverseOffsets[table[idx] * stride_ + idx % stride_ + 1];
+
+    for (size_t idx = 1; idx < inverseOffsets.size(); ++idx)
+        inverseOffsets[idx] += inverseOffsets[idx - 1];
+
+    {
+        auto fill = inverseOffsets;
+
+        for (size_t idx = 0; idx < table.size(); ++idx)
+            inverse[fill[table[idx] * stride_ + idx % stride_]++] = static_cast<StateId>(idx / stride_);
+    }
+
+    std::vector<uint32_t> block(count);
+    std::vector<std::vector<StateId>> members;
+    std::map<std::vector<uint32_t>, uint32_t> initial;
+
+    for (StateId state = 0; state < count; ++state)
+    {
+        // No tag list is made of kNoTag alone.
+        auto key = isStartKept && state == start_ && state != kDead ? std::vector<uint32_t>{ kNoTag } : tagsOf(state);
+        auto [it, isNew] = initial.emplace(std::move(key), static_cast<uint32_t>(members.size()));
+
+        if (isNew)
+            members.emplace_back();
+
+        block[state] = it->second;
+        members[it->second].push_back(state);
+    }
+
+    std::vector<uint32_t> worklist;
+    std::vector<bool> isQueued(members.size(), true);
+
+    for (uint32_t idx = 0; idx < members.size(); ++idx)
+        worklist.push_back(idx);
+
+    std::vector<bool> isMarked(count, false);
+    std::vector<StateId> marked;
+    std::vector<uint32_t> markedCount;
+    std::vector<uint32_t> touched;
+
+    while (!worklist.empty())
+    {
+        auto splitter = members[worklist.back()];
+
+        isQueued[worklist.back()] = false;
+        worklist.pop_back();
+
+        for (size_t cls = 0; cls < stride_; ++cls)
+        {
+            markedCount.resize(members.size(), 0);
+
+            for (auto target : splitter)
+            {
+                auto from = inverseOffsets[target * stride_ + cls];
+                auto to = inverseOffsets[target * stride_ + cls + 1];
+
+                for (auto idx = from; idx < to; ++idx)
+                {
+                    auto state = inverse[idx];
+
+                    if (isMarked[state])
+                        continue;
+
+                    isMarked[state] = true;
+                    marked.push_back(state);
+
+                    if (markedCount[block[state]]++ == 0)
+                        touched.push_back(block[state]);
+                }
+            }
+
+            for (auto split : touched)
+            {
+                if (markedCount[split] == members[split].size())
+                    continue;
+
+                auto added = static_cast<uint32_t>(members.size());
+                std::vector<StateId> kept;
+
+                members.emplace_back();
+
+                for (auto state : members[split])
+                {
+                    if (isMarked[state])
+                    {
+                        members[added].push_back(state);
+                        block[state] = added;
+                    }
+                    else
+                    {
+                        kept.push_back(state);
+                    }
+                }
+
+                members[split] = std::move(kept);
+                isQueued.push_back(false);
+
+                auto queued = isQueued[split] || members[added].size() < members[split].size() ? added : split;
+
+                if (!isQueued[queued])
+                {
+                    isQueued[queued] = true;
+                    worklist.push_back(queued);
+                }
+            }
+
+            for (auto split : touched)
+                markedCount[split] = 0;
+
+            for (auto state : marked)
+                isMarked[state] = false;
+
+            touched.clear();
+            marked.clear();
+        }
+    }
+
+    // The dead state's block comes first and the final blocks last.
+    auto isFinalBlock = [&](uint32_t idx)
+    {
+        auto state = members[idx].front();
+        return tables.tagOffsets[state] != tables.tagOffsets[state + 1];
+    };
+
+    std::vector<uint32_t> order;
+
+    order.push_back(block[kDead]);
+
+    for (uint32_t idx = 0; idx < members.size(); ++idx)
+    {
+        if (idx != block[kDead] && !isFinalBlock(idx))
+            order.push_back(idx);
+    }
+
+    firstFinal_ = static_cast<StateId>(order.size());
+
+    for (uint32_t idx = 0; idx < members.size(); ++idx)
+    {
+        if (isFinalBlock(idx))
+            order.push_back(idx);
+    }
+
+    std::vector<StateId> renumber(members.size());
+
+    for (StateId id = 0; id < order.size(); ++id)
+        renumber[order[id]] = id;
+
+    Tables result;
+
+    result.table.resize(order.size() * stride_);
+    result.tagOffsets.push_back(0);
+
+    for (StateId id = 0; id < order.size(); ++id)
+    {
+        auto state = members[order[id]].front();
+        auto tags = tagsOf(state);
+
+        result.tags.insert(result.tags.end(), tags.begin(), tags.end());
+        result.tagOffsets.push_back(static_cast<uint32_t>(result.tags.size()));
+
+        for (size_t cls = 0; cls < stride_; ++cls)
+            result.table[id * stride_ + cls] = renumber[block[table[state * stride_ + cls]]];
+    }
+
+    start_ = renumber[block[start_]];
+    tables = std::move(result);
+}
+
+void FullDFA::Adopt(std::shared_ptr<const Tables> tables)
+{
+    table_ = tables->table;
+    tagOffsets_ = tables->tagOffsets;
+    tags_ = tables->tags;
+    storage_ = std::move(tables);
+
+    stats_.minimizedStates = StateCount();
+    stats_.tableBytes = table_.size_bytes() + tagOffsets_.size_bytes() + tags_.size_bytes();
+}
\ No newline at end of file
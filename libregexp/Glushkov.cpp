@@ -0,0 +1,311 @@
+#include "Glushkov.h"
+
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+// Glushkov class implementation.
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto Glushkov::Empty() const -> Positions
+{
+    return { {}, {}, true };
+}
+
+auto Glushkov::Symbol(char symbol) -> Positions
+{
+    return Class(CharClass::Single(symbol));
+}
+
+auto Glushkov::Class(const CharSet& symbols) -> Positions
+{
+    auto position = static_cast<uint32_t>(symbols_.size());
+
+    symbols_.push_back(symbols);
+    follow_.emplace_back();
+
+    return { { position }, { position }, false };
+}
+
+auto Glushkov::Alternation(Positions&& lhs, Positions&& rhs) -> Positions
+{
+    auto isSinglePosition = [this](const Positions& positions)
+    {
+        return !positions.nullable && positions.first.size() == 1 && positions.last == positions.first
+            && follow_[positions.first[0]].empty();
+    };
+
+    // Both sides are just created symbols, so the right one can be folded into the left one.
+    if (isSinglePosition(lhs) && isSinglePosition(rhs) && rhs.first[0] + 1 == symbols_.size())
+    {
+        symbols_[lhs.first[0]] |= symbols_.back();
+        symbols_.pop_back();
+        follow_.pop_back();
+
+        return std::move(lhs);
+    }
+
+    lhs.first.insert(lhs.first.end(), rhs.first.begin(), rhs.first.end());
+    lhs.last.insert(lhs.last.end(), rhs.last.begin(), rhs.last.end());
+    lhs.nullable = lhs.nullable || rhs.nullable;
+
+    return std::move(lhs);
+}
+
+auto Glushkov::Concatenation(Positions&& lhs, Positions&& rhs) -> Positions
+{
+    AddFollow(lhs.last, rhs.first);
+
+    Positions result;
+    result.first = lhs.first;
+    result.last = rhs.last;
+    result.nullable = lhs.nullable && rhs.nullable;
+
+    if (lhs.nullable)
+        result.first.insert(result.first.end(), rhs.first.begin(), rhs.first.end());
+
+    if (rhs.nullable)
+        result.last.insert(result.last.end(), lhs.last.begin(), lhs.last.end());
+
+    return result;
+}
+
+auto Glushkov::Repetition(Positions&& pattern) -> Positions
+{
+    AddFollow(pattern.last, pattern.first);
+    pattern.nullable = true;
+
+    return std::move(pattern);
+}
+
+auto Glushkov::OneOrMore(Positions&& pattern) -> Positions
+{
+    AddFollow(pattern.last, pattern.first);
+    return std::move(pattern);
+}
+
+auto Glushkov::Optional(Positions&& pattern) const -> Positions
+{
+    pattern.nullable = true;
+    return std::move(pattern);
+}
+
+void Glushkov::SetRoot(Positions&& root)
+{
+    root_ = std::move(root);
+}
+
+size_t Glushkov::Size() const noexcept
+{
+    return symbols_.size();
+}
+
+auto Glushkov::Root() const noexcept -> const Positions&
+{
+    return root_;
+}
+
+auto Glushkov::Symbols(uint32_t position) const -> const CharSet&
+{
+    return symbols_.at(position);
+}
+
+auto Glushkov::Follow(uint32_t position) const -> const PositionList&
+{
+    return follow_.at(position);
+}
+
+void Glushkov::AddFollow(const PositionList& from, const PositionList& to)
+{
+    for (auto position : from)
+    {
+        auto& follow = follow_[position];
+        follow.insert(follow.end(), to.begin(), to.end());
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// BitParallelMatcher class implementation.
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+constexpr size_t kMaxWords = (BitParallelMatcher::kMaxPositions + 1 + 63) / 64;
+}
+
+BitParallelMatcher::BitParallelMatcher(const Glushkov& glushkov)
+{
+    auto positions = glushkov.Size();
+
+    if (positions > kMaxPositions)
+        throw std::invalid_argument("Too many positions for a bit-parallel matcher: " + std::to_string(positions));
+
+    auto bits = positions + 1;
+    words_ = (bits + kWordBits - 1) / kWordBits;
+    chunks_ = (bits + kChunkBits - 1) / kChunkBits;
+
+    auto setBit = [this](Word* words, size_t bit)
+    {
+        words[bit / kWordBits] |= Word{1} << (bit % kWordBits);
+    };
+
+    for (uint32_t position = 0; position < positions; ++position)
+        byteClasses_.Add(glushkov.Symbols(position));
+
+    followTable_.assign(chunks_ * 256 * words_, 0);
+    symbolMasks_.assign(byteClasses_.Count() * words_, 0);
+    finalMask_.assign(words_, 0);
+
+    for (size_t chunk = 0; chunk < chunks_; ++chunk)
+    {
+        for (size_t value = 1; value < 256; ++value)
+        {
+            auto* row = &followTable_[(chunk * 256 + value) * words_];
+
+            for (size_t bit = 0; bit < kChunkBits; ++bit)
+            {
+                auto state = chunk * kChunkBits + bit;
+
+                if ((value & (size_t{1} << bit)) == 0 || state >= bits)
+                    continue;
+
+                auto& follow = state == 0 ? glushkov.Root().first : glushkov.Follow(state - 1);
+
+                for (auto position : follow)
+                    setBit(row, position + 1);
+            }
+        }
+    }
+
+    for (uint32_t position = 0; position < positions; ++position)
+    {
+        auto& symbols = glushkov.Symbols(position);
+
+        for (size_t cls = 0; cls < byteClasses_.Count(); ++cls)
+        {
+            if (symbols[byteClasses_.Representative(cls)])
+                setBit(&symbolMasks_[cls * words_], position + 1);
+        }
+    }
+
+    for (auto position : glushkov.Root().last)
+        setBit(finalMask_.data(), position + 1);
+
+    if (glushkov.Root().nullable)
+        setBit(finalMask_.data(), 0);
+}
+
+bool BitParallelMatcher::Accepts(std::string_view str) const
+{
+    std::array<Word, kMaxWords> active = { 1 };
+    std::array<Word, kMaxWords> next = {};
+
+    for (auto ch : str)
+    {
+        if (!Step(active.data(), next.data(), static_cast<uint8_t>(ch)))
+            return false;
+
+        std::swap(active, next);
+    }
+
+    return IsFinal(active.data());
+}
+
+size_t BitParallelMatcher::LongestMatch(std::string_view str) const
+{
+    std::array<Word, kMaxWords> active = { 1 };
+    std::array<Word, kMaxWords> next = {};
+    size_t result = 0;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        if (!Step(active.data(), next.data(), static_cast<uint8_t>(str[pos])))
+            break;
+
+        std::swap(active, next);
+
+        if (IsFinal(active.data()))
+            result = pos + 1;
+    }
+
+    return result;
+}
+
+size_t BitParallelMatcher::MemoryUsage() const noexcept
+{
+    return (followTable_.size() + symbolMasks_.size() + finalMask_.size()) * sizeof(Word) + sizeof(ByteClasses);
+}
+
+const ByteClasses& BitParallelMatcher::GetByteClasses() const noexcept
+{
+    return byteClasses_;
+}
+
+auto BitParallelMatcher::Make(const Glushkov& glushkov) -> std::optional<BitParallelMatcher>
+{
+    if (glushkov.Size() > kMaxPositions)
+        return std::nullopt;
+
+    return BitParallelMatcher(glushkov);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool BitParallelMatcher::Step(Word* active, Word* next, uint8_t byte) const
+{
+    auto* mask = &symbolMasks_[byteClasses_[byte] * words_];
+
+    if (words_ == 1)
+    {
+        Word result = 0;
+
+        for (size_t chunk = 0; chunk < chunks_; ++chunk)
+        {
+            if (auto value = (active[0] >> (chunk * kChunkBits)) & 0xff; value != 0)
+                result |= followTable_[chunk * 256 + value];
+        }
+
+        next[0] = result & mask[0];
+        return next[0] != 0;
+    }
+
+    std::fill_n(next, words_, 0);
+
+    for (size_t chunk = 0; chunk < chunks_; ++chunk)
+    {
+        auto value = (active[chunk / kChunksPerWord] >> (chunk % kChunksPerWord * kChunkBits)) & 0xff;
+
+        if (value == 0)
+            continue;
+
+        auto* row = &followTable_[(chunk * 256 + value) * words_];
+
+        for (size_t word = 0; word < words_; ++word)
+            next[word] |= row[word];
+    }
+
+    Word any = 0;
+
+    for (size_t word = 0; word < words_; ++word)
+    {
+        next[word] &= mask[word];
+        any |= next[word];
+    }
+
+    return any != 0;
+}
+
+bool BitParallelMatcher::IsFinal(const Word* active) const
+{
+    for (size_t word = 0; word < words_; ++word)
+    {
+        if ((active[word] & finalMask_[word]) != 0)
+            return true;
+    }
+
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,75 @@
+#include "Lexer.h"
+#include "NFA.h"
+#include "Optimizer.h"
+#include "Parser.h"
+
+#include <format>
+#include <stdexcept>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+Lexer::Lexer(const std::vector<Rule>& rules, size_t maxRepeatCount)
+    : dfa_(Compile(rules, maxRepeatCount))
+{
+    for (auto& rule : rules)
+        kinds_.push_back(rule.kind);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto Lexer::Next(std::string_view str, size_t pos) const noexcept -> Lexeme
+{
+    Lexeme result = {kNoMatch, 0};
+    auto state = dfa_.Start();
+
+    for (auto idx = pos; idx < str.size(); ++idx)
+    {
+        state = dfa_.Next(state, static_cast<uint8_t>(str[idx]));
+
+        if (state == FullDFA::kDead)
+            break;
+
+        if (dfa_.IsFinal(state))
+            result = {kinds_[dfa_.Tag(state)], idx - pos + 1};
+    }
+
+    return result;
+}
+
+size_t Lexer::StateCount() const noexcept
+{
+    return dfa_.StateCount();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+FullDFA Lexer::Compile(const std::vector<Rule>& rules, size_t maxRepeatCount)
+{
+    NFA nfa(0);
+
+    auto start = nfa.AddState();
+    nfa.SetStart(start);
+
+    for (uint32_t idx = 0; idx < rules.size(); ++idx)
+    {
+        Scanner scanner(rules[idx].pattern, maxRepeatCount);
+        Parser parser(scanner.ScanTokens(), maxRepeatCount);
+
+        auto fragment = Optimizer(parser.Parse()->ConvertToAst()).Result()->BuildNFA(nfa);
+
+        nfa.AddEpsilonTransition(start, fragment.start);
+        nfa.SetFinalTag(fragment.end, idx);
+    }
+
+    auto dfa = FullDFA::Make(nfa);
+
+    if (!dfa.has_value())
+    {
+        auto maxStates = FullDFA::kDefaultMaxStates;
+        throw std::runtime_error(std::format("Error: Lexer rules need more than {} DFA states.", maxStates));
+    }
+
+    return std::move(*dfa);
+}
\ No newline at end of file
@@ -0,0 +1,95 @@
+#include "MappedFile.h"
+
+#include <format>
+#include <stdexcept>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#else
+#include <fstream>
+#include <sstream>
+#endif
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+#if defined(__unix__) || defined(__APPLE__)
+
+MappedFile::MappedFile(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+
+    if (fd < 0)
+        throw std::runtime_error(std::format("Error: Cannot open file '{}'.", path));
+
+    struct stat info = {};
+
+    if (::fstat(fd, &info) != 0)
+    {
+        ::close(fd);
+        throw std::runtime_error(std::format("Error: Cannot read file '{}'.", path));
+    }
+
+    size_ = static_cast<size_t>(info.st_size);
+
+    // An empty file cannot be mapped, it is just an empty view.
+    if (size_ > 0)
+    {
+        void* data = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (data == MAP_FAILED)
+        {
+            ::close(fd);
+            throw std::runtime_error(std::format("Error: Cannot map file '{}'.", path));
+        }
+
+        ::madvise(data, size_, MADV_SEQUENTIAL);
+        data_ = static_cast<const char*>(data);
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    ::close(fd);
+}
+
+MappedFile::~MappedFile()
+{
+    if (data_ != nullptr)
+        ::munmap(const_cast<char*>(data_), size_);
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    std::ifstream file(path, std::ios::binary);
+
+    if (!file)
+        throw std::runtime_error(std::format("Error: Cannot open file '{}'.", path));
+
+    std::ostringstream contents;
+    contents << file.rdbuf();
+
+    contents_ = std::move(contents).str();
+    data_ = contents_.data();
+    size_ = contents_.size();
+}
+
+MappedFile::~MappedFile() = default;
+
+#endif
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+std::string_view MappedFile::View() const noexcept
+{
+    return {data_, size_};
+}
+
+size_t MappedFile::Size() const noexcept
+{
+    return size_;
+}
\ No newline at end of file
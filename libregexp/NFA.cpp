@@ -1,7 +1,12 @@
 #include "NFA.h"
+#include "SparseSet.h"
 
 #include <algorithm>
-#include <deque>
+#include <atomic>
+#include <iterator>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
 
 using namespace Regex;
 
@@ -11,28 +16,79 @@ using namespace Regex;
 
 struct NFA::Impl
 {
-    bool Accepts(const std::string& str);
-    MatchList FindMatches(const std::string& str);
-    std::string LongestMatch(const std::string& str, size_t pos = 0);
-    size_t FindLongestMatchImpl(std::string_view strView);
+    using StateList = std::vector<StateId>;
+    using TagList = std::vector<uint32_t>;
 
-    void ReadCharacter(char symbol);
-    void ReadString(const std::string& str);
+    MatchList FindMatches(const std::string& str, Scratch& scratch) const;
+    bool Accepts(std::string_view strView, Scratch& scratch) const;
+    size_t FindLongestMatchImpl(std::string_view strView, Scratch& scratch) const;
 
-    bool IsInFinalState() const;
-    bool IsInFailedState() const;
-    void ResetCurrentStates();
+    void ResetCurrentStates(Scratch& scratch) const;
+    void ReadCharacter(char symbol, Scratch& scratch) const;
+    bool IsInFinalState(const Scratch& scratch) const;
 
-    StatePtrSet AllPossibleCurrentStates(StatePtrSet&& states) const;
-    StatePtrSet NextStates(const StatePtrSet& states, char symbol) const;
-    StatePtrSet NextFreeMoveStates(const StatePtrSet& states) const;
+    void AddThread(SparseSet& threads, StateId state, StateList& stack) const;
+    void WalkEpsilon(SparseSet& threads, StateId state, StateList& stack) const;
+
+    void Prepare();
+    void Invalidate() noexcept;
+    void Compact();
+    void ComputeClosures();
+    void CheckState(Index idx) const;
 
 public:
-    std::deque<StatePtr> states_ = {};
-    StatePtrSet currentStates_ = {};
-    StatePtrSet finalStates_ = {};
+    size_t size_ = 0;
+    StateId start_ = 0;
+
+    std::vector<bool> isFinal_ = {};
+    std::vector<TagList> finalTags_ = {};
+    StateList finalStates_ = {};
+
+    std::vector<CharSet> charSets_ = {};
+    std::unordered_map<CharSet, uint32_t> charSetIndices_ = {};
+
+    // Transitions grouped by their source state: the ones of state i are in [offsets[i], offsets[i + 1]).
+    std::vector<Transition> transitions_ = {};
+    std::vector<uint32_t> transitionOffsets_ = { 0 };
+    StateList epsilon_ = {};
+    std::vector<uint32_t> epsilonOffsets_ = { 0 };
+
+    // Transitions added since the last Compact(), they are folded into the arrays above before the next read.
+    std::vector<std::pair<StateId, Transition>> pendingTransitions_ = {};
+    std::vector<std::pair<StateId, StateId>> pendingEpsilon_ = {};
+
+    // Epsilon closure of every state as a sorted list, computed before the first read after the NFA has changed, so
+    // that adding a thread is a plain union. Without closures, when they would not fit kMaxClosureEntries, the
+    // epsilon transitions are walked on every read instead.
+    StateList closures_ = {};
+    std::vector<uint32_t> closureOffsets_ = {};
+    size_t closureStates_ = kStale;
+    bool hasClosures_ = false;
+
+    constexpr static size_t kStale = SIZE_MAX;
+
+    size_t MaxClosureEntries() const noexcept
+    {
+        return 16 * size_ + (1 << 16);
+    }
+
+    // Set once the pending transitions are compacted and the closures are up to date. Searches only read the NFA
+    // after that; the first one to find the flag unset prepares the NFA under the mutex.
+    std::atomic<bool> isPrepared_ = false;
+    std::mutex prepareMutex_ = {};
 };
 
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+NFA::Scratch& LocalScratch()
+{
+    thread_local NFA::Scratch scratch;
+    return scratch;
+}
+} // namespace
+
 // ---------------------------------------------------------------------------------------------------------------------
 // NFA class implementation.
 // ---------------------------------------------------------------------------------------------------------------------
@@ -43,47 +99,33 @@ NFA::NFA(size_t stateCount)
     if (stateCount == 0)
         return;
 
-    impl_->states_.resize(stateCount);
-
     for (size_t id = 0; id < stateCount; ++id)
-        impl_->states_[id] = std::make_shared<State>();
+        AddState();
 
     ResetFinalStates({0});
 }
 
 NFA::~NFA() = default;
 
-State& NFA::operator[](Index idx)
+auto NFA::Prepared() const -> const Impl&
 {
-    auto& states = impl_->states_;
-
-    if (states.size() <= idx)
-        throw std::invalid_argument("No state with the index of " + std::to_string(idx));
-
-    return *states[idx];
+    impl_->Prepare();
+    return *impl_;
 }
 
-const StatePtr& NFA::At(Index idx) const
+bool NFA::Accepts(const std::string& str) const
 {
-    auto& states = impl_->states_;
-
-    if (states.size() <= idx)
-        throw std::invalid_argument("No state with the index of " + std::to_string(idx));
-
-    return states.at(idx);
+    return Prepared().Accepts(str, LocalScratch());
 }
 
-bool NFA::Accepts(const std::string& str) const
+bool NFA::Accepts(std::string_view str, Scratch& scratch) const
 {
-    impl_->ResetCurrentStates();
-    impl_->ReadString(str);
-
-    return impl_->IsInFinalState();
+    return Prepared().Accepts(str, scratch);
 }
 
 auto NFA::FindMatches(const std::string& str) const -> MatchList
 {
-    return impl_->FindMatches(str);
+    return Prepared().FindMatches(str, LocalScratch());
 }
 
 std::string NFA::LongestMatch(const std::string& str, size_t pos) const
@@ -91,7 +133,7 @@ std::string NFA::LongestMatch(const std::string& str, size_t pos) const
     std::string_view strView = str;
     strView = strView.substr(pos);
 
-    if (size_t longest = impl_->FindLongestMatchImpl(strView); longest > 0)
+    if (size_t longest = Prepared().FindLongestMatchImpl(strView, LocalScratch()); longest > 0)
     {
         return str.substr(pos, longest);
     }
@@ -99,29 +141,308 @@ std::string NFA::LongestMatch(const std::string& str, size_t pos) const
     return {};
 }
 
+size_t NFA::LongestMatchLength(std::string_view str) const
+{
+    return Prepared().FindLongestMatchImpl(str, LocalScratch());
+}
+
+size_t NFA::LongestMatchLength(std::string_view str, Scratch& scratch) const
+{
+    return Prepared().FindLongestMatchImpl(str, scratch);
+}
+
+size_t NFA::LongestMatchLength(std::string_view str, bool& isAlive) const
+{
+    auto& scratch = LocalScratch();
+    auto result = Prepared().FindLongestMatchImpl(str, scratch);
+
+    // The simulation stops as soon as no thread is left, so the thread list is empty exactly when the match is over.
+    isAlive = !scratch.current_.Empty();
+    return result;
+}
+
+std::vector<uint32_t> NFA::MatchingTags(std::string_view str) const
+{
+    std::vector<uint32_t> result;
+    auto& scratch = LocalScratch();
+
+    if (!Prepared().Accepts(str, scratch))
+        return result;
+
+    for (auto state : scratch.current_)
+    {
+        if (impl_->isFinal_[state])
+            std::ranges::copy(impl_->finalTags_[state], std::back_inserter(result));
+    }
+
+    std::ranges::sort(result);
+    result.erase(std::ranges::unique(result).begin(), result.end());
+
+    return result;
+}
+
+std::vector<size_t> NFA::LongestMatchPerTag(std::string_view str, size_t tagCount) const
+{
+    std::vector<size_t> result(tagCount, 0);
+    auto& scratch = LocalScratch();
+    auto& impl = Prepared();
+
+    impl.ResetCurrentStates(scratch);
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        impl.ReadCharacter(str[pos], scratch);
+
+        if (scratch.current_.Empty())
+            break;
+
+        for (auto state : scratch.current_)
+        {
+            if (!impl.isFinal_[state])
+                continue;
+
+            for (auto tag : impl.finalTags_[state])
+                result.at(tag) = pos + 1;
+        }
+    }
+
+    return result;
+}
+
+NFA NFA::EliminateEpsilon() const
+{
+    auto& impl = *impl_;
+    NFA result(0);
+
+    if (impl.size_ == 0)
+        return result;
+
+    impl.Prepare();
+
+    // Only the start state and the targets of symbol transitions are kept, every kept state takes over the
+    // transitions and the finality of its epsilon closure.
+    constexpr static StateId kNone = UINT32_MAX;
+
+    std::vector<StateId> ids(impl.size_, kNone);
+    Impl::StateList queue = { impl.start_ };
+    SparseSet closure(impl.size_);
+    Impl::StateList stack;
+    std::vector<Transition> edges;
+    Impl::TagList tags;
+
+    ids[impl.start_] = result.AddState();
+
+    for (size_t head = 0; head < queue.size(); ++head)
+    {
+        auto state = queue[head];
+
+        closure.Clear();
+        impl.AddThread(closure, state, stack);
+        edges.clear();
+        tags.clear();
+
+        for (auto member : closure)
+        {
+            if (impl.isFinal_[member])
+                std::ranges::copy(impl.finalTags_[member], std::back_inserter(tags));
+
+            for (auto idx = impl.transitionOffsets_[member]; idx < impl.transitionOffsets_[member + 1]; ++idx)
+                edges.push_back(impl.transitions_[idx]);
+        }
+
+        auto key = [](const Transition& edge)
+        {
+            return std::pair(edge.charSet, edge.target);
+        };
+
+        std::ranges::sort(edges, {}, key);
+        edges.erase(std::ranges::unique(edges, {}, key).begin(), edges.end());
+
+        for (auto& edge : edges)
+        {
+            if (ids[edge.target] == kNone)
+            {
+                ids[edge.target] = result.AddState();
+                queue.push_back(edge.target);
+            }
+
+            result.AddTransition(ids[state], impl.charSets_[edge.charSet], ids[edge.target]);
+        }
+
+        for (auto tag : tags)
+            result.AddFinalTag(ids[state], tag);
+    }
+
+    result.SetStart(ids[impl.start_]);
+    return result;
+}
+
+NFA NFA::Reverse() const
+{
+    auto& impl = Prepared();
+    NFA result(0);
+
+    if (impl.size_ == 0)
+        return result;
+
+    for (size_t state = 0; state < impl.size_; ++state)
+        result.AddState();
+
+    for (StateId state = 0; state < impl.size_; ++state)
+    {
+        for (auto idx = impl.transitionOffsets_[state]; idx < impl.transitionOffsets_[state + 1]; ++idx)
+        {
+            auto& transition = impl.transitions_[idx];
+            result.AddTransition(transition.target, impl.charSets_[transition.charSet], state);
+        }
+
+        for (auto idx = impl.epsilonOffsets_[state]; idx < impl.epsilonOffsets_[state + 1]; ++idx)
+            result.AddEpsilonTransition(impl.epsilon_[idx], state);
+    }
+
+    auto start = result.AddState();
+
+    for (auto state : impl.finalStates_)
+        result.AddEpsilonTransition(start, state);
+
+    result.SetStart(start);
+    result.ResetFinalStates({ impl.start_ });
+
+    return result;
+}
+
+NFA NFA::ReversePrefixes() const
+{
+    auto result = Reverse();
+
+    if (result.Size() == 0)
+        return result;
+
+    // The start state of the reversed NFA comes last.
+    for (StateId state = 0; state + 1 < result.Size(); ++state)
+        result.AddEpsilonTransition(result.Start(), state);
+
+    return result;
+}
+
 size_t NFA::Size() const noexcept
 {
-    return impl_->states_.size();
+    return impl_->size_;
+}
+
+size_t NFA::MemoryUsage() const
+{
+    impl_->Prepare();
+
+    return impl_->transitions_.size() * sizeof(Transition)
+        + impl_->epsilon_.size() * sizeof(StateId)
+        + (impl_->transitionOffsets_.size() + impl_->epsilonOffsets_.size()) * sizeof(uint32_t)
+        + impl_->charSets_.size() * sizeof(CharSet)
+        + impl_->finalStates_.size() * sizeof(StateId)
+        + (impl_->closures_.size() + impl_->closureOffsets_.size()) * sizeof(uint32_t)
+        + impl_->isFinal_.size() / 8;
+}
+
+const CharSet& NFA::CharSetAt(uint32_t idx) const
+{
+    return impl_->charSets_.at(idx);
+}
+
+size_t NFA::CharSetCount() const noexcept
+{
+    return impl_->charSets_.size();
 }
 
-const StatePtrSet& NFA::CurrentStates() const
+StateId NFA::Start() const noexcept
 {
-    return impl_->currentStates_;
+    return impl_->start_;
 }
 
-const StatePtrSet& NFA::FinalStates() const
+bool NFA::IsFinal(StateId state) const
+{
+    impl_->CheckState(state);
+    return impl_->isFinal_[state];
+}
+
+std::span<const uint32_t> NFA::FinalTags(StateId state) const
+{
+    impl_->CheckState(state);
+
+    if (!impl_->isFinal_[state])
+        return {};
+
+    return impl_->finalTags_[state];
+}
+
+std::span<const StateId> NFA::FinalStates() const
 {
     return impl_->finalStates_;
 }
 
+std::span<const Transition> NFA::Transitions(StateId state) const
+{
+    impl_->CheckState(state);
+    impl_->Prepare();
+
+    auto& offsets = impl_->transitionOffsets_;
+    return std::span(impl_->transitions_).subspan(offsets[state], offsets[state + 1] - offsets[state]);
+}
+
+std::span<const StateId> NFA::EpsilonTransitions(StateId state) const
+{
+    impl_->CheckState(state);
+    impl_->Prepare();
+
+    auto& offsets = impl_->epsilonOffsets_;
+    return std::span(impl_->epsilon_).subspan(offsets[state], offsets[state + 1] - offsets[state]);
+}
+
+StateId NFA::AddState()
+{
+    impl_->Invalidate();
+    auto id = static_cast<StateId>(impl_->size_++);
+
+    impl_->isFinal_.push_back(false);
+    impl_->finalTags_.emplace_back();
+    impl_->transitionOffsets_.push_back(impl_->transitionOffsets_.back());
+    impl_->epsilonOffsets_.push_back(impl_->epsilonOffsets_.back());
+
+    return id;
+}
+
+void NFA::SetStart(StateId state)
+{
+    impl_->CheckState(state);
+    impl_->start_ = state;
+}
+
 void NFA::AddTransition(Index from_idx, char symbol, Index to_idx)
 {
-    auto& states = impl_->states_;
+    if (symbol == kEpsilon)
+    {
+        impl_->CheckState(from_idx);
+        impl_->CheckState(to_idx);
+        impl_->Invalidate();
+        impl_->pendingEpsilon_.emplace_back(static_cast<StateId>(from_idx), static_cast<StateId>(to_idx));
+        return;
+    }
+
+    AddTransition(from_idx, CharClass::Single(symbol), to_idx);
+}
+
+void NFA::AddTransition(Index from_idx, const CharSet& symbols, Index to_idx)
+{
+    impl_->CheckState(from_idx);
+    impl_->CheckState(to_idx);
+
+    auto [it, isInserted] = impl_->charSetIndices_.try_emplace(symbols, impl_->charSets_.size());
 
-    auto& from = *states[from_idx];
-    auto to = states[to_idx];
+    if (isInserted)
+        impl_->charSets_.push_back(symbols);
 
-    from[symbol].insert(to);
+    auto transition = Transition{it->second, static_cast<StateId>(to_idx)};
+    impl_->Invalidate();
+    impl_->pendingTransitions_.emplace_back(static_cast<StateId>(from_idx), transition);
 }
 
 void NFA::AddEpsilonTransition(Index from_idx, Index to_idx)
@@ -131,47 +452,64 @@ void NFA::AddEpsilonTransition(Index from_idx, Index to_idx)
 
 void NFA::AddStartStateTransition(char symbol, Index to_idx)
 {
-    return AddTransition(0, symbol, to_idx);
+    return AddTransition(impl_->start_, symbol, to_idx);
 }
 
 void NFA::AddFinalStates(const IndexSet& indices)
 {
     for (auto idx : indices)
-        impl_->finalStates_.insert(impl_->states_[idx]);
-}
+    {
+        impl_->CheckState(idx);
 
-void NFA::ResetFinalStates(const IndexSet& indices)
-{
-    impl_->finalStates_.clear();
-    AddFinalStates(indices);
+        if (impl_->isFinal_[idx])
+            continue;
+
+        if (impl_->finalTags_[idx].empty())
+            impl_->finalTags_[idx].push_back(0);
+
+        impl_->isFinal_[idx] = true;
+        impl_->finalStates_.push_back(static_cast<StateId>(idx));
+    }
+
+    std::ranges::sort(impl_->finalStates_);
 }
 
-void NFA::PushFront()
+void NFA::SetFinalTag(Index idx, uint32_t tag)
 {
-    impl_->states_.emplace_front(State::Make());
-    AddTransition(0, kEpsilon, 1);
+    AddFinalStates({ idx });
+    impl_->finalTags_[idx] = { tag };
 }
 
-void NFA::PushBack()
+void NFA::AddFinalTag(Index idx, uint32_t tag)
 {
-    impl_->states_.emplace_back(State::Make());
+    impl_->CheckState(idx);
+
+    if (!impl_->isFinal_[idx])
+    {
+        SetFinalTag(idx, tag);
+        return;
+    }
+
+    auto& tags = impl_->finalTags_[idx];
+
+    if (auto it = std::ranges::lower_bound(tags, tag); it == tags.end() || *it != tag)
+        tags.insert(it, tag);
 }
 
-void NFA::Merge(NFA&& source)
+void NFA::ResetFinalStates(const IndexSet& indices)
 {
-    auto& srcImpl = source.impl_;
-
-    impl_->ResetCurrentStates();
-    impl_->finalStates_.merge(srcImpl->finalStates_);
+    for (auto state : impl_->finalStates_)
+        impl_->isFinal_[state] = false;
 
-    std::ranges::move(srcImpl->states_, std::back_inserter(impl_->states_));
+    impl_->finalStates_.clear();
+    AddFinalStates(indices);
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
 // NFA::Impl struct implementation.
 // ---------------------------------------------------------------------------------------------------------------------
 
-NFA::MatchList NFA::Impl::FindMatches(const std::string& str)
+NFA::MatchList NFA::Impl::FindMatches(const std::string& str, Scratch& scratch) const
 {
     MatchList result;
 
@@ -181,7 +519,7 @@ NFA::MatchList NFA::Impl::FindMatches(const std::string& str)
 
     while (startPos < str.size())
     {
-        longest = FindLongestMatchImpl(strView);
+        longest = FindLongestMatchImpl(strView, scratch);
 
         if (longest == 0)
         {
@@ -198,108 +536,220 @@ NFA::MatchList NFA::Impl::FindMatches(const std::string& str)
     return result;
 }
 
-std::string NFA::Impl::LongestMatch(const std::string& str, size_t pos)
+bool NFA::Impl::Accepts(std::string_view strView, Scratch& scratch) const
 {
-    std::string_view strView(str.data() + pos, str.size() - pos);
-    size_t longest = FindLongestMatchImpl(strView);
+    ResetCurrentStates(scratch);
 
-    if (longest > 0)
+    for (auto ch : strView)
     {
-        return str.substr(pos, longest);
+        ReadCharacter(ch, scratch);
+
+        if (scratch.current_.Empty())
+            return false;
     }
 
-    return {};
+    return IsInFinalState(scratch);
 }
 
-void NFA::Impl::ReadCharacter(char symbol)
+size_t NFA::Impl::FindLongestMatchImpl(std::string_view strView, Scratch& scratch) const
 {
-    auto nextStates = NextStates(currentStates_, symbol);
-    currentStates_ = AllPossibleCurrentStates(std::move(nextStates));
+    ResetCurrentStates(scratch);
+
+    size_t result = 0;
+
+    for (size_t pos = 0; pos < strView.size(); ++pos)
+    {
+        ReadCharacter(strView[pos], scratch);
+
+        if (scratch.current_.Empty())
+            break;
+
+        if (IsInFinalState(scratch))
+            result = pos + 1;
+    }
+
+    return result;
 }
 
-void NFA::Impl::ReadString(const std::string& str)
+void NFA::Impl::ResetCurrentStates(Scratch& scratch) const
 {
-    for (auto ch : str)
+    // A scratch serves NFAs of any size, it only grows.
+    if (scratch.current_.Capacity() < size_)
     {
-        ReadCharacter(ch);
+        scratch.current_.Resize(size_);
+        scratch.next_.Resize(size_);
+        scratch.stack_.reserve(size_);
     }
+
+    scratch.current_.Clear();
+
+    if (size_ != 0)
+        AddThread(scratch.current_, start_, scratch.stack_);
 }
 
-bool NFA::Impl::IsInFinalState() const
+void NFA::Impl::ReadCharacter(char symbol, Scratch& scratch) const
 {
-    return std::ranges::any_of(currentStates_, [this](auto& state)
+    auto byte = static_cast<uint8_t>(symbol);
+    scratch.next_.Clear();
+
+    for (auto state : scratch.current_)
     {
-        return finalStates_.contains(state);
-    });
+        for (auto idx = transitionOffsets_[state]; idx < transitionOffsets_[state + 1]; ++idx)
+        {
+            if (charSets_[transitions_[idx].charSet][byte])
+                AddThread(scratch.next_, transitions_[idx].target, scratch.stack_);
+        }
+    }
+
+    std::swap(scratch.current_, scratch.next_);
 }
 
-bool NFA::Impl::IsInFailedState() const
+bool NFA::Impl::IsInFinalState(const Scratch& scratch) const
 {
-    return currentStates_.empty();
+    return std::ranges::any_of(scratch.current_, [this](auto state)
+    {
+        return isFinal_[state];
+    });
 }
 
-void NFA::Impl::ResetCurrentStates()
+void NFA::Impl::AddThread(SparseSet& threads, StateId state, StateList& stack) const
 {
-    auto& startState = states_[0];
-    currentStates_ = AllPossibleCurrentStates({ startState });
+    if (!hasClosures_)
+    {
+        WalkEpsilon(threads, state, stack);
+        return;
+    }
+
+    // A state already in the list came with its closure, which contains the closure of this one.
+    if (!threads.Insert(state))
+        return;
+
+    for (auto idx = closureOffsets_[state]; idx < closureOffsets_[state + 1]; ++idx)
+        threads.Insert(closures_[idx]);
 }
 
-size_t NFA::Impl::FindLongestMatchImpl(std::string_view strView)
+void NFA::Impl::WalkEpsilon(SparseSet& threads, StateId state, StateList& stack) const
 {
-    ResetCurrentStates();
+    // Every state enters the stack at most once, so the stack never grows beyond the reserved size.
+    if (!threads.Insert(state))
+        return;
 
-    size_t result = 0;
-    size_t current = 0;
+    stack.push_back(state);
 
-    for (auto& ch : strView)
+    while (!stack.empty())
     {
-        ReadCharacter(ch);
+        auto top = stack.back();
+        stack.pop_back();
 
-        if (IsInFailedState())
-            return result;
-
-        ++current;
-
-        if (IsInFinalState())
+        for (auto idx = epsilonOffsets_[top]; idx < epsilonOffsets_[top + 1]; ++idx)
         {
-            result += current;
-            current = 0;
+            if (threads.Insert(epsilon_[idx]))
+                stack.push_back(epsilon_[idx]);
         }
     }
-
-    return result;
 }
 
-StatePtrSet NFA::Impl::AllPossibleCurrentStates(StatePtrSet&& states) const
+void NFA::Impl::Prepare()
 {
-    auto currStates = std::move(states);
-    auto freeMoveStates = NextFreeMoveStates(currStates);
+    if (isPrepared_.load(std::memory_order_acquire))
+        return;
 
-    if (std::ranges::includes(currStates, freeMoveStates))
-    {
-        return currStates;
-    }
+    std::lock_guard lock(prepareMutex_);
 
-    currStates.merge(freeMoveStates);
+    if (isPrepared_.load(std::memory_order_relaxed))
+        return;
 
-    auto result = AllPossibleCurrentStates(std::move(currStates));
-    return result;
+    Compact();
+
+    if (closureStates_ != size_)
+        ComputeClosures();
+
+    isPrepared_.store(true, std::memory_order_release);
 }
 
-StatePtrSet NFA::Impl::NextFreeMoveStates(const StatePtrSet& states) const
+void NFA::Impl::Invalidate() noexcept
 {
-    return NextStates(states, kEpsilon);
+    isPrepared_.store(false, std::memory_order_relaxed);
+}
+
+void NFA::Impl::Compact()
+{
+    // Counting sort of the pending transitions by their source state, merged with the already compacted ones.
+    auto merge = [this]<typename T>(std::vector<T>& values, std::vector<uint32_t>& offsets, auto& pending)
+    {
+        if (pending.empty())
+            return;
+
+        std::vector<uint32_t> newOffsets(size_ + 1, 0);
+
+        for (StateId state = 0; state < size_; ++state)
+            newOffsets[state + 1] = offsets[state + 1] - offsets[state];
+
+        for (auto& [from, value] : pending)
+            ++newOffsets[from + 1];
+
+        for (StateId state = 0; state < size_; ++state)
+            newOffsets[state + 1] += newOffsets[state];
+
+        std::vector<T> newValues(newOffsets.back());
+        auto cursor = newOffsets;
+
+        for (StateId state = 0; state < size_; ++state)
+        {
+            for (auto idx = offsets[state]; idx < offsets[state + 1]; ++idx)
+                newValues[cursor[state]++] = values[idx];
+        }
+
+        for (auto& [from, value] : pending)
+            newValues[cursor[from]++] = value;
+
+        values = std::move(newValues);
+        offsets = std::move(newOffsets);
+        pending.clear();
+    };
+
+    if (!pendingEpsilon_.empty())
+        closureStates_ = kStale;
+
+    merge(transitions_, transitionOffsets_, pendingTransitions_);
+    merge(epsilon_, epsilonOffsets_, pendingEpsilon_);
 }
 
-StatePtrSet NFA::Impl::NextStates(const StatePtrSet& curr_states, char symbol) const
+void NFA::Impl::ComputeClosures()
 {
-    StatePtrSet next_states;
+    closureStates_ = size_;
+    hasClosures_ = false;
+    closures_.clear();
+    closureOffsets_.assign(1, 0);
+
+    SparseSet closure(size_);
+    StateList stack;
+    stack.reserve(size_);
 
-    for (auto& state_ptr : curr_states)
+    for (StateId state = 0; state < size_; ++state)
     {
-        auto& states = (*state_ptr)[symbol];
-        next_states.insert(states.begin(), states.end());
+        closure.Clear();
+        WalkEpsilon(closure, state, stack);
+
+        if (closures_.size() + closure.Size() > MaxClosureEntries())
+        {
+            closures_.clear();
+            closureOffsets_.assign(1, 0);
+            return;
+        }
+
+        auto first = closures_.size();
+
+        closures_.insert(closures_.end(), closure.begin(), closure.end());
+        std::sort(closures_.begin() + static_cast<ptrdiff_t>(first), closures_.end());
+        closureOffsets_.push_back(static_cast<uint32_t>(closures_.size()));
     }
 
-    return next_states;
+    hasClosures_ = true;
+}
+
+void NFA::Impl::CheckState(Index idx) const
+{
+    if (size_ <= idx)
+        throw std::invalid_argument("No state with the index of " + std::to_string(idx));
 }
\ No newline at end of file
@@ -0,0 +1,352 @@
+#include "Optimizer.h"
+
+#include <algorithm>
+#include <cassert>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+using AstNodePtr = AstNode::AstNodePtr;
+using AstNodeList = AstNode::AstNodeList;
+using AstType = AstNode::AstType;
+
+const AstNodeList& Children(const AstNodePtr& node)
+{
+    if (node->Type() == AstType::Alternation)
+        return static_cast<const AlternationAst&>(*node).Patterns();
+
+    assert(node->Type() == AstType::Concatenation);
+    return static_cast<const ConcatenationAst&>(*node).Patterns();
+}
+
+const AstNodePtr& Inner(const AstNodePtr& node)
+{
+    switch (node->Type())
+    {
+    case AstType::Repetition:
+        return static_cast<const RepetitionAst&>(*node).Pattern();
+    case AstType::OneOrMore:
+        return static_cast<const OneOrMoreAst&>(*node).Pattern();
+    case AstType::CountedRepetition:
+        return static_cast<const CountedRepetitionAst&>(*node).Pattern();
+    case AstType::Capture:
+        return static_cast<const CaptureAst&>(*node).Pattern();
+    default:
+        assert(node->Type() == AstType::Optional);
+        return static_cast<const OptionalAst&>(*node).Pattern();
+    }
+}
+
+bool IsClosure(AstType type)
+{
+    return type == AstType::Repetition || type == AstType::OneOrMore || type == AstType::Optional;
+}
+
+bool IsSingleChar(const AstNodePtr& node)
+{
+    return node->Type() == AstType::Symbol || node->Type() == AstType::CharSet;
+}
+
+CharSet Symbols(const AstNodePtr& node)
+{
+    if (node->Type() == AstType::Symbol)
+        return CharClass::Single(static_cast<const SymbolAst&>(*node).Symbol());
+
+    return static_cast<const CharSetAst&>(*node).Symbols();
+}
+
+AstNodePtr MakeCharSet(const CharSet& symbols)
+{
+    if (symbols.count() != 1)
+        return CharSetAst::Make(symbols);
+
+    size_t symbol = 0;
+    while (!symbols.test(symbol))
+        ++symbol;
+
+    return SymbolAst::Make(static_cast<char>(symbol));
+}
+
+// Items of the node read as a sequence: the operands of a concatenation, nothing for the empty node.
+AstNodeList Sequence(const AstNodePtr& node)
+{
+    if (node->Type() == AstType::Concatenation)
+        return Children(node);
+
+    if (node->Type() == AstType::Empty)
+        return {};
+
+    return { node };
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool Optimizer::Equals(const AstNodePtr& lhs, const AstNodePtr& rhs)
+{
+    if (lhs == rhs)
+        return true;
+
+    if (lhs->Type() != rhs->Type())
+        return false;
+
+    switch (lhs->Type())
+    {
+    case AstType::Empty:
+        return true;
+    case AstType::Symbol:
+    case AstType::CharSet:
+        return Symbols(lhs) == Symbols(rhs);
+    case AstType::Alternation:
+    case AstType::Concatenation:
+    {
+        const auto& patternsX = Children(lhs);
+        const auto& patternsY = Children(rhs);
+
+        return std::ranges::equal(patternsX, patternsY, Equals);
+    }
+    case AstType::CountedRepetition:
+    {
+        const auto& countedX = static_cast<const CountedRepetitionAst&>(*lhs);
+        const auto& countedY = static_cast<const CountedRepetitionAst&>(*rhs);
+
+        if (countedX.MinCount() != countedY.MinCount() || countedX.MaxCount() != countedY.MaxCount())
+            return false;
+
+        return Equals(countedX.Pattern(), countedY.Pattern());
+    }
+    default:
+        return Equals(Inner(lhs), Inner(rhs));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto Optimizer::Optimize(const AstNodePtr& node) -> AstNodePtr
+{
+    switch (node->Type())
+    {
+    case AstType::Empty:
+    case AstType::Symbol:
+        return node;
+    case AstType::CharSet:
+        return MakeCharSet(Symbols(node));
+    case AstType::Alternation:
+    case AstType::Concatenation:
+    {
+        AstNodeList patterns;
+        patterns.reserve(Children(node).size());
+
+        for (const auto& pattern : Children(node))
+            patterns.push_back(Optimize(pattern));
+
+        if (node->Type() == AstType::Alternation)
+            return MakeAlternation(patterns);
+
+        return MakeConcatenation(patterns);
+    }
+    case AstType::CountedRepetition:
+    {
+        const auto& counted = static_cast<const CountedRepetitionAst&>(*node);
+        return MakeCountedRepetition(Optimize(counted.Pattern()), counted.MinCount(), counted.MaxCount());
+    }
+    case AstType::Capture:
+        // Groups make no difference to the language, the submatches are extracted with the unoptimized tree.
+        return Optimize(Inner(node));
+    default:
+        return MakeClosure(node->Type(), Optimize(Inner(node)));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto Optimizer::MakeAlternation(const AstNodeList& patterns) -> AstNodePtr
+{
+    AstNodeList alternatives;
+    bool isNullable = false;
+
+    for (const auto& pattern : patterns)
+    {
+        const auto& nested = pattern->Type() == AstType::Alternation ? Children(pattern) : AstNodeList{ pattern };
+
+        for (const auto& alternative : nested)
+        {
+            if (alternative->Type() == AstType::Empty)
+            {
+                isNullable = true;
+                continue;
+            }
+
+            auto isEqual = [&](const AstNodePtr& other) { return Equals(alternative, other); };
+
+            if (std::ranges::none_of(alternatives, isEqual))
+                alternatives.push_back(alternative);
+        }
+    }
+
+    if (alternatives.empty())
+        return EmptyAst::Make();
+
+    alternatives = MergeCharSets(FactorPrefixes(alternatives));
+
+    auto result = alternatives.size() == 1 ? alternatives.front() : AlternationAst::Make(std::move(alternatives));
+
+    // An empty alternative only makes the rest optional.
+    if (isNullable)
+        return MakeClosure(AstType::Optional, result);
+
+    return result;
+}
+
+auto Optimizer::MakeConcatenation(const AstNodeList& patterns) -> AstNodePtr
+{
+    AstNodeList sequence;
+
+    for (const auto& pattern : patterns)
+    {
+        auto items = Sequence(pattern);
+        sequence.insert(sequence.end(), items.begin(), items.end());
+    }
+
+    if (sequence.empty())
+        return EmptyAst::Make();
+
+    if (sequence.size() == 1)
+        return sequence.front();
+
+    return ConcatenationAst::Make(std::move(sequence));
+}
+
+auto Optimizer::MakeClosure(AstType type, const AstNodePtr& pattern) -> AstNodePtr
+{
+    if (pattern->Type() == AstType::Empty)
+        return pattern;
+
+    if (IsClosure(pattern->Type()))
+    {
+        // (a*)*, (a+)* and (a?)* are all a*, and so are (a*)+, (a*)?, (a+)? and (a?)+.
+        if (pattern->Type() == type || pattern->Type() == AstType::Repetition)
+            return pattern;
+
+        return RepetitionAst::Make(Inner(pattern));
+    }
+
+    switch (type)
+    {
+    case AstType::Repetition:
+        return RepetitionAst::Make(pattern);
+    case AstType::OneOrMore:
+        return OneOrMoreAst::Make(pattern);
+    default:
+        assert(type == AstType::Optional);
+        return OptionalAst::Make(pattern);
+    }
+}
+
+auto Optimizer::MakeCountedRepetition(const AstNodePtr& pattern, size_t minCount, size_t maxCount) -> AstNodePtr
+{
+    if (pattern->Type() == AstType::Empty || maxCount == 0)
+        return EmptyAst::Make();
+
+    // (a*){m,n} is a* itself.
+    if (pattern->Type() == AstType::Repetition)
+        return pattern;
+
+    if (minCount == 1 && maxCount == 1)
+        return pattern;
+
+    if (minCount == 0 && maxCount == 1)
+        return MakeClosure(AstType::Optional, pattern);
+
+    if (minCount <= 1 && maxCount == Token::kUnbounded)
+        return MakeClosure(minCount == 0 ? AstType::Repetition : AstType::OneOrMore, pattern);
+
+    return CountedRepetitionAst::Make(pattern, minCount, maxCount);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto Optimizer::FactorPrefixes(const AstNodeList& alternatives) -> AstNodeList
+{
+    // Alternatives grouped by their first item, in the order the groups first appear.
+    std::vector<std::vector<AstNodeList>> groups;
+
+    for (const auto& alternative : alternatives)
+    {
+        auto sequence = Sequence(alternative);
+        assert(!sequence.empty());
+
+        auto isSameHead = [&](const std::vector<AstNodeList>& group) { return Equals(group[0][0], sequence[0]); };
+
+        if (auto group = std::ranges::find_if(groups, isSameHead); group != groups.end())
+            group->push_back(std::move(sequence));
+        else
+            groups.push_back({ std::move(sequence) });
+    }
+
+    if (groups.size() == alternatives.size())
+        return alternatives;
+
+    AstNodeList result;
+
+    for (const auto& group : groups)
+    {
+        if (group.size() == 1)
+        {
+            result.push_back(MakeConcatenation(group[0]));
+            continue;
+        }
+
+        size_t prefixLength = 1;
+
+        auto isSharedItem = [&](const AstNodeList& sequence)
+        {
+            return prefixLength < sequence.size() && Equals(sequence[prefixLength], group[0][prefixLength]);
+        };
+
+        while (std::ranges::all_of(group, isSharedItem))
+            ++prefixLength;
+
+        AstNodeList suffixes;
+
+        for (const auto& sequence : group)
+            suffixes.push_back(MakeConcatenation({ sequence.begin() + prefixLength, sequence.end() }));
+
+        AstNodeList factored(group[0].begin(), group[0].begin() + prefixLength);
+        factored.push_back(MakeAlternation(suffixes));
+
+        result.push_back(MakeConcatenation(factored));
+    }
+
+    return result;
+}
+
+auto Optimizer::MergeCharSets(const AstNodeList& alternatives) -> AstNodeList
+{
+    if (std::ranges::count_if(alternatives, IsSingleChar) < 2)
+        return alternatives;
+
+    AstNodeList result;
+    CharSet symbols;
+    size_t position = 0;
+
+    for (const auto& alternative : alternatives)
+    {
+        if (!IsSingleChar(alternative))
+        {
+            result.push_back(alternative);
+            continue;
+        }
+
+        if (symbols.none())
+            position = result.size();
+
+        symbols |= Symbols(alternative);
+    }
+
+    result.insert(result.begin() + position, MakeCharSet(symbols));
+    return result;
+}
\ No newline at end of file
@@ -2,6 +2,7 @@
 #include "Ast.h"
 
 #include <cassert>
+#include <stdexcept>
 
 using namespace Regex;
 
@@ -15,16 +16,46 @@ auto EmptyNode::ConvertToAst() const -> AstNodePtr
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-// <Symbol> = <NonMetaChar> | "\"<AnyChar>
+// <Symbol> = <NonMetaChar> | "\"<AnyChar> | <Class>
 // <MetaChar> = "?" | "*" | "+"
 // ---------------------------------------------------------------------------------------------------------------------
 
 auto SymbolNode::ConvertToAst() const -> AstNodePtr
 {
+    if (token_.IsClass())
+        return CharSetAst::Make(token_.Class());
+
     auto reNode = SymbolAst::Make(token_.Symbol());
     return reNode;
 }
 
+// ---------------------------------------------------------------------------------------------------------------------
+// <Counter> = "{"<Min>"}" | "{"<Min>",}" | "{"<Min>","<Max>"}"
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto CounterNode::ConvertToAst() const -> AstNodePtr
+{
+    assert(false && "A counter converts together with its atom");
+    return EmptyAst::Make();
+}
+
+auto CounterNode::Apply(AstNodePtr atom) const -> AstNodePtr
+{
+    auto result = CountedRepetitionAst::Make(std::move(atom), token_.MinCount(), token_.MaxCount());
+
+    // The Scanner checks every count on its own, nested counters multiply.
+    if (auto size = result->ExpandedSize(); size > maxRepeatCount_)
+    {
+        auto message = std::format(
+            "Error: Repetition {} expands to {} symbols, exceeding the limit of {}.",
+            result->ToString(), size, maxRepeatCount_);
+
+        throw std::runtime_error(message);
+    }
+
+    return result;
+}
+
 // ---------------------------------------------------------------------------------------------------------------------
 // <Atom> = <Symbol> | "("<Expr>")"
 // ---------------------------------------------------------------------------------------------------------------------
@@ -44,14 +75,14 @@ auto AtomNode::ConvertToAst() const -> AstNodePtr
 
         assert(closeParen->ToString() == ")");
 
-        return expr;
+        return CaptureAst::Make(std::move(expr), group_);
     }
 
     return symbol;
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-// <Factor> = <Atom> | <Atom><MetaChar>
+// <Factor> = <Atom> | <Atom><MetaChar> | <Atom><Counter>
 // ---------------------------------------------------------------------------------------------------------------------
 
 auto FactorNode::ConvertToAst() const -> AstNodePtr
@@ -66,6 +97,11 @@ auto FactorNode::ConvertToAst() const -> AstNodePtr
         return atom;
     }
 
+    if (children_[1]->Type() == NodeType::Counter)
+    {
+        return static_cast<const CounterNode&>(*children_[1]).Apply(atom);
+    }
+
     // MetaChar
     auto symbol = children_[1]->ConvertToAst();
 
@@ -6,10 +6,11 @@ using namespace Regex;
 // ---------------------------------------------------------------------------------------------------------------------
 // <expr> ::= <term> | <term>'|'<expr>
 // <term> ::= <factor> | <factor><term>
-// <factor> ::= <atom> | <atom><meta-char>
+// <factor> ::= <atom> | <atom><meta-char> | <atom><counter>
 // <atom> ::= <symbol> | '('<expr>')'
-// <symbol> ::= <any-char-except-meta> | '\'<any-char>
+// <symbol> ::= <any-char-except-meta> | '\'<any-char> | <class>
 // <meta-char> ::= '?' | '*' | '+'
+// <counter> ::= '{'<min>'}' | '{'<min>',}' | '{'<min>','<max>'}'
 // ---------------------------------------------------------------------------------------------------------------------
 
 auto Parser::Parse() -> NodePtr
@@ -87,7 +88,7 @@ auto Parser::Term() -> NodePtr
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-// <factor> ::= <atom> | <atom><meta-char>
+// <factor> ::= <atom> | <atom><meta-char> | <atom><counter>
 // ---------------------------------------------------------------------------------------------------------------------
 
 auto Parser::Factor() -> NodePtr
@@ -95,6 +96,18 @@ auto Parser::Factor() -> NodePtr
     auto atom = Atom();
     auto token = PeekNext();
 
+    if (token.IsCounter())
+    {
+        Advance();
+
+        NodeList children = {
+            atom,
+            CounterNode::Make(token, maxRepeatCount_)
+        };
+
+        return FactorNode::Make(std::move(children));
+    }
+
     if (!token.IsMetaChar())
     {
         return FactorNode::Make(std::move(atom));
@@ -123,6 +136,9 @@ auto Parser::Atom() -> NodePtr
         return AtomNode::Make(symbol);
     }
 
+    // Groups are numbered by their opening bracket, before the groups nested in them.
+    auto group = ++groupCount_;
+
     Advance();
     auto expr = Expr();
     Advance();
@@ -138,11 +154,11 @@ auto Parser::Atom() -> NodePtr
         SymbolNode::Make(')')
     };
 
-    return AtomNode::Make(std::move(children));
+    return AtomNode::Make(std::move(children), group);
 }
 
 // ---------------------------------------------------------------------------------------------------------------------
-// <symbol> ::= <any-char-except-meta> | '\'<any-char>
+// <symbol> ::= <any-char-except-meta> | '\'<any-char> | <class>
 // <meta-char> ::= '?' | '*' | '+'
 // ---------------------------------------------------------------------------------------------------------------------
 
@@ -155,6 +171,11 @@ auto Parser::Symbol() -> NodePtr
         throw std::runtime_error(ErrorMsg("meta char"));
     }
 
+    if (token.IsCounter())
+    {
+        throw std::runtime_error(ErrorMsg("counter"));
+    }
+
     auto symbolNode = SymbolNode::Make(token);
     return symbolNode;
 }
@@ -0,0 +1,95 @@
+#include "PatternCache.h"
+#include "RegExp.h"
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+PatternCache::PatternCache(size_t capacity)
+    : capacity_(capacity)
+{}
+
+auto PatternCache::Get(std::string_view pattern) -> RegExpPtr
+{
+    {
+        std::lock_guard lock(mutex_);
+
+        if (auto it = index_.find(pattern); it != index_.end())
+        {
+            ++stats_.hits;
+            entries_.splice(entries_.begin(), entries_, it->second);
+
+            return it->second->second;
+        }
+
+        ++stats_.misses;
+    }
+
+    // Compiled without holding the lock, so that other patterns can be looked up meanwhile.
+    auto regexp = std::make_shared<const RegExp>(pattern);
+
+    std::lock_guard lock(mutex_);
+
+    if (auto it = index_.find(pattern); it != index_.end())
+        return it->second->second;
+
+    if (capacity_ == 0)
+        return regexp;
+
+    entries_.emplace_front(std::string(pattern), regexp);
+    index_.emplace(entries_.front().first, entries_.begin());
+
+    Evict();
+    return regexp;
+}
+
+void PatternCache::Clear()
+{
+    std::lock_guard lock(mutex_);
+
+    index_.clear();
+    entries_.clear();
+    stats_ = {};
+}
+
+void PatternCache::SetCapacity(size_t capacity)
+{
+    std::lock_guard lock(mutex_);
+
+    capacity_ = capacity;
+    Evict();
+}
+
+size_t PatternCache::Capacity() const
+{
+    std::lock_guard lock(mutex_);
+    return capacity_;
+}
+
+auto PatternCache::GetStats() const -> Stats
+{
+    std::lock_guard lock(mutex_);
+
+    auto stats = stats_;
+    stats.size = entries_.size();
+
+    return stats;
+}
+
+PatternCache& PatternCache::Instance()
+{
+    static PatternCache cache;
+    return cache;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void PatternCache::Evict()
+{
+    while (entries_.size() > capacity_)
+    {
+        index_.erase(entries_.back().first);
+        entries_.pop_back();
+        ++stats_.evictions;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,370 @@
+#include "PikeVM.h"
+#include "Ast.h"
+
+#include <algorithm>
+#include <bit>
+#include <cassert>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+namespace
+{
+using OpCode = CaptureProgram::OpCode;
+
+void SaveSlots(std::span<size_t> slots, uint64_t saves, size_t pos)
+{
+    for (; saves != 0; saves &= saves - 1)
+        slots[std::countr_zero(saves)] = pos;
+}
+} // namespace
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+CaptureProgram::CaptureProgram(const AstNode::AstNodePtr& root, size_t groupCount)
+    : groupCount_(groupCount)
+{
+    auto match = Emit(OpCode::Match, 0);
+    auto end = Emit(OpCode::Save, match, 1);
+
+    start_ = Emit(OpCode::Save, Compile(root, end), 0);
+}
+
+uint32_t CaptureProgram::Compile(const AstNode::AstNodePtr& node, uint32_t next)
+{
+    using AstType = AstNode::AstType;
+
+    switch (node->Type())
+    {
+    case AstType::Empty:
+        return next;
+    case AstType::Symbol:
+        charSets_.push_back(CharClass::Single(static_cast<const SymbolAst&>(*node).Symbol()));
+        return Emit(OpCode::Byte, next, static_cast<uint32_t>(charSets_.size() - 1));
+    case AstType::CharSet:
+        charSets_.push_back(static_cast<const CharSetAst&>(*node).Symbols());
+        return Emit(OpCode::Byte, next, static_cast<uint32_t>(charSets_.size() - 1));
+    case AstType::Alternation:
+    {
+        const auto& patterns = static_cast<const AlternationAst&>(*node).Patterns();
+
+        // One split per alternative but the last, each giving priority to its alternative over the later ones.
+        auto result = Compile(patterns.back(), next);
+
+        for (size_t i = patterns.size() - 1; i-- > 0;)
+            result = Emit(OpCode::Split, Compile(patterns[i], next), result);
+
+        return result;
+    }
+    case AstType::Concatenation:
+    {
+        const auto& patterns = static_cast<const ConcatenationAst&>(*node).Patterns();
+
+        for (auto it = patterns.rbegin(); it != patterns.rend(); ++it)
+            next = Compile(*it, next);
+
+        return next;
+    }
+    case AstType::Repetition:
+        return CompileRepetition(static_cast<const RepetitionAst&>(*node).Pattern(), next);
+    case AstType::OneOrMore:
+    {
+        auto split = Emit(OpCode::Split, 0, next);
+        auto body = Compile(static_cast<const OneOrMoreAst&>(*node).Pattern(), split);
+
+        instructions_[split].next = body;
+        return body;
+    }
+    case AstType::Optional:
+        return Emit(OpCode::Split, Compile(static_cast<const OptionalAst&>(*node).Pattern(), next), next);
+    case AstType::CountedRepetition:
+    {
+        const auto& counted = static_cast<const CountedRepetitionAst&>(*node);
+
+        // Mandatory copies followed by nested optional ones, (x(x(x)?)?)?, or by a closure when unbounded.
+        auto tail = next;
+
+        if (counted.IsUnbounded())
+            tail = CompileRepetition(counted.Pattern(), next);
+
+        for (size_t i = counted.MinCount(); i < counted.MaxCount() && !counted.IsUnbounded(); ++i)
+            tail = Emit(OpCode::Split, Compile(counted.Pattern(), tail), next);
+
+        for (size_t i = 0; i < counted.MinCount(); ++i)
+            tail = Compile(counted.Pattern(), tail);
+
+        return tail;
+    }
+    case AstType::Capture:
+    {
+        const auto& capture = static_cast<const CaptureAst&>(*node);
+        auto slot = static_cast<uint32_t>(2 * capture.Group());
+
+        assert(capture.Group() <= groupCount_);
+
+        auto close = Emit(OpCode::Save, next, slot + 1);
+        return Emit(OpCode::Save, Compile(capture.Pattern(), close), slot);
+    }
+    }
+
+    assert(false && "Invalid AST node");
+    return next;
+}
+
+uint32_t CaptureProgram::CompileRepetition(const AstNode::AstNodePtr& pattern, uint32_t next)
+{
+    auto split = Emit(OpCode::Split, 0, next);
+    auto body = Compile(pattern, split);
+
+    instructions_[split].next = body;
+    return split;
+}
+
+uint32_t CaptureProgram::Emit(OpCode opCode, uint32_t next, uint32_t arg)
+{
+    instructions_.push_back({ opCode, next, arg });
+    return static_cast<uint32_t>(instructions_.size() - 1);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool PikeVM::Match(std::string_view str, std::span<size_t> slots, Scratch& scratch) const
+{
+    auto slotCount = program_.SlotCount();
+    assert(slots.size() == slotCount);
+
+    if (scratch.current_.Capacity() < program_.Size())
+    {
+        scratch.current_.Resize(program_.Size());
+        scratch.next_.Resize(program_.Size());
+    }
+
+    if (scratch.currentSlots_.size() < program_.Size() * slotCount)
+    {
+        scratch.currentSlots_.resize(program_.Size() * slotCount);
+        scratch.nextSlots_.resize(program_.Size() * slotCount);
+    }
+
+    scratch.current_.Clear();
+    scratch.slots_.assign(slotCount, CaptureProgram::kNoPosition);
+
+    AddThread(scratch.current_, scratch.currentSlots_, program_.Start(), 0, scratch);
+
+    for (size_t pos = 0; !scratch.current_.Empty(); ++pos)
+    {
+        scratch.next_.Clear();
+
+        for (auto pc : scratch.current_)
+        {
+            const auto& instruction = program_.At(pc);
+            auto threadSlots = std::span(scratch.currentSlots_).subspan(pc * slotCount, slotCount);
+
+            if (instruction.opCode == OpCode::Match)
+            {
+                // Only a match of the whole string counts, and the threads after this one have a lower priority.
+                if (pos == str.size())
+                {
+                    std::ranges::copy(threadSlots, slots.begin());
+                    return true;
+                }
+
+                continue;
+            }
+
+            // The list also holds the splits and saves the threads went through on their way.
+            if (instruction.opCode != OpCode::Byte)
+                continue;
+
+            if (pos < str.size() && program_.CharSetAt(instruction.arg).test(static_cast<uint8_t>(str[pos])))
+            {
+                std::ranges::copy(threadSlots, scratch.slots_.begin());
+                AddThread(scratch.next_, scratch.nextSlots_, instruction.next, pos + 1, scratch);
+            }
+        }
+
+        if (pos == str.size())
+            break;
+
+        std::swap(scratch.current_, scratch.next_);
+        std::swap(scratch.currentSlots_, scratch.nextSlots_);
+    }
+
+    return false;
+}
+
+void PikeVM::AddThread(SparseSet& list, std::vector<size_t>& listSlots, uint32_t pc, size_t pos, Scratch& scratch) const
+{
+    auto slotCount = program_.SlotCount();
+    auto& slots = scratch.slots_;
+    auto& stack = scratch.stack_;
+
+    stack.assign(1, { pc });
+
+    while (!stack.empty())
+    {
+        auto job = stack.back();
+        stack.pop_back();
+
+        if (job.slot != Scratch::kNoSlot)
+        {
+            slots[job.slot] = job.position;
+            continue;
+        }
+
+        // Follows the path of the highest priority first. The other targets of splits wait on the stack, each above
+        // the jobs restoring the slots saved before it was reached.
+        for (pc = job.pc; list.Insert(pc);)
+        {
+            const auto& instruction = program_.At(pc);
+
+            if (instruction.opCode == OpCode::Split)
+            {
+                stack.push_back({ instruction.arg });
+                pc = instruction.next;
+            }
+            else if (instruction.opCode == OpCode::Save)
+            {
+                stack.push_back({ 0, instruction.arg, slots[instruction.arg] });
+                slots[instruction.arg] = pos;
+                pc = instruction.next;
+            }
+            else
+            {
+                std::ranges::copy(slots, listSlots.data() + pc * slotCount);
+                break;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto OnePassMatcher::Make(const CaptureProgram& program, size_t maxStates) -> std::optional<OnePassMatcher>
+{
+    if (program.GroupCount() > kMaxGroups)
+        return std::nullopt;
+
+    OnePassMatcher result;
+
+    result.byteClasses_ = ByteClasses::FromSets(program.CharSets());
+    result.stride_ = result.byteClasses_.Count();
+    result.slotCount_ = program.SlotCount();
+
+    // The states are the start of the program and the instructions following a Byte, numbered as they are reached.
+    std::vector<StateId> stateOf(program.Size(), kNone);
+    std::vector<uint32_t> statePcs;
+
+    auto stateAt = [&](uint32_t pc)
+    {
+        if (stateOf[pc] == kNone)
+        {
+            stateOf[pc] = static_cast<StateId>(statePcs.size());
+            statePcs.push_back(pc);
+        }
+
+        return stateOf[pc];
+    };
+
+    // The slots saved on the way to every instruction of the closure walked last, and the state it belongs to.
+    std::vector<uint64_t> savesAt(program.Size(), 0);
+    std::vector<StateId> visitedIn(program.Size(), kNone);
+    std::vector<std::pair<uint32_t, uint64_t>> stack;
+
+    stateAt(program.Start());
+
+    for (StateId state = 0; state < statePcs.size(); ++state)
+    {
+        result.table_.resize((state + 1) * result.stride_);
+        result.finals_.emplace_back();
+
+        stack.assign(1, { statePcs[state], 0 });
+
+        while (!stack.empty())
+        {
+            auto [pc, saves] = stack.back();
+            stack.pop_back();
+
+            // An instruction reached on two paths that save different slots makes the submatches ambiguous.
+            if (visitedIn[pc] == state)
+            {
+                if (savesAt[pc] != saves)
+                    return std::nullopt;
+
+                continue;
+            }
+
+            visitedIn[pc] = state;
+            savesAt[pc] = saves;
+
+            const auto& instruction = program.At(pc);
+
+            switch (instruction.opCode)
+            {
+            case OpCode::Split:
+                stack.emplace_back(instruction.next, saves);
+                stack.emplace_back(instruction.arg, saves);
+                break;
+            case OpCode::Save:
+                stack.emplace_back(instruction.next, saves | (uint64_t{ 1 } << instruction.arg));
+                break;
+            case OpCode::Match:
+                result.finals_[state] = { state, saves };
+                break;
+            case OpCode::Byte:
+            {
+                Action action = { stateAt(instruction.next), saves };
+                const auto& symbols = program.CharSetAt(instruction.arg);
+
+                for (size_t cls = 0; cls < result.stride_; ++cls)
+                {
+                    if (!symbols.test(result.byteClasses_.Representative(cls)))
+                        continue;
+
+                    // Two ways on with the same byte are only fine if they lead to the same place saving the same.
+                    auto& entry = result.table_[state * result.stride_ + cls];
+
+                    if (entry.next != kNone && (entry.next != action.next || entry.saves != action.saves))
+                        return std::nullopt;
+
+                    entry = action;
+                }
+
+                break;
+            }
+            }
+        }
+
+        if (statePcs.size() > maxStates)
+            return std::nullopt;
+    }
+
+    return result;
+}
+
+bool OnePassMatcher::Match(std::string_view str, std::span<size_t> slots) const
+{
+    assert(slots.size() == slotCount_);
+    std::ranges::fill(slots, CaptureProgram::kNoPosition);
+
+    StateId state = 0;
+
+    for (size_t pos = 0; pos < str.size(); ++pos)
+    {
+        const auto& action = table_[state * stride_ + byteClasses_[static_cast<uint8_t>(str[pos])]];
+
+        if (action.next == kNone)
+            return false;
+
+        SaveSlots(slots, action.saves, pos);
+        state = action.next;
+    }
+
+    const auto& end = finals_[state];
+
+    if (end.next == kNone)
+        return false;
+
+    SaveSlots(slots, end.saves, str.size());
+    return true;
+}
\ No newline at end of file
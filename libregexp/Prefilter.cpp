@@ -0,0 +1,173 @@
+#include "Prefilter.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <set>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+size_t Prefilter::Find(std::string_view str, size_t pos) const
+{
+    if (pos >= str.size())
+        return std::string_view::npos;
+
+    switch (kind_)
+    {
+        case Kind::Literal:
+            return FindLiteral(str, pos);
+        case Kind::FewBytes:
+            return FindFewBytes(str, pos);
+        case Kind::ByteSet:
+            return FindInSet(str, pos);
+        default:
+            return pos;
+    }
+}
+
+auto Prefilter::GetKind() const noexcept -> Kind
+{
+    return kind_;
+}
+
+const std::string& Prefilter::Prefix() const noexcept
+{
+    return prefix_;
+}
+
+Prefilter Prefilter::Make(const Glushkov& glushkov)
+{
+    Prefilter result;
+
+    for (auto position : glushkov.Root().first)
+        result.firstBytes_ |= glushkov.Symbols(position);
+
+    // Follows the positions as long as there is exactly one way to go on, and it reads exactly one byte.
+    auto* next = &glushkov.Root().first;
+    std::set<uint32_t> visited;
+
+    while (next->size() == 1)
+    {
+        auto position = next->front();
+        auto& symbols = glushkov.Symbols(position);
+
+        if (symbols.count() != 1 || !visited.insert(position).second)
+            break;
+
+        for (size_t byte = 0; byte < symbols.size(); ++byte)
+        {
+            if (symbols[byte])
+                result.prefix_ += static_cast<char>(byte);
+        }
+
+        if (std::ranges::find(glushkov.Root().last, position) != glushkov.Root().last.end())
+            break;
+
+        next = &glushkov.Follow(position);
+    }
+
+    auto count = result.firstBytes_.count();
+
+    if (result.prefix_.size() > 1)
+    {
+        result.kind_ = Kind::Literal;
+    }
+    else if (count > 0 && count <= kMaxFewBytes)
+    {
+        result.kind_ = Kind::FewBytes;
+
+        for (size_t byte = 0; byte < result.firstBytes_.size(); ++byte)
+        {
+            if (result.firstBytes_[byte])
+                result.bytes_.push_back(static_cast<char>(byte));
+        }
+    }
+    else if (count > 0 && count < result.firstBytes_.size())
+    {
+        result.kind_ = Kind::ByteSet;
+    }
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+size_t Prefilter::FindLiteral(std::string_view str, size_t pos) const
+{
+    auto length = prefix_.size();
+
+#if defined(__SSE2__)
+    // Candidates are the offsets where both the first and the last byte of the prefix match, only they are compared
+    // in full.
+    const auto first = _mm_set1_epi8(prefix_.front());
+    const auto last = _mm_set1_epi8(prefix_.back());
+
+    for (; pos + length - 1 + 16 <= str.size(); pos += 16)
+    {
+        auto blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+        auto blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos + length - 1));
+
+        auto eq = _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last));
+        auto mask = static_cast<uint32_t>(_mm_movemask_epi8(eq));
+
+        while (mask != 0)
+        {
+            auto offset = pos + std::countr_zero(mask);
+
+            if (std::memcmp(str.data() + offset + 1, prefix_.data() + 1, length - 2) == 0)
+                return offset;
+
+            mask &= mask - 1;
+        }
+    }
+#endif
+
+    return str.find(prefix_, pos);
+}
+
+size_t Prefilter::FindFewBytes(std::string_view str, size_t pos) const
+{
+    if (bytes_.size() == 1)
+    {
+        auto* found = std::memchr(str.data() + pos, bytes_[0], str.size() - pos);
+        return found ? static_cast<const char*>(found) - str.data() : std::string_view::npos;
+    }
+
+#if defined(__SSE2__)
+    __m128i needles[kMaxFewBytes];
+
+    for (size_t idx = 0; idx < bytes_.size(); ++idx)
+        needles[idx] = _mm_set1_epi8(bytes_[idx]);
+
+    for (; pos + 16 <= str.size(); pos += 16)
+    {
+        auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str.data() + pos));
+        auto eq = _mm_setzero_si128();
+
+        for (size_t idx = 0; idx < bytes_.size(); ++idx)
+            eq = _mm_or_si128(eq, _mm_cmpeq_epi8(block, needles[idx]));
+
+        if (auto mask = static_cast<uint32_t>(_mm_movemask_epi8(eq)); mask != 0)
+            return pos + std::countr_zero(mask);
+    }
+#endif
+
+    return FindInSet(str, pos);
+}
+
+size_t Prefilter::FindInSet(std::string_view str, size_t pos) const
+{
+    for (; pos < str.size(); ++pos)
+    {
+        if (firstBytes_[static_cast<uint8_t>(str[pos])])
+            return pos;
+    }
+
+    return std::string_view::npos;
+}
\ No newline at end of file
@@ -0,0 +1,612 @@
+#include "RegExp.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <format>
+#include <iterator>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+auto RegExp::Compile(std::string_view pattern) -> PatternCache::RegExpPtr
+{
+    return PatternCache::Instance().Get(pattern);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+RegExp::Scratch::Scratch(const RegExp& regexp)
+    : id_(regexp.id_)
+{
+    if (regexp.dfa_)
+        dfa_.emplace(*regexp.dfa_);
+
+    if (regexp.leftmostDfa_)
+    {
+        leftmostDfa_.emplace(*regexp.leftmostDfa_);
+        reverseDfa_.emplace(*regexp.reverseDfa_);
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+bool RegExp::Matches(const std::string& str) const
+{
+    if (fullDfa_)
+        return fullDfa_->Accepts(str);
+
+    if (bitParallel_)
+        return bitParallel_->Accepts(str);
+
+    return Matches(str, LocalScratch());
+}
+
+bool RegExp::Matches(const std::string& str, Scratch& scratch) const
+{
+    if (fullDfa_)
+        return fullDfa_->Accepts(str);
+
+    if (bitParallel_)
+        return bitParallel_->Accepts(str);
+
+    auto& bound = Bind(scratch);
+
+    if (auto accepts = bound.dfa_->Accepts(str); accepts.has_value())
+        return *accepts;
+
+    return nfa_.Accepts(str, bound.nfa_);
+}
+
+auto RegExp::FindMatches(const std::string& str) const -> MatchList
+{
+    return FindMatchesInRange(str, 0, str.size(), nullptr);
+}
+
+std::string RegExp::LongestMatch(const std::string& str, size_t pos) const
+{
+    std::string_view strView = str;
+    strView = strView.substr(pos);
+
+    if (size_t longest = LongestMatchLength(strView); longest > 0)
+    {
+        return str.substr(pos, longest);
+    }
+
+    return {};
+}
+
+auto RegExp::FindMatchRanges(std::string_view str) const -> MatchRangeList
+{
+    MatchRangeList result;
+
+    ForEachMatch(str, 0, str.size(), nullptr, [&result](size_t offset, size_t length)
+    {
+        result.push_back({offset, length});
+    });
+
+    return result;
+}
+
+auto RegExp::FindMatchRanges(std::string_view str, Scratch& scratch) const -> MatchRangeList
+{
+    MatchRangeList result;
+
+    ForEachMatch(str, 0, str.size(), &scratch, [&result](size_t offset, size_t length)
+    {
+        result.push_back({offset, length});
+    });
+
+    return result;
+}
+
+std::string_view RegExp::LongestMatchView(std::string_view str, size_t pos) const
+{
+    str = str.substr(pos);
+    return str.substr(0, LongestMatchLength(str));
+}
+
+auto RegExp::Search(std::string_view str) const -> MatchSequence
+{
+    return {MatchIterator(*this, str), std::default_sentinel};
+}
+
+auto RegExp::FindMatchesParallel(const std::string& str, size_t threadCount) const -> MatchList
+{
+    if (threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    threadCount = std::min(threadCount, str.size() / kMinParallelChunk);
+
+    if (threadCount <= 1)
+        return FindMatches(str);
+
+    std::vector<size_t> bounds;
+
+    for (size_t idx = 0; idx <= threadCount; ++idx)
+        bounds.push_back(str.size() * idx / threadCount);
+
+    std::vector<MatchList> chunks(threadCount);
+    std::vector<std::thread> threads;
+
+    for (size_t idx = 0; idx < threadCount; ++idx)
+    {
+        threads.emplace_back([this, &str, &bounds, &chunks, idx]
+        {
+            Scratch scratch(*this);
+            chunks[idx] = FindMatchesInRange(str, bounds[idx], bounds[idx + 1], &scratch);
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    // A chunk's search agrees with the sequential one from the first position where the sequential search tries to
+    // start a match and that is not inside one of the chunk's matches. Up to that position the sequential search is
+    // redone, one match at a time, starting from the end of the last match taken from the previous chunks.
+    MatchList result;
+    size_t pos = 0;
+
+    for (size_t idx = 0; idx < threadCount; ++idx)
+    {
+        auto& matches = chunks[idx];
+        auto end = bounds[idx + 1];
+        auto it = matches.begin();
+
+        while (pos < end)
+        {
+            while (it != matches.end() && it->first + it->second.size() <= pos)
+                ++it;
+
+            if (it == matches.end() || it->first >= pos)
+            {
+                std::move(it, matches.end(), std::back_inserter(result));
+                pos = result.empty() ? end : std::max(end, result.back().first + result.back().second.size());
+                break;
+            }
+
+            auto match = NextMatch(str, pos, end, nullptr);
+
+            if (!match.has_value())
+            {
+                pos = end;
+                break;
+            }
+
+            result.emplace_back(match->offset, std::string(str, match->offset, match->length));
+            pos = match->offset + match->length;
+        }
+    }
+
+    return result;
+}
+
+auto RegExp::FindMatchesInFile(const std::string& path) const -> MatchRangeList
+{
+    MappedFile file(path);
+    return FindMatchRanges(file.View());
+}
+
+void RegExp::FindMatchesInFile(const std::string& path, const MatchCallback& callback) const
+{
+    MappedFile file(path);
+    auto contents = file.View();
+
+    ForEachMatch(contents, 0, contents.size(), nullptr, callback);
+}
+
+void RegExp::Save(const std::string& path) const
+{
+    auto require = [this](std::optional<FullDFA> dfa)
+    {
+        if (!dfa.has_value())
+        {
+            auto message = std::format("Error: Pattern '{}' needs more than {} DFA states.", pattern_,
+                FullDFA::kDefaultMaxStates);
+            throw std::runtime_error(message);
+        }
+
+        return std::move(*dfa);
+    };
+
+    // Only a loaded RegExp lacks the NFA, and it has all of the DFAs.
+    AutomatonFile::Search search = {
+        fullLeftmostDfa_ ? *fullLeftmostDfa_ : require(FullDFA::MakeLeftmost(nfa_)),
+        fullReverseDfa_ ? *fullReverseDfa_ : require(FullDFA::Make(nfa_.Reverse())),
+        fullPrefixDfa_ ? *fullPrefixDfa_ : require(FullDFA::Make(nfa_.ReversePrefixes())),
+        prefilter_,
+        pikeVm_ ? std::optional(pikeVm_->Program()) : std::nullopt
+    };
+
+    auto fullDfa = fullDfa_ ? *fullDfa_ : require(FullDFA::Make(nfa_));
+
+    AutomatonFile::Write(path, AutomatonFile::Kind::RegExp, { pattern_ }, fullDfa, &search);
+}
+
+RegExp RegExp::Load(const std::string& path, AutomatonFile::Verify verify)
+{
+    auto contents = AutomatonFile::Read(path, AutomatonFile::Kind::RegExp, verify);
+
+    if (contents.patterns.size() != 1)
+        throw std::runtime_error(std::format("Error: Automaton file '{}' holds no single pattern.", path));
+
+    RegExp result;
+    auto& search = *contents.search;
+
+    result.pattern_ = std::move(contents.patterns.front());
+    result.id_ = NextId();
+    result.prefilter_ = std::move(search.prefilter);
+    result.fullPrefixDfa_ = std::make_shared<const FullDFA>(std::move(search.prefixDfa));
+
+    result.SetFullDfa(std::make_shared<const FullDFA>(std::move(contents.dfa)));
+    result.SetFullSearchDfas(std::make_shared<const FullDFA>(std::move(search.leftmostDfa)),
+        std::make_shared<const FullDFA>(std::move(search.reverseDfa)));
+
+    if (search.captures.has_value())
+        result.SetCaptures(std::move(*search.captures));
+
+    return result;
+}
+
+auto RegExp::FindCaptures(std::string_view str, size_t pos) const -> std::optional<CaptureList>
+{
+    return FindCaptures(str, pos, LocalScratch());
+}
+
+auto RegExp::FindCaptures(std::string_view str, size_t pos, Scratch& scratch) const -> std::optional<CaptureList>
+{
+    auto& bound = Bind(scratch);
+    auto match = NextMatch(str, pos, str.size(), &bound);
+
+    if (!match.has_value())
+        return std::nullopt;
+
+    return Captures(str, *match, bound);
+}
+
+auto RegExp::FindAllCaptures(std::string_view str) const -> std::vector<CaptureList>
+{
+    std::vector<CaptureList> result;
+
+    ForEachMatch(str, 0, str.size(), nullptr, [&](size_t offset, size_t length)
+    {
+        result.push_back(Captures(str, {offset, length}, LocalScratch()));
+    });
+
+    return result;
+}
+
+size_t RegExp::GroupCount() const noexcept
+{
+    return stats_.groups;
+}
+
+const std::string& RegExp::Pattern() const noexcept
+{
+    return pattern_;
+}
+
+auto RegExp::Stats() const noexcept -> const CompileStats&
+{
+    return stats_;
+}
+
+uint64_t RegExp::NextId()
+{
+    static std::atomic<uint64_t> nextId = 1;
+    return nextId.fetch_add(1, std::memory_order_relaxed);
+}
+
+auto RegExp::LocalScratch() const -> Scratch&
+{
+    thread_local std::array<Scratch, kScratchPoolSize> pool;
+    thread_local size_t victim = 0;
+
+    for (auto& scratch : pool)
+    {
+        if (scratch.id_ == id_)
+            return scratch;
+    }
+
+    auto& scratch = pool[victim++ % kScratchPoolSize];
+    scratch = Scratch(*this);
+
+    return scratch;
+}
+
+auto RegExp::Bind(Scratch& scratch) const -> Scratch&
+{
+    if (scratch.id_ != id_)
+        scratch = Scratch(*this);
+
+    return scratch;
+}
+
+void RegExp::SetCaptures(const AstNode::AstNodePtr& root, size_t groupCount)
+{
+    stats_.groups = groupCount;
+
+    // Without groups the match itself is all there is to capture.
+    if (groupCount != 0)
+        SetCaptures(CaptureProgram(root, groupCount));
+}
+
+void RegExp::SetCaptures(CaptureProgram program)
+{
+    stats_.groups = program.GroupCount();
+
+    if (auto onePass = OnePassMatcher::Make(program); onePass.has_value())
+    {
+        onePass_ = std::make_shared<const OnePassMatcher>(std::move(*onePass));
+        stats_.isOnePass = true;
+    }
+
+    pikeVm_ = std::make_shared<const PikeVM>(std::move(program));
+}
+
+auto RegExp::Captures(std::string_view str, const MatchRange& match, Scratch& scratch) const -> CaptureList
+{
+    CaptureList result(GroupCount() + 1);
+    result[0] = match;
+
+    if (!pikeVm_)
+        return result;
+
+    // The match is already known, the groups are found by matching its text alone.
+    auto text = match.Text(str);
+    auto& slots = scratch.slots_;
+
+    slots.resize(pikeVm_->Program().SlotCount());
+
+    // The match comes from another engine than the groups, the two disagreeing is a bug in one of them. Groups left
+    // out would read as groups that did not participate, so this does not fall back to them.
+    if (!(onePass_ ? onePass_->Match(text, slots) : pikeVm_->Match(text, slots, scratch.pikeVm_)))
+    {
+        auto message = std::format("Error: Pattern '{}' matches '{}' but its capture program does not.", pattern_, text);
+        throw std::logic_error(message);
+    }
+
+    for (size_t group = 1; group < result.size(); ++group)
+    {
+        auto begin = slots[2 * group];
+        auto end = slots[2 * group + 1];
+
+        if (begin != CaptureProgram::kNoPosition && end != CaptureProgram::kNoPosition)
+            result[group] = MatchRange{match.offset + begin, end - begin};
+    }
+
+    return result;
+}
+
+auto RegExp::FindMatchesInRange(const std::string& str, size_t from, size_t to, Scratch* scratch) const -> MatchList
+{
+    MatchList result;
+
+    ForEachMatch(str, from, to, scratch, [&result, &str](size_t offset, size_t length)
+    {
+        result.emplace_back(offset, std::string(str, offset, length));
+    });
+
+    return result;
+}
+
+template <typename Callback>
+void RegExp::ForEachMatch(std::string_view str, size_t from, size_t to, Scratch* scratch, Callback&& callback) const
+{
+    for (auto match = NextMatch(str, from, to, scratch); match.has_value(); match = NextMatch(str, from, to, scratch))
+    {
+        callback(match->offset, match->length);
+        from = match->offset + match->length;
+    }
+}
+
+auto RegExp::NextMatch(std::string_view str, size_t from, size_t to, Scratch* scratch) const -> std::optional<MatchRange>
+{
+    if (literals_)
+    {
+        auto match = literals_->Find(str, from, to);
+        return match.has_value() ? std::optional(MatchRange{match->offset, match->length}) : std::nullopt;
+    }
+
+    bool isOutOfBudget = false;
+
+    if (fullLeftmostDfa_)
+        return NextLeftmostMatch(str, from, to, *fullLeftmostDfa_, *fullReverseDfa_, isOutOfBudget);
+
+    if (leftmostDfa_)
+    {
+        auto& bound = scratch != nullptr ? Bind(*scratch) : LocalScratch();
+
+        if (auto match = NextLeftmostMatch(str, from, to, *bound.leftmostDfa_, *bound.reverseDfa_, isOutOfBudget);
+            !isOutOfBudget)
+        {
+            return match;
+        }
+
+        // The DFA caches ran out of their memory budget, fall back to trying one start position after another.
+    }
+
+    size_t startPos = from;
+
+    while (startPos < to)
+    {
+        // Jumps over the bytes no match can start with.
+        startPos = prefilter_.Find(str, startPos);
+
+        if (startPos == std::string_view::npos || startPos >= to)
+            break;
+
+        if (size_t longest = LongestMatchLength(str.substr(startPos), scratch); longest > 0)
+            return MatchRange{startPos, longest};
+
+        startPos += 1;
+    }
+
+    return std::nullopt;
+}
+
+template <typename ForwardDfa, typename ReverseDfa>
+auto RegExp::NextLeftmostMatch(std::string_view str, size_t from, size_t to, ForwardDfa& forwardDfa,
+    ReverseDfa& reverseDfa, bool& isOutOfBudget) const -> std::optional<MatchRange>
+{
+    // Only the lazy DFAs can run out of their budget.
+    constexpr bool isLazy = std::is_same_v<ForwardDfa, LeftmostDFA>;
+
+    auto& dfa = forwardDfa;
+    auto start = dfa.Start();
+    auto state = start;
+    size_t end = 0;
+
+    if constexpr (isLazy)
+        isOutOfBudget = start == LeftmostDFA::kUnknown;
+
+    for (size_t pos = from; pos < str.size() && !isOutOfBudget; ++pos)
+    {
+        // No match is under way, so the next one starts where the prefilter finds a candidate, if before the limit.
+        if (state == start)
+        {
+            pos = prefilter_.Find(str, pos);
+
+            if (pos == std::string_view::npos || pos >= to)
+                break;
+        }
+
+        state = dfa.Next(state, static_cast<uint8_t>(str[pos]));
+
+        if (state == ForwardDfa::kDead)
+            break;
+
+        if constexpr (isLazy)
+        {
+            if (state == LeftmostDFA::kUnknown)
+            {
+                isOutOfBudget = true;
+                break;
+            }
+        }
+
+        if (dfa.IsFinal(state))
+            end = pos + 1;
+    }
+
+    if (isOutOfBudget || end == 0)
+        return std::nullopt;
+
+    std::optional<size_t> length = reverseDfa.LongestMatchBackward(str.substr(from, end - from));
+
+    if (!length.has_value())
+    {
+        isOutOfBudget = true;
+        return std::nullopt;
+    }
+
+    // The leftmost match can still start at or after the limit when the groups started before it never match.
+    if (end - *length >= to)
+        return std::nullopt;
+
+    return MatchRange{end - *length, *length};
+}
+
+size_t RegExp::LongestMatchLength(std::string_view strView) const
+{
+    return LongestMatchLength(strView, nullptr);
+}
+
+size_t RegExp::LongestMatchLength(std::string_view strView, Scratch* scratch) const
+{
+    if (fullDfa_)
+        return fullDfa_->LongestMatch(strView);
+
+    if (bitParallel_)
+        return bitParallel_->LongestMatch(strView);
+
+    auto& bound = scratch != nullptr ? Bind(*scratch) : LocalScratch();
+
+    if (auto longest = bound.dfa_->LongestMatch(strView); longest.has_value())
+        return *longest;
+
+    // The DFA cache ran out of its memory budget, fall back to the NFA simulation.
+    return nfa_.LongestMatchLength(strView, bound.nfa_);
+}
+
+void RegExp::SetSearchDfas(DfaMode dfaMode)
+{
+    if (dfaMode == DfaMode::Full)
+    {
+        auto leftmostDfa = FullDFA::MakeLeftmost(nfa_);
+        auto reverseDfa = leftmostDfa.has_value() ? FullDFA::Make(nfa_.Reverse()) : std::nullopt;
+
+        if (reverseDfa.has_value())
+        {
+            SetFullSearchDfas(std::make_shared<const FullDFA>(std::move(*leftmostDfa)),
+                std::make_shared<const FullDFA>(std::move(*reverseDfa)));
+            return;
+        }
+    }
+
+    leftmostDfa_ = std::make_shared<LeftmostDFA>(nfa_, dfaMemoryBudget_);
+    reverseDfa_ = std::make_shared<LazyDFA>(nfa_.Reverse(), dfaMemoryBudget_);
+}
+
+void RegExp::SetFullSearchDfas(std::shared_ptr<const FullDFA> leftmostDfa, std::shared_ptr<const FullDFA> reverseDfa)
+{
+    fullLeftmostDfa_ = std::move(leftmostDfa);
+    fullReverseDfa_ = std::move(reverseDfa);
+
+    stats_.isFullSearchDfa = true;
+    stats_.searchDfaTableBytes = fullLeftmostDfa_->GetStats().tableBytes + fullReverseDfa_->GetStats().tableBytes;
+}
+
+void RegExp::SetFullDfa(std::shared_ptr<const FullDFA> fullDfa)
+{
+    fullDfa_ = std::move(fullDfa);
+
+    auto& dfaStats = fullDfa_->GetStats();
+
+    stats_.isFullDfa = true;
+    stats_.byteClasses = fullDfa_->GetByteClasses().Count();
+    stats_.dfaStates = dfaStats.subsetStates;
+    stats_.minimizedDfaStates = dfaStats.minimizedStates;
+    stats_.dfaTableBytes = dfaStats.tableBytes;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+RegExp::MatchIterator::MatchIterator(const RegExp& regexp, std::string_view str)
+    : regexp_(&regexp)
+    , str_(str)
+    , current_(regexp.NextMatch(str, 0, str.size(), nullptr))
+{}
+
+auto RegExp::MatchIterator::operator*() const noexcept -> const MatchRange&
+{
+    return *current_;
+}
+
+auto RegExp::MatchIterator::operator->() const noexcept -> const MatchRange*
+{
+    return &*current_;
+}
+
+auto RegExp::MatchIterator::operator++() -> MatchIterator&
+{
+    auto from = current_->offset + current_->length;
+    current_ = regexp_->NextMatch(str_, from, str_.size(), nullptr);
+
+    return *this;
+}
+
+void RegExp::MatchIterator::operator++(int)
+{
+    ++*this;
+}
+
+bool RegExp::MatchIterator::operator==(std::default_sentinel_t) const noexcept
+{
+    return !current_.has_value();
+}
\ No newline at end of file
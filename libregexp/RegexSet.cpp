@@ -0,0 +1,228 @@
+#include "RegexSet.h"
+#include "Optimizer.h"
+#include "Parser.h"
+
+#include <array>
+#include <atomic>
+#include <format>
+#include <stdexcept>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+RegexSet::Scratch::Scratch(const RegexSet& set)
+    : id_(set.id_)
+{
+    if (set.dfa_)
+        dfa_.emplace(*set.dfa_);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+RegexSet::RegexSet(const std::vector<std::string>& patterns, size_t dfaMemoryBudget, size_t maxRepeatCount)
+    : patterns_(patterns)
+{
+    std::vector<AstNode::AstNodePtr> nodes;
+    nodes.reserve(patterns.size());
+
+    for (auto& pattern : patterns)
+        nodes.push_back(Parse(pattern, maxRepeatCount));
+
+    Initialize(nodes, dfaMemoryBudget);
+}
+
+RegexSet::RegexSet(const std::vector<AstNode::AstNodePtr>& nodes, size_t dfaMemoryBudget)
+{
+    for (auto& node : nodes)
+        patterns_.push_back(node->ToString());
+
+    Initialize(nodes, dfaMemoryBudget);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+std::vector<size_t> RegexSet::Matches(std::string_view str) const
+{
+    return Matches(str, LocalScratch());
+}
+
+std::vector<size_t> RegexSet::Matches(std::string_view str, Scratch& scratch) const
+{
+    if (fullDfa_)
+    {
+        auto state = fullDfa_->Start();
+
+        for (size_t pos = 0; pos < str.size() && state != FullDFA::kDead; ++pos)
+            state = fullDfa_->Next(state, static_cast<uint8_t>(str[pos]));
+
+        auto tags = fullDfa_->Tags(state);
+        return { tags.begin(), tags.end() };
+    }
+
+    if (literals_)
+    {
+        auto tags = literals_->MatchingTags(str);
+        return { tags.begin(), tags.end() };
+    }
+
+    auto tags = Bind(scratch).dfa_->MatchingTags(str);
+
+    // The DFA cache ran out of its memory budget, fall back to the NFA simulation.
+    if (!tags.has_value())
+        tags = nfa_.MatchingTags(str);
+
+    return { tags->begin(), tags->end() };
+}
+
+auto RegexSet::LongestMatches(std::string_view str) const -> std::vector<SetMatch>
+{
+    return LongestMatches(str, LocalScratch());
+}
+
+auto RegexSet::LongestMatches(std::string_view str, Scratch& scratch) const -> std::vector<SetMatch>
+{
+    std::optional<std::vector<size_t>> lengths;
+
+    if (fullDfa_)
+    {
+        lengths.emplace(patterns_.size(), 0);
+        auto state = fullDfa_->Start();
+
+        for (size_t pos = 0; pos < str.size(); ++pos)
+        {
+            state = fullDfa_->Next(state, static_cast<uint8_t>(str[pos]));
+
+            if (state == FullDFA::kDead)
+                break;
+
+            for (auto tag : fullDfa_->Tags(state))
+                (*lengths)[tag] = pos + 1;
+        }
+    }
+    else if (literals_)
+    {
+        lengths = literals_->LongestMatchPerTag(str, patterns_.size());
+    }
+    else
+    {
+        lengths = Bind(scratch).dfa_->LongestMatchPerTag(str, patterns_.size());
+
+        if (!lengths.has_value())
+            lengths = nfa_.LongestMatchPerTag(str, patterns_.size());
+    }
+
+    std::vector<SetMatch> result;
+
+    for (size_t id = 0; id < lengths->size(); ++id)
+    {
+        if ((*lengths)[id] > 0)
+            result.push_back({id, (*lengths)[id]});
+    }
+
+    return result;
+}
+
+size_t RegexSet::Size() const noexcept
+{
+    return patterns_.size();
+}
+
+const std::string& RegexSet::Pattern(size_t id) const
+{
+    return patterns_.at(id);
+}
+
+void RegexSet::Save(const std::string& path) const
+{
+    auto fullDfa = fullDfa_ ? std::optional<FullDFA>(*fullDfa_) : FullDFA::Make(nfa_);
+
+    if (!fullDfa.has_value())
+    {
+        auto maxStates = FullDFA::kDefaultMaxStates;
+        throw std::runtime_error(std::format("Error: Pattern set needs more than {} DFA states.", maxStates));
+    }
+
+    AutomatonFile::Write(path, AutomatonFile::Kind::RegexSet, patterns_, *fullDfa);
+}
+
+RegexSet RegexSet::Load(const std::string& path, AutomatonFile::Verify verify)
+{
+    auto contents = AutomatonFile::Read(path, AutomatonFile::Kind::RegexSet, verify);
+
+    RegexSet result;
+
+    result.patterns_ = std::move(contents.patterns);
+    result.fullDfa_ = std::make_shared<const FullDFA>(std::move(contents.dfa));
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void RegexSet::Initialize(const std::vector<AstNode::AstNodePtr>& nodes, size_t dfaMemoryBudget)
+{
+    static std::atomic<uint64_t> nextId = 1;
+
+    id_ = nextId.fetch_add(1, std::memory_order_relaxed);
+    nfa_ = NFA(0);
+
+    auto start = nfa_.AddState();
+    nfa_.SetStart(start);
+
+    std::vector<AhoCorasick::Literal> literals;
+    bool isLiteral = true;
+
+    for (uint32_t id = 0; id < nodes.size(); ++id)
+    {
+        auto node = Optimizer(nodes[id]).Result();
+        auto fragment = node->BuildNFA(nfa_);
+
+        nfa_.AddEpsilonTransition(start, fragment.start);
+        nfa_.SetFinalTag(fragment.end, id);
+
+        auto memberLiterals = isLiteral ? AhoCorasick::Literals(node) : std::nullopt;
+        isLiteral = memberLiterals.has_value();
+
+        for (auto& literal : memberLiterals.value_or(std::vector<std::string>{}))
+            literals.push_back({ std::move(literal), id });
+    }
+
+    if (isLiteral)
+        literals_ = std::make_shared<const AhoCorasick>(literals);
+    else
+        dfa_ = std::make_shared<const LazyDFA>(nfa_, dfaMemoryBudget);
+}
+
+auto RegexSet::LocalScratch() const -> Scratch&
+{
+    thread_local std::array<Scratch, kScratchPoolSize> pool;
+    thread_local size_t victim = 0;
+
+    for (auto& scratch : pool)
+    {
+        if (scratch.id_ == id_)
+            return scratch;
+    }
+
+    auto& scratch = pool[victim++ % kScratchPoolSize];
+    scratch = Scratch(*this);
+
+    return scratch;
+}
+
+auto RegexSet::Bind(Scratch& scratch) const -> Scratch&
+{
+    if (scratch.id_ != id_)
+        scratch = Scratch(*this);
+
+    return scratch;
+}
+
+AstNode::AstNodePtr RegexSet::Parse(std::string_view pattern, size_t maxRepeatCount)
+{
+    Scanner scanner(std::string(pattern), maxRepeatCount);
+    Parser parser(scanner.ScanTokens(), maxRepeatCount);
+
+    return parser.Parse()->ConvertToAst();
+}
\ No newline at end of file
@@ -1,5 +1,8 @@
 #include "Scanner.h"
 
+#include <cctype>
+#include <stdexcept>
+
 using namespace Regex;
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -17,12 +20,21 @@ const std::vector<Token>& Scanner::ScanTokens()
 
 Token Scanner::ScanToken()
 {
-    if (char ch = src_[pos_++]; ch != '\\')
+    char ch = src_[pos_++];
+
+    switch (ch)
     {
-        return Token::FromChar(ch);
+        case '\\':
+            return ScanEscaped();
+        case '[':
+            return ScanClass();
+        case '.':
+            return Token::FromClass(CharClass::AnyButNewline());
+        case '{':
+            return ScanCounter();
+        default:
+            return Token::FromChar(ch);
     }
-
-    return ScanEscaped();
 }
 
 Token Scanner::ScanEscaped()
@@ -31,7 +43,178 @@ Token Scanner::ScanEscaped()
         return Token::Error(pos_);
 
     char ch = src_[pos_++];
-    return Token::FromChar(ch, true);
+
+    if (auto charSet = CharClass::FromEscape(ch); charSet.has_value())
+        return Token::FromClass(*charSet);
+
+    return Token::FromChar(ScanEscapedChar(ch), true);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// <class> ::= '[' ['^'] <item>+ ']'
+// <item> ::= <char> | <char>'-'<char> | '\'<class-escape>
+// ---------------------------------------------------------------------------------------------------------------------
+
+Token Scanner::ScanClass()
+{
+    auto start = pos_ - 1;
+    CharSet result;
+    bool isNegated = false;
+
+    if (!IsAtEnd() && src_[pos_] == '^')
+    {
+        isNegated = true;
+        ++pos_;
+    }
+
+    while (!IsAtEnd() && src_[pos_] != ']')
+    {
+        char from = src_[pos_++];
+
+        if (from == '\\')
+        {
+            if (IsAtEnd())
+                break;
+
+            from = src_[pos_++];
+
+            if (auto charSet = CharClass::FromEscape(from); charSet.has_value())
+            {
+                result |= *charSet;
+                continue;
+            }
+
+            from = ScanEscapedChar(from);
+        }
+
+        // A '-' right before the closing bracket is a literal one.
+        if (pos_ + 1 >= src_.size() || src_[pos_] != '-' || src_[pos_ + 1] == ']')
+        {
+            result |= CharClass::Single(from);
+            continue;
+        }
+
+        ++pos_;
+        char to = src_[pos_++];
+
+        if (to == '\\' && !IsAtEnd())
+            to = ScanEscapedChar(src_[pos_++]);
+
+        if (static_cast<unsigned char>(from) > static_cast<unsigned char>(to))
+            throw std::runtime_error(std::format("Error: Invalid range in character class at position {}.", start));
+
+        result |= CharClass::Range(from, to);
+    }
+
+    if (IsAtEnd())
+        throw std::runtime_error(std::format("Error: Unterminated character class at position {}.", start));
+
+    ++pos_;
+    return Token::FromClass(isNegated ? ~result : result);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+// <counter> ::= '{' <number> '}' | '{' <number> ',' '}' | '{' <number> ',' <number> '}'
+// ---------------------------------------------------------------------------------------------------------------------
+
+Token Scanner::ScanCounter()
+{
+    auto start = pos_ - 1;
+
+    auto literalBrace = [&]
+    {
+        pos_ = start + 1;
+        return Token::FromChar('{');
+    };
+
+    auto minCount = ScanNumber();
+
+    if (!minCount.has_value() || IsAtEnd())
+        return literalBrace();
+
+    auto maxCount = minCount;
+
+    if (src_[pos_] == ',')
+    {
+        ++pos_;
+        maxCount = ScanNumber().value_or(Token::kUnbounded);
+    }
+
+    if (IsAtEnd() || src_[pos_] != '}')
+        return literalBrace();
+
+    ++pos_;
+
+    if (*maxCount < *minCount)
+        throw std::runtime_error(std::format("Error: Invalid repetition range at position {}.", start));
+
+    auto count = *maxCount == Token::kUnbounded ? *minCount : *maxCount;
+
+    if (count > maxRepeatCount_)
+    {
+        throw std::runtime_error
+        (
+            std::format("Error: Repetition count {} exceeds the limit of {} at position {}.", count, maxRepeatCount_, start)
+        );
+    }
+
+    return Token::FromCounter(*minCount, *maxCount);
+}
+
+std::optional<size_t> Scanner::ScanNumber()
+{
+    auto start = pos_;
+    size_t result = 0;
+
+    while (!IsAtEnd() && std::isdigit(static_cast<unsigned char>(src_[pos_])))
+    {
+        auto digit = static_cast<size_t>(src_[pos_++] - '0');
+
+        // Saturates instead of overflowing, the caller rejects such a count anyway.
+        result = result > (Token::kUnbounded - 1 - digit) / 10 ? Token::kUnbounded - 1 : result * 10 + digit;
+    }
+
+    if (pos_ == start)
+        return std::nullopt;
+
+    return result;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+char Scanner::ScanEscapedChar(char ch)
+{
+    switch (ch)
+    {
+        case 'n':
+            return '\n';
+        case 'r':
+            return '\r';
+        case 't':
+            return '\t';
+        case 'f':
+            return '\f';
+        case 'v':
+            return '\v';
+        default:
+            break;
+    }
+
+    auto isHexDigit = [](char digit)
+    {
+        return std::isxdigit(static_cast<unsigned char>(digit)) != 0;
+    };
+
+    if (ch != 'x' || pos_ + 2 > src_.size())
+        return ch;
+
+    if (!isHexDigit(src_[pos_]) || !isHexDigit(src_[pos_ + 1]))
+        return ch;
+
+    auto code = std::stoi(src_.substr(pos_, 2), nullptr, 16);
+    pos_ += 2;
+
+    return static_cast<char>(code);
 }
 
 bool Scanner::IsAtEnd() const noexcept
@@ -0,0 +1,297 @@
+#include "StreamMatcher.h"
+
+#include <algorithm>
+#include <type_traits>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+StreamMatcher::StreamMatcher(const RegExp& regexp, Callback callback)
+    : literals_(regexp.literals_)
+    , fullLeftmostDfa_(regexp.fullLeftmostDfa_)
+    , fullReverseDfa_(regexp.fullReverseDfa_)
+    , node_(regexp.node_)
+    , prefilter_(regexp.prefilter_)
+    , callback_(std::move(callback))
+{
+    if (!literals_)
+    {
+        if (regexp.fullPrefixDfa_)
+            fullPrefixDfa_ = regexp.fullPrefixDfa_;
+        else
+            prefixDfa_.emplace(regexp.nfa_.ReversePrefixes(), regexp.dfaMemoryBudget_);
+
+        if (!fullLeftmostDfa_)
+        {
+            leftmostDfa_.emplace(*regexp.leftmostDfa_);
+            reverseDfa_.emplace(*regexp.reverseDfa_);
+        }
+    }
+
+    Restart(0);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void StreamMatcher::Feed(std::string_view chunk)
+{
+    buffer_.append(chunk);
+    Scan(false);
+}
+
+void StreamMatcher::Finish()
+{
+    Scan(true);
+
+    buffer_.clear();
+    offset_ = 0;
+    Restart(0);
+}
+
+size_t StreamMatcher::BufferedSize() const noexcept
+{
+    return buffer_.size();
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+void StreamMatcher::Scan(bool isAtEnd)
+{
+    if (literals_)
+    {
+        ScanLiterals(isAtEnd);
+    }
+    else if (fullLeftmostDfa_)
+    {
+        ScanDfa(*fullLeftmostDfa_, *fullReverseDfa_, isAtEnd);
+    }
+    else if (useNfa_ || !ScanDfa(*leftmostDfa_, *reverseDfa_, isAtEnd))
+    {
+        // Even the search in progress does not fit into the budget of the lazy DFAs.
+        useNfa_ = true;
+        ScanNfa(isAtEnd);
+    }
+
+    buffer_.erase(0, from_);
+    offset_ += from_;
+    pos_ -= from_;
+    end_ -= end_ > 0 ? from_ : 0;
+    from_ = 0;
+}
+
+void StreamMatcher::ScanLiterals(bool isAtEnd)
+{
+    // A match is taken once the longest literal from its start has arrived, every earlier start is ruled out by then.
+    auto maxLength = literals_->MaxLength();
+
+    for (auto match = literals_->Find(buffer_, from_, buffer_.size()); match.has_value();
+         match = literals_->Find(buffer_, from_, buffer_.size()))
+    {
+        if (!isAtEnd && match->offset + maxLength > buffer_.size())
+            break;
+
+        callback_(offset_ + match->offset, match->length);
+        from_ = match->offset + match->length;
+    }
+
+    // Only the starts whose longest literal can still be cut by the end of the chunk are kept.
+    auto keep = isAtEnd ? 0 : std::min(buffer_.size(), std::max<size_t>(maxLength, 1) - 1);
+
+    from_ = std::max(from_, buffer_.size() - keep);
+    pos_ = from_;
+}
+
+void StreamMatcher::ScanNfa(bool isAtEnd)
+{
+    if (!nfa_.has_value())
+        nfa_.emplace(node_->ToNFA());
+
+    // The NFA keeps no state between chunks, so it reads the whole match in progress again every time.
+    while (true)
+    {
+        auto pos = prefilter_.Find(buffer_, from_);
+
+        if (pos == std::string_view::npos)
+        {
+            from_ = buffer_.size() - PrefixTail(from_, isAtEnd);
+            break;
+        }
+
+        bool isAlive = false;
+        auto longest = nfa_->LongestMatchLength(std::string_view(buffer_).substr(pos), isAlive);
+
+        if (isAlive && !isAtEnd)
+        {
+            from_ = pos;
+            break;
+        }
+
+        if (longest > 0)
+            callback_(offset_ + pos, longest);
+
+        from_ = pos + std::max<size_t>(longest, 1);
+    }
+
+    pos_ = from_;
+}
+
+template <typename ForwardDfa, typename ReverseDfa>
+bool StreamMatcher::ScanDfa(ForwardDfa& forwardDfa, ReverseDfa& reverseDfa, bool isAtEnd)
+{
+    // Only the lazy DFAs can run out of their budget.
+    constexpr bool isLazy = std::is_same_v<ForwardDfa, LeftmostDFA>;
+    using StateId = typename ForwardDfa::StateId;
+
+    // The state is unknown after a restart whose start state did not fit into the cache.
+    if constexpr (isLazy)
+    {
+        if (static_cast<StateId>(state_) == LeftmostDFA::kUnknown && !Replay())
+            return false;
+    }
+
+    auto state = static_cast<StateId>(state_);
+    bool isReplayed = false;
+
+    while (true)
+    {
+        if (state == forwardDfa.Start())
+        {
+            // No match is under way, so the search starts over where the prefilter finds a candidate.
+            auto pos = prefilter_.Find(buffer_, pos_);
+
+            if (pos == std::string_view::npos)
+            {
+                pos_ = buffer_.size() - PrefixTail(pos_, isAtEnd);
+                from_ = pos_;
+                break;
+            }
+
+            from_ = pos;
+            pos_ = pos;
+            trimSize_ = kMinTrimSize;
+        }
+
+        if (pos_ < buffer_.size())
+        {
+            auto next = forwardDfa.Next(state, static_cast<uint8_t>(buffer_[pos_]));
+
+            if constexpr (isLazy)
+            {
+                if (next == LeftmostDFA::kUnknown)
+                {
+                    // The cache was dropped, the search in progress is read again to get a valid state. If the fresh
+                    // cache overflows on the very same byte, the budget cannot hold this search.
+                    if (isReplayed || !Replay())
+                        return false;
+
+                    state = static_cast<StateId>(state_);
+                    isReplayed = true;
+                    continue;
+                }
+            }
+
+            isReplayed = false;
+
+            if (next != ForwardDfa::kDead)
+            {
+                state = next;
+                ++pos_;
+
+                if (forwardDfa.IsFinal(state))
+                    end_ = pos_;
+
+                continue;
+            }
+
+            // Without a match seen the DFA only dies if the pattern matches nothing at all.
+            if (end_ == 0)
+            {
+                state = forwardDfa.Start();
+                ++pos_;
+                continue;
+            }
+        }
+        else if (!isAtEnd || end_ == 0)
+        {
+            break;
+        }
+
+        // The match in progress has ended, its start is the leftmost one the reverse DFA finds from its end.
+        auto text = std::string_view(buffer_).substr(from_, end_ - from_);
+        std::optional<size_t> length = reverseDfa.LongestMatchBackward(text);
+
+        if (!length.has_value())
+            length = reverseDfa.LongestMatchBackward(text);
+
+        if (!length.has_value())
+            return false;
+
+        callback_(offset_ + end_ - *length, *length);
+        Restart(end_);
+
+        if constexpr (isLazy)
+        {
+            if (static_cast<StateId>(state_) == LeftmostDFA::kUnknown && !Replay())
+                return false;
+        }
+
+        state = static_cast<StateId>(state_);
+    }
+
+    state_ = static_cast<uint32_t>(state);
+
+    if (state != forwardDfa.Start())
+        Trim();
+
+    return true;
+}
+
+bool StreamMatcher::Replay()
+{
+    auto state = leftmostDfa_->Start();
+
+    for (auto pos = from_; pos < pos_ && state != LeftmostDFA::kUnknown; ++pos)
+        state = leftmostDfa_->Next(state, static_cast<uint8_t>(buffer_[pos]));
+
+    state_ = static_cast<uint32_t>(state);
+    return state != LeftmostDFA::kUnknown;
+}
+
+void StreamMatcher::Trim()
+{
+    if (pos_ - from_ < trimSize_)
+        return;
+
+    // The longest suffix of the search in progress that is a prefix of a match starts at the earliest live group. The
+    // groups before it are dead, so reading the search from there on gives the same state and the same match start.
+    auto text = std::string_view(buffer_).substr(from_, pos_ - from_);
+
+    if (fullPrefixDfa_)
+        from_ = pos_ - fullPrefixDfa_->LongestMatchBackward(text);
+    else if (auto length = prefixDfa_->LongestMatchBackward(text); length.has_value())
+        from_ = pos_ - *length;
+
+    trimSize_ = std::max(kMinTrimSize, 2 * (pos_ - from_));
+}
+
+size_t StreamMatcher::PrefixTail(size_t pos, bool isAtEnd) const noexcept
+{
+    if (isAtEnd || prefilter_.GetKind() != Prefilter::Kind::Literal)
+        return 0;
+
+    return std::min(prefilter_.Prefix().size() - 1, buffer_.size() - pos);
+}
+
+void StreamMatcher::Restart(size_t from)
+{
+    from_ = from;
+    pos_ = from;
+    end_ = 0;
+    trimSize_ = kMinTrimSize;
+
+    if (fullLeftmostDfa_)
+        state_ = fullLeftmostDfa_->Start();
+    else if (leftmostDfa_)
+        state_ = static_cast<uint32_t>(leftmostDfa_->Start());
+}
\ No newline at end of file
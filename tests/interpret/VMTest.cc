@@ -0,0 +1,192 @@
+#include <interpret/Runner.h>
+
+#include <gtest/gtest.h>
+
+using namespace Core;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class VMTest : public testing::Test
+{
+protected:
+    VMTest()
+    {
+        Runner::SetEngine(Engine::Bytecode);
+        Runner::Reset();
+    }
+
+    ~VMTest() override
+    {
+        Runner::SetEngine(Engine::TreeWalker);
+        Runner::Reset();
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, ForStatement)
+{
+    auto result = Runner::Run(
+        "var a; for (a = 0; a < 5; a = a + 1) {} a;"
+    );
+    EXPECT_EQ(result, 5);
+
+    result = Runner::Run(
+        "var a; for (a = 0; a < 5; a = a + 1) { print a; } a / 2;"
+    );
+    EXPECT_EQ(result, 2.5);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, WhileStatement)
+{
+    auto result = Runner::Run(
+        "var a = 0; while (a < 5) { a = a + 1; } a;"
+    );
+    EXPECT_EQ(result, 5);
+
+    result = Runner::Run(
+        "var a = 0; var b = 3; while(a < 3 and b > 0) { a = a + 1; b = b - 1; } a == 3 and b == 0;"
+    );
+    EXPECT_EQ(result, true);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, IfStatement)
+{
+    auto result = Runner::Run(
+        "var x = 1; var y = 2; if (x == 1) { y = x + y - 1; } else { y = x; } y;"
+    );
+    EXPECT_EQ(result, 2);
+
+    result = Runner::Run(
+        "var x = 2; var y; if (x != 2) { y = x; } else { y = x * -1 + 5; } y;"
+    );
+    EXPECT_EQ(result, 3);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, VarAssignment)
+{
+    auto result = Runner::Run(
+        "{ "
+        "  var x = 3; var y = x * 2 - 1; var a = x + y;"
+        "  {"
+        "    x = 9; y = 20; var z = x + y + 1; a = a + z;"
+        "  }"
+        "  a;"
+        "}"
+    );
+    EXPECT_EQ(result, 38);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, Blocks)
+{
+    auto result = Runner::Run(
+        "var z; var x = 11; var y = 88;"
+        "{"
+        "  var x = 2; var y = \"test\"; print x; print y;"
+        "  {"
+        "      x = 3; y = 20; print x; print y;"
+        "  }"
+        "  print x; print y; "
+        "}"
+        "print x; print y; z = x + y;"
+    );
+
+    EXPECT_EQ(result, 99);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, StringConcat)
+{
+    auto result = Runner::Run("var str = \"test\"; str = \"concat_\" + str;");
+    EXPECT_EQ(result, "concat_test");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, Function)
+{
+    auto result = Runner::Run("func Sum(a,b) { return a + b; }");
+    result = Runner::Run("var t = Sum(1,2) + Sum(Sum(1, 2), Sum(-1,1));");
+
+    EXPECT_EQ(result, 6);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, Recursion)
+{
+    auto result = Runner::Run(
+        "func fib(n) { if (n < 2) return n; return fib(n - 1) + fib(n - 2); }"
+        "fib(20);"
+    );
+
+    EXPECT_EQ(result, 6765);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, Closures)
+{
+    auto result = Runner::Run(
+        "func MakeCounter() {"
+        "  var count = 0;"
+        "  func Next() { count = count + 1; return count; }"
+        "  return Next;"
+        "}"
+        "var a = MakeCounter(); var b = MakeCounter();"
+        "a(); a(); b();"
+        "a() * 10 + b();"
+    );
+
+    EXPECT_EQ(result, 32);
+
+    result = Runner::Run(
+        "var total = 0;"
+        "{"
+        "  var step = 2;"
+        "  func Add(x) { total = total + x * step; }"
+        "  Add(1); Add(2);"
+        "  step = 10;"
+        "  Add(3);"
+        "}"
+        "total;"
+    );
+
+    EXPECT_EQ(result, 36);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, LogicalShortCircuit)
+{
+    auto result = Runner::Run("var calls = 0; func Touch() { calls = calls + 1; return True; }");
+
+    result = Runner::Run("False and Touch(); True or Touch(); calls;");
+    EXPECT_EQ(result, 0);
+
+    result = Runner::Run("Null or \"fallback\";");
+    EXPECT_EQ(result, "fallback");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(VMTest, Arithmetic)
+{
+    auto result = Runner::Run("10 + 8 + (- 3);");
+    EXPECT_EQ(result, 15);
+
+    result = Runner::Run("(5 < 6) + 7 * -2;");
+    EXPECT_EQ(result, -13);
+
+    result = Runner::Run("5.0 / 2.5 - 3.0 * 0.5;");
+    EXPECT_EQ(result, 0.5);
+}
\ No newline at end of file
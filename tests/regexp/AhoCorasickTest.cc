@@ -0,0 +1,165 @@
+#include <gtest/gtest.h>
+#include "AhoCorasick.h"
+#include "RegExp.h"
+#include "TestPatterns.h"
+
+#include <random>
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class AhoCorasickTest : public testing::Test
+{
+protected:
+    using Literals = std::vector<std::string>;
+    using MatchList = std::vector<std::pair<size_t, size_t>>;
+
+protected:
+    static std::optional<Literals> LiteralsOf(const std::string& pattern)
+    {
+        return AhoCorasick::Literals(Optimizer(ParsePattern(pattern)).Result());
+    }
+
+    static AhoCorasick Make(const Literals& literals)
+    {
+        std::vector<AhoCorasick::Literal> tagged;
+
+        for (uint32_t tag = 0; tag < literals.size(); ++tag)
+            tagged.push_back({ literals[tag], tag });
+
+        return AhoCorasick(tagged);
+    }
+
+    static MatchList FindAll(const AhoCorasick& automaton, std::string_view str)
+    {
+        MatchList result;
+
+        for (auto match = automaton.Find(str, 0, str.size()); match.has_value();)
+        {
+            result.emplace_back(match->offset, match->length);
+            match = automaton.Find(str, match->offset + match->length, str.size());
+        }
+
+        return result;
+    }
+
+    // The longest literal at the first offset where there is one, one offset after the other.
+    static MatchList FindAllNaive(const Literals& literals, std::string_view str)
+    {
+        MatchList result;
+
+        for (size_t pos = 0; pos < str.size();)
+        {
+            size_t longest = 0;
+
+            for (auto& literal : literals)
+            {
+                if (!literal.empty() && str.substr(pos).starts_with(literal))
+                    longest = std::max(longest, literal.size());
+            }
+
+            if (longest > 0)
+                result.emplace_back(pos, longest);
+
+            pos += std::max<size_t>(longest, 1);
+        }
+
+        return result;
+    }
+
+    static std::string RandomText(std::string_view alphabet, size_t length, uint32_t seed)
+    {
+        std::mt19937 random(seed);
+        std::string result;
+
+        for (size_t i = 0; i < length; ++i)
+            result += alphabet[random() % alphabet.size()];
+
+        return result;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AhoCorasickTest, LiteralsOfPatterns)
+{
+    EXPECT_EQ(LiteralsOf("error|warning|fatal|timeout"), (Literals{ "error", "fatal", "timeout", "warning" }));
+    EXPECT_EQ(LiteralsOf("if|in|int"), (Literals{ "if", "in", "int" }));
+    EXPECT_EQ(LiteralsOf("ab[cd]|(x)?y"), (Literals{ "abc", "abd", "xy", "y" }));
+    EXPECT_EQ(LiteralsOf("(|a)b"), (Literals{ "ab", "b" }));
+
+    EXPECT_FALSE(LiteralsOf("error|warn.*").has_value());
+    EXPECT_FALSE(LiteralsOf("(ab){2}").has_value());
+    EXPECT_FALSE(LiteralsOf("[a-z][a-z]").has_value());
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AhoCorasickTest, LeftmostLongest)
+{
+    auto automaton = Make({ "abcd", "bc", "cdefg", "b", "x" });
+
+    EXPECT_EQ(FindAll(automaton, "zzabcdefg"), (MatchList{ { 2, 4 } }));
+    EXPECT_EQ(FindAll(automaton, "zzabcx bcdef"), (MatchList{ { 3, 2 }, { 5, 1 }, { 7, 2 } }));
+    EXPECT_EQ(FindAll(automaton, "cdefgbcdefg"), (MatchList{ { 0, 5 }, { 5, 2 } }));
+
+    // Matches start before the limit but may end after it.
+    EXPECT_EQ(automaton.Find("zzabcd", 0, 3)->length, 4);
+    EXPECT_FALSE(automaton.Find("zzabcd", 0, 2).has_value());
+    EXPECT_FALSE(automaton.Find("zzabcd", 4, 6).has_value());
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AhoCorasickTest, AgreesWithNaiveSearch)
+{
+    // Few short literals are packed where SSE2 is there, many literals over a small alphabet get a dense table, long
+    // ones over a large alphabet need too many states times byte classes and stay sparse.
+    std::vector<Literals> sets = { { "ab", "abc", "b", "cab" }, {}, {} };
+    std::mt19937 random(5);
+
+    for (size_t i = 0; i < 40; ++i)
+        sets[1].push_back(RandomText("abc", 2 + random() % 5, static_cast<uint32_t>(i)));
+
+    for (size_t i = 0; i < 200; ++i)
+        sets[2].push_back(RandomText("abcdefghijklmnopqrstuvwxyz0123456789ABCDEFGHIJKLMNOPQRSTUVWXYZ", 40, i));
+
+    auto few = Make(sets[0]);
+    auto many = Make(sets[1]);
+    auto large = Make(sets[2]);
+
+    EXPECT_NE(few.GetKind(), AhoCorasick::Kind::Sparse);
+    EXPECT_EQ(many.GetKind(), AhoCorasick::Kind::Dense);
+    EXPECT_EQ(large.GetKind(), AhoCorasick::Kind::Sparse);
+
+    auto text = RandomText("abc", 3000, 9);
+
+    EXPECT_EQ(FindAll(few, text), FindAllNaive(sets[0], text));
+    EXPECT_EQ(FindAll(many, text), FindAllNaive(sets[1], text));
+
+    text = "x" + sets[2][7] + sets[2][3].substr(0, 20) + sets[2][3] + RandomText("abcdefghij", 1000, 3) + sets[2][199];
+
+    EXPECT_EQ(FindAll(large, text), FindAllNaive(sets[2], text));
+    EXPECT_EQ(FindAll(large, text).size(), 3);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AhoCorasickTest, RegExpFindMatches)
+{
+    const RegExp severity("error|warning|fatal|timeout");
+    const std::string log = "fatal: timeout after 3 warnings, no errors; warning";
+
+    EXPECT_EQ(severity.Stats().literals, 4);
+    EXPECT_EQ(severity.FindMatches(log), (RegExp::MatchList{
+        { 0, "fatal" }, { 7, "timeout" }, { 23, "warning" }, { 36, "error" }, { 44, "warning" } }));
+    EXPECT_EQ(severity.FindMatches(log), RegExp("error|warning|fatal|timeout+").FindMatches(log));
+    EXPECT_TRUE(severity.Matches("timeout"));
+
+    const RegExp keywords("if|in|int|interface");
+
+    EXPECT_EQ(keywords.FindMatchRanges("int interfaces in"),
+        (RegExp::MatchRangeList{ { 0, 3 }, { 4, 9 }, { 15, 2 } }));
+}
\ No newline at end of file
@@ -206,4 +206,77 @@ TEST_F(AstTest, Optional)
     EXPECT_FALSE(pattern->Matches("abc"));
 
     EXPECT_EQ(pattern->ToString(), "(a?|b)c");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AstTest, SkipsNeverEnterLoops)
+{
+    // The edge that skips (ba+)? must not land in the loop of a+, or "ac" reads its a there without the b before it.
+    auto pattern = ConcatenationAst::Make
+    (
+        OptionalAst::Make
+        (
+            ConcatenationAst::Make
+            (
+                SymbolAst::Make('b'),
+                OneOrMoreAst::Make
+                (
+                    SymbolAst::Make('a')
+                )
+            )
+        ),
+        SymbolAst::Make('c')
+    );
+
+    EXPECT_TRUE(pattern->Matches("c"));
+    EXPECT_TRUE(pattern->Matches("bac"));
+    EXPECT_TRUE(pattern->Matches("baac"));
+
+    EXPECT_FALSE(pattern->Matches("ac"));
+    EXPECT_FALSE(pattern->Matches("aac"));
+    EXPECT_FALSE(pattern->Matches("bc"));
+
+    EXPECT_EQ(pattern->ToString(), "(ba+)?c");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AstTest, CountedRepetition)
+{
+    auto pattern = ConcatenationAst::Make
+    (
+        CountedRepetitionAst::Make
+        (
+            AlternationAst::Make
+            (
+                SymbolAst::Make('a'),
+                SymbolAst::Make('b')
+            ),
+            2, 4
+        ),
+        CountedRepetitionAst::Make(SymbolAst::Make('c'), 1, Token::kUnbounded)
+    );
+
+    EXPECT_TRUE(pattern->Matches("abc"));
+    EXPECT_TRUE(pattern->Matches("bbbbc"));
+    EXPECT_TRUE(pattern->Matches("aaccc"));
+
+    EXPECT_FALSE(pattern->Matches("ac"));
+    EXPECT_FALSE(pattern->Matches("aaaaac"));
+    EXPECT_FALSE(pattern->Matches("aa"));
+
+    EXPECT_EQ(pattern->ToString(), "(a|b){2,4}c{1,}");
+
+    // The optional copies share their exit, so the automaton stays linear in the count.
+    auto counted = CountedRepetitionAst::Make(SymbolAst::Make('a'), 0, 200);
+
+    EXPECT_EQ(counted->ToNFA().Size(), 2 + 2 * 200);
+    EXPECT_TRUE(counted->Matches(std::string(200, 'a')));
+    EXPECT_FALSE(counted->Matches(std::string(201, 'a')));
+
+    Glushkov glushkov;
+    glushkov.SetRoot(counted->BuildPositions(glushkov));
+
+    EXPECT_EQ(glushkov.Size(), 200);
 }
\ No newline at end of file
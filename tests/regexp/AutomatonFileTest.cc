@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "AutomatonFile.h"
+#include "RegExp.h"
+#include "RegexSet.h"
+#include "StreamMatcher.h"
+
+#include <filesystem>
+#include <fstream>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class AutomatonFileTest : public testing::Test
+{
+protected:
+    std::string path_ = (std::filesystem::temp_directory_path() / "AutomatonFileTest.bin").string();
+
+protected:
+    ~AutomatonFileTest() override
+    {
+        std::filesystem::remove(path_);
+    }
+
+    void Patch(size_t offset, char value) const
+    {
+        std::fstream file(path_, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp(static_cast<std::streamoff>(offset));
+        file.put(value);
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AutomatonFileTest, RegExpRoundTrip)
+{
+    RegExp original("[a-z]+@[a-z]+\\.(com|org)|[0-9]+");
+    original.Save(path_);
+
+    auto loaded = RegExp::Load(path_);
+    const std::string str = "mail bob@example.com or 42, not x@y.net but a@b.org";
+
+    EXPECT_EQ(loaded.Pattern(), original.Pattern());
+    EXPECT_TRUE(loaded.Stats().isFullDfa);
+    EXPECT_GT(loaded.Stats().dfaTableBytes, 0);
+    EXPECT_TRUE(loaded.Stats().isFullSearchDfa);
+    EXPECT_EQ(loaded.GroupCount(), original.GroupCount());
+
+    // Nothing is built from the pattern, the search and the captures run on what the file holds.
+    EXPECT_EQ(loaded.Stats().nfaStates, 0);
+
+    EXPECT_EQ(loaded.FindMatches(str), original.FindMatches(str));
+    EXPECT_EQ(loaded.FindAllCaptures(str), original.FindAllCaptures(str));
+    EXPECT_TRUE(loaded.Matches("a@b.com"));
+    EXPECT_FALSE(loaded.Matches("a@b.co"));
+
+    size_t count = 0;
+    StreamMatcher matcher(loaded, [&count](size_t, size_t) { ++count; });
+
+    matcher.Feed(str);
+    matcher.Finish();
+
+    EXPECT_EQ(count, original.FindMatches(str).size());
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AutomatonFileTest, RegexSetRoundTrip)
+{
+    RegexSet original({ "GET /[a-z/]*", "[A-Z]+ /api/.*", "(GET|POST) .*", "[0-9]+" });
+    original.Save(path_);
+
+    auto loaded = RegexSet::Load(path_);
+
+    EXPECT_EQ(loaded.Size(), 4);
+    EXPECT_EQ(loaded.Pattern(3), "[0-9]+");
+
+    for (std::string str : { "GET /index", "GET /api/items", "POST /api/v1", "404", "HEAD", "" })
+        EXPECT_EQ(loaded.Matches(str), original.Matches(str)) << str;
+
+    EXPECT_EQ(loaded.LongestMatches("GET /api/v1 HTTP/1.1"), original.LongestMatches("GET /api/v1 HTTP/1.1"));
+    EXPECT_THROW(RegExp::Load(path_), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(AutomatonFileTest, RejectsStaleFiles)
+{
+    RegExp("ab*c").Save(path_);
+    EXPECT_TRUE(RegExp::Load(path_).Matches("abbc"));
+
+    // A damaged table.
+    Patch(std::filesystem::file_size(path_) - 9, 'x');
+    EXPECT_THROW(RegExp::Load(path_), std::runtime_error);
+
+    // A pattern section size that does not fit the pattern table, and one beyond the end of the file.
+    RegExp("ab*c").Save(path_);
+    Patch(20, 8);
+    EXPECT_THROW(RegExp::Load(path_), std::runtime_error);
+
+    Patch(23, 1);
+    EXPECT_THROW(RegExp::Load(path_), std::runtime_error);
+
+    // A damaged pattern leaves the tables intact, only the checksum tells.
+    RegExp("ab*c").Save(path_);
+    Patch(40, 'x');
+    EXPECT_EQ(RegExp::Load(path_).Pattern(), "xb*c");
+    EXPECT_THROW(RegExp::Load(path_, AutomatonFile::Verify::Checksum), std::runtime_error);
+
+    // Another format version.
+    RegExp("ab*c").Save(path_);
+    Patch(8, static_cast<char>(AutomatonFile::kVersion + 1));
+    EXPECT_THROW(RegExp::Load(path_), std::runtime_error);
+
+    std::ofstream(path_, std::ios::trunc) << "NNREGEX";
+    EXPECT_THROW(RegExp::Load(path_), std::runtime_error);
+}
\ No newline at end of file
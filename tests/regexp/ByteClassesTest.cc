@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "ByteClasses.h"
+#include "RegExp.h"
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class ByteClassesTest : public testing::Test
+{
+protected:
+    ByteClassesTest() = default;
+    ~ByteClassesTest() override = default;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(ByteClassesTest, Partition)
+{
+    const std::vector<CharSet> sets = { CharClass::Range('a', 'z'), CharClass::Digits(), CharClass::Single('x') };
+    auto classes = ByteClasses::FromSets(sets);
+
+    EXPECT_EQ(classes.Count(), 4);
+
+    EXPECT_EQ(classes['a'], classes['w']);
+    EXPECT_EQ(classes['a'], classes['z']);
+    EXPECT_NE(classes['a'], classes['x']);
+    EXPECT_EQ(classes['0'], classes['9']);
+    EXPECT_EQ(classes['\0'], classes['~']);
+    EXPECT_NE(classes['0'], classes['a']);
+
+    // Classes are numbered in the order of their smallest byte.
+    EXPECT_EQ(classes['\0'], 0);
+    EXPECT_EQ(classes.Representative(classes['z']), 'a');
+    EXPECT_EQ(classes.Representative(classes['x']), 'x');
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(ByteClassesTest, CompileStats)
+{
+    RegExp identifier("[A-Za-z_][A-Za-z0-9_]*");
+    auto& stats = identifier.Stats();
+
+    EXPECT_TRUE(stats.isBitParallel);
+    EXPECT_EQ(stats.positions, 2);
+    EXPECT_EQ(stats.byteClasses, 3);
+
+    RegExp large("(" + std::string(200, 'a') + "|[0-9]+)b*");
+    auto& largeStats = large.Stats();
+
+    EXPECT_FALSE(largeStats.isBitParallel);
+    EXPECT_GT(largeStats.nfaStates, 200);
+    EXPECT_EQ(largeStats.byteClasses, 4);
+
+    EXPECT_TRUE(large.Matches("123bb"));
+    EXPECT_FALSE(large.Matches("12a"));
+}
\ No newline at end of file
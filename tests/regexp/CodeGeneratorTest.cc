@@ -0,0 +1,117 @@
+#include <gtest/gtest.h>
+#include "CodeGenerator.h"
+#include "Lexer.h"
+
+#include "AbbMatcher.h"
+#include "PairsLexer.h"
+#include "PairsMatcher.h"
+#include "TestLexer.h"
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class CodeGeneratorTest : public testing::Test
+{
+protected:
+    // Every string over the alphabet up to the length, the empty one included.
+    static std::vector<std::string> AllStrings(std::string_view alphabet, size_t maxLength)
+    {
+        std::vector<std::string> result = { {} };
+
+        for (size_t idx = 0; result[idx].size() < maxLength; ++idx)
+        {
+            for (auto ch : alphabet)
+                result.push_back(result[idx] + ch);
+        }
+
+        return result;
+    }
+
+    static Lexer Compile(const std::vector<std::string>& patterns)
+    {
+        std::vector<Lexer::Rule> rules;
+
+        for (auto& pattern : patterns)
+            rules.push_back({ pattern, static_cast<uint32_t>(rules.size()) });
+
+        return Lexer(rules);
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(CodeGeneratorTest, MatchersAgreeWithDFA)
+{
+    auto abb = Compile({ "(a|b)*abb" });
+    auto pairs = Compile({ "(ab|c)*" });
+
+    for (auto& str : AllStrings("abc", 7))
+    {
+        EXPECT_EQ(Generated::AbbMatcher::Matches(str), abb.Dfa().Accepts(str)) << str;
+        EXPECT_EQ(Generated::AbbMatcher::LongestMatch(str), abb.Dfa().LongestMatch(str)) << str;
+        EXPECT_EQ(Generated::PairsMatcher::Matches(str), pairs.Dfa().Accepts(str)) << str;
+        EXPECT_EQ(Generated::PairsMatcher::LongestMatch(str), pairs.Dfa().LongestMatch(str)) << str;
+    }
+
+    EXPECT_TRUE(Generated::PairsMatcher::Matches(""));
+    EXPECT_EQ(Generated::AbbMatcher::LongestMatch("babaabbab"), 7);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(CodeGeneratorTest, LexerAgreesWithLexer)
+{
+    using Kind = Generated::TestLexer::Kind;
+
+    // The rules of TestLexer.lexer.
+    auto lexer = Compile({ "( |\t)*", "if", "in", "[a-z]+", "[0-9]+", "<", "<=", "<<", R"("[^"]*")" });
+
+    for (auto& str : AllStrings(" if1<=\"?", 5))
+    {
+        for (size_t pos = 0; pos <= str.size(); ++pos)
+        {
+            auto expected = lexer.Next(str, pos);
+            auto generated = Generated::TestLexer::Next(str, pos);
+
+            EXPECT_EQ(generated.kind, expected.kind) << str << " at " << pos;
+            EXPECT_EQ(generated.length, expected.length) << str << " at " << pos;
+        }
+    }
+
+    auto pairs = Compile({ "(ab)*", "(ab)*c" });
+
+    for (auto& str : AllStrings("abc", 6))
+    {
+        auto expected = pairs.Next(str);
+        auto generated = Generated::PairsLexer::Next(str);
+
+        EXPECT_EQ(generated.kind, expected.kind) << str;
+        EXPECT_EQ(generated.length, expected.length) << str;
+    }
+
+    EXPECT_EQ(Generated::TestLexer::Next("  if").length, 2);
+    EXPECT_EQ(Generated::TestLexer::Next("  if", 2).kind, static_cast<uint32_t>(Kind::If));
+    EXPECT_EQ(Generated::TestLexer::Next("?").kind, Generated::TestLexer::kNoMatch);
+    EXPECT_EQ(Generated::PairsLexer::Next("ababa").length, 4);
+    EXPECT_EQ(Generated::PairsLexer::Next("x").kind, Generated::PairsLexer::kNoMatch);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(CodeGeneratorTest, Source)
+{
+    auto lexer = Compile({ "ab*", "c" });
+    auto source = CodeGenerator({ .name = "Small", .kindType = "Core::TokenType", .includes = { "TokenType.h" } })
+        .GenerateLexer(lexer.Dfa(), { "Word", "Char" });
+
+    EXPECT_NE(source.find("#include \"TokenType.h\""), std::string::npos);
+    EXPECT_NE(source.find("struct Small"), std::string::npos);
+    EXPECT_NE(source.find("static_cast<uint32_t>(Core::TokenType::Char)"), std::string::npos);
+    EXPECT_NE(source.find("goto state"), std::string::npos);
+    EXPECT_EQ(source.find("enum class Kind"), std::string::npos);
+
+    EXPECT_THROW(CodeGenerator({ .name = "2nd" }), std::runtime_error);
+    EXPECT_THROW(CodeGenerator({ .name = "Lexer", .nameSpace = "Core::" }), std::runtime_error);
+    EXPECT_THROW(CodeGenerator({ .name = "Lexer" }).GenerateLexer(lexer.Dfa(), { "a-b", "c" }), std::runtime_error);
+}
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <gtest/gtest.h>
+#include "DFA.h"
+#include "RegExp.h"
+#include "TestPatterns.h"
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class DFATest : public testing::Test
+{};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(DFATest, AgreesWithNFA)
+{
+    const std::vector<std::string> patterns = { "(ab|a)*", "(a(|b))*", "abcd|xyz", "[A-Za-z_][A-Za-z0-9_]*" };
+    const std::vector<std::string> inputs = { "", "a", "ab", "aba", "abb", "abcd", "xyz", "xy", "_id42", "4id" };
+
+    for (auto& pattern : patterns)
+    {
+        auto nfa = CompileNfa(pattern);
+        LazyDFA dfa(nfa);
+
+        for (auto& input : inputs)
+        {
+            EXPECT_EQ(dfa.Accepts(input), nfa.Accepts(input)) << pattern << " on " << input;
+            EXPECT_EQ(dfa.LongestMatch(input), nfa.LongestMatch(input).size()) << pattern << " on " << input;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(DFATest, StatesAreCached)
+{
+    auto nfa = CompileNfa("(ab|cd)*");
+    LazyDFA dfa(nfa);
+
+    EXPECT_EQ(dfa.Accepts("abcdabcd"), true);
+    auto stateCount = dfa.StateCount();
+
+    EXPECT_EQ(dfa.Accepts("cdabcdab"), true);
+    EXPECT_EQ(dfa.StateCount(), stateCount);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(DFATest, MemoryBudgetExceeded)
+{
+    auto nfa = CompileNfa("(a|b)*a(a|b)(a|b)(a|b)");
+    LazyDFA dfa(nfa, 1024);
+
+    EXPECT_FALSE(dfa.Accepts("abbbabababbbaaab").has_value());
+    EXPECT_LE(dfa.MemoryUsed(), 1024);
+
+    RegExp regexp("(a|b)*a(a|b)(a|b)(a|b)", 4096);
+
+    EXPECT_TRUE(regexp.Matches("abbbabababbbaaab"));
+    EXPECT_FALSE(regexp.Matches("abbbabababbbbbbb"));
+    EXPECT_EQ(regexp.LongestMatch("ccabbbabbbcc", 2), "abbbabbb");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(DFATest, LeftmostLongestEnd)
+{
+    auto nfa = CompileNfa("abcd|bc|cdefg|x*y");
+    LeftmostDFA dfa(nfa);
+
+    // The match starting first wins even when a later one would end earlier or run longer.
+    EXPECT_EQ(dfa.FindEnd("zzabcdefg"), 6);
+    EXPECT_EQ(dfa.FindEnd("zzabcx"), 5);
+    EXPECT_EQ(dfa.FindEnd("xxxy"), 4);
+    EXPECT_EQ(dfa.FindEnd("xxxz"), 0);
+
+    LazyDFA reverse(nfa.Reverse());
+
+    EXPECT_EQ(reverse.LongestMatchBackward("zzabcd"), 4);
+    EXPECT_EQ(reverse.LongestMatchBackward("zzxxxy"), 4);
+    EXPECT_EQ(reverse.LongestMatchBackward("zzabc"), 2);
+}
\ No newline at end of file
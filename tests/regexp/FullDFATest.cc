@@ -0,0 +1,110 @@
+#include <gtest/gtest.h>
+#include "FullDFA.h"
+#include "RegExp.h"
+#include "TestPatterns.h"
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class FullDFATest : public testing::Test
+{};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(FullDFATest, AgreesWithNFA)
+{
+    const std::vector<std::string> patterns = {
+        "(ab|a)*", "(a(|b))*", "abcd|xyz", "[A-Za-z_][A-Za-z0-9_]*", "(a|b)*a(a|b)(a|b)", "x*|y+z?"
+    };
+    const std::vector<std::string> inputs = {
+        "", "a", "ab", "aba", "abb", "abcd", "xyz", "xy", "_id42", "4id", "babba", "aaab", "xxx", "yyz"
+    };
+
+    for (auto& pattern : patterns)
+    {
+        auto nfa = CompileNfa(pattern);
+        auto dfa = FullDFA::Make(nfa);
+
+        ASSERT_TRUE(dfa.has_value());
+
+        for (auto& input : inputs)
+        {
+            EXPECT_EQ(dfa->Accepts(input), nfa.Accepts(input)) << pattern << " on " << input;
+            EXPECT_EQ(dfa->LongestMatch(input), nfa.LongestMatch(input).size()) << pattern << " on " << input;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(FullDFATest, Minimization)
+{
+    // The subset construction gives a separate state for every combination of the last three bytes.
+    auto dfa = FullDFA::Make(CompileNfa("(a|b)*a(a|b)(a|b)"));
+    auto& stats = dfa->GetStats();
+
+    EXPECT_EQ(stats.minimizedStates, 9);
+    EXPECT_LE(stats.minimizedStates, stats.subsetStates);
+    // Transitions, tag offsets, and one tag for each of the four final states.
+    EXPECT_EQ(stats.tableBytes, 9 * 3 * sizeof(FullDFA::StateId) + 10 * sizeof(uint32_t) + 4 * sizeof(uint32_t));
+
+    // Spellings of the same language end up with the same states, states that cannot reach a final one are dead.
+    EXPECT_EQ(FullDFA::Make(CompileNfa("(a|b)*abb"))->StateCount(), 5);
+    EXPECT_EQ(FullDFA::Make(CompileNfa("(a|b)*a(b|b)b"))->StateCount(), 5);
+    EXPECT_EQ(FullDFA::Make(CompileNfa("ab|ac|ad"))->StateCount(), FullDFA::Make(CompileNfa("a[b-d]"))->StateCount());
+
+    EXPECT_FALSE(FullDFA::Make(CompileNfa("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)"), 32).has_value());
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(FullDFATest, RegExpFullMode)
+{
+    RegExp lazy("(a|b)*a(a|b)(a|b)|[0-9]+");
+    RegExp full("(a|b)*a(a|b)(a|b)|[0-9]+", RegExp::DfaMode::Full);
+
+    EXPECT_TRUE(full.Stats().isFullDfa);
+    EXPECT_FALSE(lazy.Stats().isFullDfa);
+    EXPECT_GT(full.Stats().dfaTableBytes, 0);
+    EXPECT_EQ(full.Stats().minimizedDfaStates, 11);
+
+    const std::string str = "xxbabba 42 aab abab 7a";
+
+    EXPECT_EQ(full.FindMatches(str), lazy.FindMatches(str));
+    EXPECT_TRUE(full.Matches("babb"));
+    EXPECT_FALSE(full.Matches("babbb"));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(FullDFATest, FullModeSearchDfas)
+{
+    const std::vector<std::string> patterns = {
+        "(a|b)*c", "a+|b", "x*", "[0-9]+(\\.[0-9]+)?", "(ab|a)(bc|c)?", "ab|abcd"
+    };
+    const std::vector<std::string> inputs = {
+        "", "abababc", "xxaabxx", "3.14 and 42.", "abcd abc ab", "bbbx", "cabcc"
+    };
+
+    for (auto& pattern : patterns)
+    {
+        RegExp lazy(pattern);
+        RegExp full(pattern, RegExp::DfaMode::Full);
+
+        EXPECT_TRUE(full.Stats().isFullSearchDfa) << pattern;
+        EXPECT_FALSE(lazy.Stats().isFullSearchDfa) << pattern;
+        EXPECT_GT(full.Stats().searchDfaTableBytes, 0) << pattern;
+
+        for (auto& input : inputs)
+            EXPECT_EQ(full.FindMatches(input), lazy.FindMatches(input)) << pattern << " on " << input;
+    }
+
+    // The minimized leftmost DFA still has a start state of its own, and so it never ends a match it has not begun.
+    auto leftmostDfa = FullDFA::MakeLeftmost(CompileNfa("(a|b)*a"));
+
+    ASSERT_TRUE(leftmostDfa.has_value());
+    EXPECT_FALSE(leftmostDfa->IsFinal(leftmostDfa->Start()));
+    EXPECT_FALSE(FullDFA::MakeLeftmost(CompileNfa("(a|b)*a(a|b)(a|b)(a|b)(a|b)(a|b)"), 32).has_value());
+}
\ No newline at end of file
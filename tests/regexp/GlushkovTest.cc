@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+#include "Glushkov.h"
+#include "Lexer.h"
+#include "RegExp.h"
+#include "RegexSet.h"
+#include "TestPatterns.h"
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class GlushkovTest : public testing::Test
+{
+protected:
+    static Glushkov Compile(std::string_view pattern)
+    {
+        return CompileGlushkov(pattern);
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(GlushkovTest, SymbolAlternationsSharePositions)
+{
+    auto glushkov = Compile("[A-Za-z_][A-Za-z0-9_]*");
+
+    EXPECT_EQ(glushkov.Size(), 2);
+    EXPECT_EQ(glushkov.Symbols(0).count(), 53);
+    EXPECT_EQ(glushkov.Symbols(1).count(), 63);
+    EXPECT_FALSE(glushkov.Root().nullable);
+
+    EXPECT_EQ(Compile("(ab|a)*").Size(), 3);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(GlushkovTest, AgreesWithNFA)
+{
+    std::vector<std::string> patterns = {
+        "(ab|a)*", "(a(|b))*", "abcd|xyz", "[A-Za-z_][A-Za-z0-9_]*", "(a|b)*a(a|b)(a|b)(a|b)", "a+b?c*",
+        "((a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b)(a|b))+"
+    };
+    std::vector<std::string> inputs = {
+        "", "a", "ab", "aba", "abb", "abcd", "xyz", "xy", "_id42", "4id", "aaab", "abbbaaab", "aabcc",
+        "abababababababababab", "ababababababababababbbbbbbbbbbbbbbbbbbbb", "abababababababababa"
+    };
+
+    // More than 64 positions, so the active set spans two words.
+    std::string wide;
+
+    for (size_t i = 0; i < 35; ++i)
+        wide += "(a|b)c";
+
+    patterns.push_back(wide + "*");
+    inputs.push_back(std::string(35 * 2, 'a'));
+
+    for (size_t i = 0; i < 35; ++i)
+        inputs.back()[i * 2 + 1] = 'c';
+
+    for (auto& pattern : patterns)
+    {
+        auto nfa = CompileNfa(pattern);
+
+        BitParallelMatcher matcher(Compile(pattern));
+
+        for (auto& input : inputs)
+        {
+            EXPECT_EQ(matcher.Accepts(input), nfa.Accepts(input)) << pattern << " on " << input;
+            EXPECT_EQ(matcher.LongestMatch(input), nfa.LongestMatchLength(input)) << pattern << " on " << input;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(GlushkovTest, SkipsNeverEnterLoops)
+{
+    // Every epsilon edge that skips a body has to end in a state outside of the loops of the body, or (ba+)?c reads
+    // the a of "ac" in the loop of a+ without the b before it. The positions have no such edges to get wrong.
+    const std::vector<std::string> patterns = {
+        "(ba+)?c", "(ba*)?c", "(ba+)?", "(|ba+)c", "(x(a)+)?", "((ba){2,})?c", "(b(a+)+)*c", "(ba+|c)?a"
+    };
+    const std::vector<std::string> inputs = {
+        "", "a", "c", "ac", "aac", "bac", "baac", "bc", "babac", "ba", "b", "x", "xa", "xaa", "aa", "bacac", "baa"
+    };
+
+    for (auto& pattern : patterns)
+    {
+        auto nfa = CompileNfa(pattern);
+        auto dfa = FullDFA::Make(nfa);
+
+        BitParallelMatcher matcher(Compile(pattern));
+        RegexSet set({ pattern });
+        Lexer lexer({ { pattern, 0 } });
+
+        ASSERT_TRUE(dfa.has_value());
+
+        for (auto& input : inputs)
+        {
+            auto accepts = matcher.Accepts(input);
+
+            EXPECT_EQ(nfa.Accepts(input), accepts) << pattern << " on " << input;
+            EXPECT_EQ(dfa->Accepts(input), accepts) << pattern << " on " << input;
+            EXPECT_EQ(RegExp(pattern, RegExp::DfaMode::Full).Matches(input), accepts) << pattern << " on " << input;
+            EXPECT_EQ(set.Matches(input).size(), accepts ? 1 : 0) << pattern << " on " << input;
+            EXPECT_EQ(lexer.Next(input).length, matcher.LongestMatch(input)) << pattern << " on " << input;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(GlushkovTest, LargePatternsFallBack)
+{
+    std::string pattern;
+
+    for (size_t i = 0; i < BitParallelMatcher::kMaxPositions + 1; ++i)
+        pattern += "ab"[i % 2];
+
+    EXPECT_FALSE(BitParallelMatcher::Make(Compile(pattern)).has_value());
+    EXPECT_THROW(BitParallelMatcher matcher(Compile(pattern)), std::invalid_argument);
+
+    RegExp regexp(pattern);
+
+    EXPECT_TRUE(regexp.Matches(pattern));
+    EXPECT_EQ(regexp.FindMatches("x" + pattern + pattern).size(), 2);
+}
\ No newline at end of file
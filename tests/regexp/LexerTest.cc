@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+#include "Lexer.h"
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class LexerTest : public testing::Test
+{
+protected:
+    enum Kind : uint32_t
+    {
+        Space,
+        If,
+        In,
+        Identifier,
+        Number,
+        Less,
+        LessEqual,
+        Shift
+    };
+
+    Lexer lexer_{{
+        { " +", Space },
+        { "if", If },
+        { "in", In },
+        { "[a-z]+", Identifier },
+        { "[0-9]+", Number },
+        { "<", Less },
+        { "<=", LessEqual },
+        { "<<", Shift }
+    }};
+
+    std::vector<std::pair<uint32_t, std::string>> Tokenize(std::string_view str) const
+    {
+        std::vector<std::pair<uint32_t, std::string>> result;
+
+        for (size_t pos = 0; pos < str.size();)
+        {
+            auto [kind, length] = lexer_.Next(str, pos);
+
+            if (kind == Lexer::kNoMatch)
+                break;
+
+            if (kind != Space)
+                result.emplace_back(kind, std::string(str.substr(pos, length)));
+
+            pos += length;
+        }
+
+        return result;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(LexerTest, MaximalMunchAndPriority)
+{
+    using Tokens = std::vector<std::pair<uint32_t, std::string>>;
+
+    EXPECT_EQ(Tokenize("if in inner"), Tokens({ { If, "if" }, { In, "in" }, { Identifier, "inner" } }));
+    EXPECT_EQ(Tokenize("x<=1<<2<3"), Tokens({
+        { Identifier, "x" }, { LessEqual, "<=" }, { Number, "1" }, { Shift, "<<" },
+        { Number, "2" }, { Less, "<" }, { Number, "3" }
+    }));
+
+    auto none = lexer_.Next("?", 0);
+
+    EXPECT_EQ(none.kind, Lexer::kNoMatch);
+    EXPECT_EQ(none.length, 0);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(LexerTest, Minimized)
+{
+    // Different spellings of the same language collapse into the same states.
+    Lexer same({ { "(a|b)*abb", 1 } });
+    Lexer other({ { "(a|b)*a(b|b)b", 1 } });
+
+    EXPECT_EQ(same.StateCount(), 5);
+    EXPECT_EQ(other.StateCount(), 5);
+
+    EXPECT_EQ(same.Next("babaabbab").length, 7);
+    EXPECT_EQ(same.Next("babaabbab").kind, 1);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(LexerTest, RepetitionLimit)
+{
+    EXPECT_THROW(Lexer({ { "[a-z]+", 1 }, { "((a{100}){100}){100}", 2 } }), std::runtime_error);
+
+    Lexer raised({ { "(a{10}){20}", 2 }, { "[a-z]+", 1 } }, 200);
+
+    EXPECT_EQ(raised.Next(std::string(200, 'a')).kind, 2);
+    EXPECT_EQ(raised.Next(std::string(201, 'a')).kind, 1);
+}
\ No newline at end of file
@@ -1,7 +1,10 @@
 #include <gtest/gtest.h>
+#include "Ast.h"
 #include "NFA.h"
+#include "TestPatterns.h"
 
 using namespace Regex;
+using namespace Regex::Testing;
 
 // ---------------------------------------------------------------------------------------------------------------------
 
@@ -77,4 +80,159 @@ TEST_F(NFATest, HasFreeMovesAndAcceptsString)
     EXPECT_FALSE(nfaB_.Accepts("a"));
     EXPECT_FALSE(nfaB_.Accepts("aaaaa"));
     EXPECT_FALSE(nfaB_.Accepts("aaaaaaa"));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(NFATest, ArenaLayout)
+{
+    EXPECT_EQ(nfaA_.Size(), 4);
+    EXPECT_EQ(nfaA_.Transitions(0).size(), 3);
+    EXPECT_TRUE(nfaA_.EpsilonTransitions(0).empty());
+
+    EXPECT_EQ(nfaB_.EpsilonTransitions(0).size(), 2);
+    EXPECT_TRUE(nfaB_.Transitions(0).empty());
+    EXPECT_TRUE(nfaB_.IsFinal(1));
+    EXPECT_FALSE(nfaB_.IsFinal(2));
+
+    // Transitions added after a read are folded into the arena on the next one.
+    EXPECT_FALSE(nfaB_.Accepts("a"));
+
+    auto state = nfaB_.AddState();
+    nfaB_.AddTransition(0, 'a', state);
+    nfaB_.AddFinalStates({ state });
+
+    EXPECT_TRUE(nfaB_.Accepts("a"));
+    EXPECT_EQ(nfaB_.Transitions(0).size(), 1);
+    EXPECT_EQ(nfaB_.Transitions(0)[0].target, state);
+
+    EXPECT_THROW(nfaB_.AddTransition(0, 'a', 42), std::invalid_argument);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(NFATest, NestedOptionalsStayLinear)
+{
+    // (a?){n}a{n} takes exponential time with backtracking, the thread lists keep it at O(n * m).
+    constexpr size_t n = 200;
+
+    auto pattern = EmptyAst::Make();
+
+    for (size_t i = 0; i < n; ++i)
+        pattern = ConcatenationAst::Make(pattern, OptionalAst::Make(SymbolAst::Make('a')));
+
+    for (size_t i = 0; i < n; ++i)
+        pattern = ConcatenationAst::Make(pattern, SymbolAst::Make('a'));
+
+    auto nfa = pattern->ToNFA();
+    std::string input(n, 'a');
+
+    EXPECT_TRUE(nfa.Accepts(input));
+    EXPECT_FALSE(nfa.Accepts(input.substr(1)));
+    EXPECT_EQ(nfa.LongestMatchLength(input + input + "b"), 2 * n);
+    EXPECT_EQ(nfa.FindMatches(input + "b" + input).size(), 2);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(NFATest, ClassIsSingleTransition)
+{
+    auto word = CharClass::Word();
+    auto pattern = ConcatenationAst::Make(CharSetAst::Make(word), RepetitionAst::Make(CharSetAst::Make(word)));
+    auto nfa = pattern->ToNFA();
+
+    // Two states per class, and an entry and an exit of the closure.
+    EXPECT_EQ(nfa.Size(), 6);
+    EXPECT_EQ(nfa.CharSetCount(), 1);
+    EXPECT_EQ(nfa.Transitions(nfa.Start()).size(), 1);
+
+    EXPECT_TRUE(nfa.Accepts("x_42"));
+    EXPECT_FALSE(nfa.Accepts("x-42"));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(NFATest, EpsilonElimination)
+{
+    const std::vector<std::string> patterns = { "(ab|a)*", "(a(|b))*c?", "abcd|xyz", "[a-z_][a-z0-9_]*", "((a*)*b)*" };
+    const std::vector<std::string> inputs = { "", "a", "ab", "aba", "abc", "abcd", "xyz", "_id42", "aabab", "bbb" };
+
+    for (auto& pattern : patterns)
+    {
+        auto nfa = CompileNfa(pattern);
+        auto eliminated = nfa.EliminateEpsilon();
+
+        EXPECT_LT(eliminated.Size(), nfa.Size()) << pattern;
+
+        for (StateId state = 0; state < eliminated.Size(); ++state)
+            EXPECT_TRUE(eliminated.EpsilonTransitions(state).empty()) << pattern;
+
+        for (auto& input : inputs)
+        {
+            EXPECT_EQ(eliminated.Accepts(input), nfa.Accepts(input)) << pattern << " on " << input;
+            EXPECT_EQ(eliminated.LongestMatchLength(input), nfa.LongestMatchLength(input)) << pattern << " on " << input;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(NFATest, EpsilonEliminationKeepsEveryTag)
+{
+    // Tagged like the patterns of a RegexSet. Every pattern matches the empty string and "ab", so the closures of the
+    // start state and of the state after "ab" hold a final state of each of them.
+    const std::vector<std::string> patterns = { "(ab)*", "a*b*", "(a|b)*c?" };
+    const std::vector<std::string> inputs = { "", "a", "ab", "abab", "b", "ba", "abc", "c", "aabb", "x" };
+
+    NFA nfa(0);
+    nfa.SetStart(nfa.AddState());
+
+    for (uint32_t tag = 0; tag < patterns.size(); ++tag)
+    {
+        auto fragment = ParsePattern(patterns[tag])->BuildNFA(nfa);
+
+        nfa.AddEpsilonTransition(nfa.Start(), fragment.start);
+        nfa.SetFinalTag(fragment.end, tag);
+    }
+
+    auto eliminated = nfa.EliminateEpsilon();
+    auto tags = eliminated.FinalTags(eliminated.Start());
+
+    EXPECT_EQ(std::vector(tags.begin(), tags.end()), (std::vector<uint32_t>{ 0, 1, 2 }));
+
+    for (auto& input : inputs)
+    {
+        EXPECT_EQ(eliminated.MatchingTags(input), nfa.MatchingTags(input)) << input;
+        EXPECT_EQ(eliminated.LongestMatchPerTag(input, 3), nfa.LongestMatchPerTag(input, 3)) << input;
+    }
+
+    EXPECT_EQ(eliminated.MatchingTags("ab"), (std::vector<uint32_t>{ 0, 1, 2 }));
+    EXPECT_EQ(eliminated.MatchingTags("ba"), (std::vector<uint32_t>{ 2 }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(NFATest, Reverse)
+{
+    const std::vector<std::string> patterns = { "(ab|a)*c", "abcd|xyz", "[a-z_][a-z0-9_]*", "a(b|cd)*e?" };
+    const std::vector<std::string> inputs = { "", "c", "abac", "abcd", "xyz", "zyx", "_id42", "abcdcde", "ecdcdba" };
+
+    for (auto& pattern : patterns)
+    {
+        auto nfa = CompileNfa(pattern);
+        auto reversed = nfa.Reverse();
+
+        for (auto& input : inputs)
+            EXPECT_EQ(reversed.Accepts(std::string(input.rbegin(), input.rend())), nfa.Accepts(input))
+                << pattern << " on " << input;
+    }
+
+    // Every prefix of a match, the empty one included, and nothing else.
+    auto prefixes = CompileNfa("ab(c|de)").ReversePrefixes();
+
+    for (std::string input : { "", "a", "ab", "abc", "abd", "abde" })
+        EXPECT_TRUE(prefixes.Accepts(std::string(input.rbegin(), input.rend()))) << input;
+
+    for (std::string input : { "b", "ac", "abe", "abcd" })
+        EXPECT_FALSE(prefixes.Accepts(std::string(input.rbegin(), input.rend()))) << input;
 }
\ No newline at end of file
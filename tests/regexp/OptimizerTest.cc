@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "Glushkov.h"
+#include "Optimizer.h"
+#include "TestPatterns.h"
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class OptimizerTest : public testing::Test
+{
+protected:
+    OptimizerTest() = default;
+    ~OptimizerTest() override = default;
+
+protected:
+    static std::string Optimized(const std::string& pattern)
+    {
+        return Optimizer(ParsePattern(pattern)).Result()->ToString();
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(OptimizerTest, Rewrites)
+{
+    EXPECT_EQ(Optimized("a|b|c|x"), "[a-cx]");
+    EXPECT_EQ(Optimized("abc|abd"), "ab[cd]");
+    EXPECT_EQ(Optimized("abc|x|abd|y"), "ab[cd]|[xy]");
+    EXPECT_EQ(Optimized("if|in|int"), "i(f|nt?)");
+    EXPECT_EQ(Optimized("(a*)*"), "a*");
+    EXPECT_EQ(Optimized("((a+)?)+b"), "a*b");
+    EXPECT_EQ(Optimized("(|a)(|b)"), "a?b?");
+    EXPECT_EQ(Optimized("a|a|ab"), "ab?");
+    EXPECT_EQ(Optimized("[a]"), "a");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(OptimizerTest, FlattensChains)
+{
+    auto pattern = Optimizer(ParsePattern("(ab)(cd)|e(f|(g|h))")).Result();
+
+    ASSERT_EQ(pattern->Type(), AstNode::AstType::Alternation);
+
+    const auto& alternatives = static_cast<const AlternationAst&>(*pattern).Patterns();
+
+    ASSERT_EQ(alternatives.size(), 2);
+    ASSERT_EQ(alternatives[0]->Type(), AstNode::AstType::Concatenation);
+    EXPECT_EQ(static_cast<const ConcatenationAst&>(*alternatives[0]).Patterns().size(), 4);
+    EXPECT_EQ(alternatives[1]->ToString(), "e[f-h]");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(OptimizerTest, PreservesLanguage)
+{
+    const std::vector<std::string> patterns =
+    {
+        "abc|abd|ab|b", "(a|b)*(ab|ac|a)", "((a*)*|b+)?c", "(|a)(|b)(|c)", "(ab|a)(|bc|b)d?", "a+|a*|a?b",
+        "(|ba+)c", "(x(a)+)?"
+    };
+
+    std::vector<std::string> inputs = { "" };
+
+    for (size_t begin = 0, length = 0; length < 5; ++length)
+    {
+        size_t end = inputs.size();
+
+        for (size_t i = begin; i < end; ++i)
+            for (char ch : std::string("abcdx"))
+                inputs.push_back(inputs[i] + ch);
+
+        begin = end;
+    }
+
+    for (auto& pattern : patterns)
+    {
+        auto node = ParsePattern(pattern);
+        auto optimizedNfa = Optimizer(node).Result()->ToNFA();
+
+        // The positions of the original pattern, since the NFA of both would share any flaw of the construction.
+        Glushkov glushkov;
+        glushkov.SetRoot(node->BuildPositions(glushkov));
+
+        BitParallelMatcher matcher(glushkov);
+
+        for (auto& input : inputs)
+            EXPECT_EQ(matcher.Accepts(input), optimizedNfa.Accepts(input)) << pattern << " on '" << input << "'";
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(OptimizerTest, ShrinksAutomaton)
+{
+    auto node = ParsePattern("import|if|in|int|inline|else|elif|a|b|c");
+    auto optimized = Optimizer(node).Result();
+
+    auto nfa = node->ToNFA();
+    auto optimizedNfa = optimized->ToNFA();
+
+    EXPECT_LT(optimizedNfa.Size() * 3, nfa.Size() * 2);
+
+    for (auto& word : { "import", "if", "in", "int", "inline", "else", "elif", "a", "b", "c" })
+        EXPECT_TRUE(optimizedNfa.Accepts(word)) << word;
+
+    for (auto& word : { "", "i", "inl", "el", "ab" })
+        EXPECT_FALSE(optimizedNfa.Accepts(word)) << word;
+}
\ No newline at end of file
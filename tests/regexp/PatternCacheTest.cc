@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "PatternCache.h"
+#include "RegExp.h"
+
+#include <thread>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class PatternCacheTest : public testing::Test
+{
+protected:
+    PatternCacheTest() = default;
+    ~PatternCacheTest() override = default;
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PatternCacheTest, HitsAndMisses)
+{
+    PatternCache cache;
+
+    auto first = cache.Get("[0-9]+");
+    auto second = cache.Get("[0-9]+");
+    auto third = cache.Get("(ab)*");
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, third);
+    EXPECT_TRUE(first->Matches("42"));
+
+    auto stats = cache.GetStats();
+
+    EXPECT_EQ(stats.hits, 1);
+    EXPECT_EQ(stats.misses, 2);
+    EXPECT_EQ(stats.evictions, 0);
+    EXPECT_EQ(stats.size, 2);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PatternCacheTest, EvictsLeastRecentlyUsed)
+{
+    PatternCache cache(2);
+
+    auto a = cache.Get("a");
+    cache.Get("b");
+    cache.Get("a");
+    cache.Get("c");
+
+    EXPECT_EQ(cache.GetStats().evictions, 1);
+    EXPECT_EQ(cache.Get("a"), a);
+    EXPECT_EQ(cache.GetStats().misses, 3);
+
+    cache.Get("b");
+    EXPECT_EQ(cache.GetStats().misses, 4);
+
+    // Handles outlive their eviction.
+    cache.SetCapacity(0);
+
+    EXPECT_EQ(cache.GetStats().size, 0);
+    EXPECT_TRUE(a->Matches("a"));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PatternCacheTest, SharedBetweenThreads)
+{
+    PatternCache cache(4);
+    std::vector<std::thread> threads;
+
+    // The second pattern is too large for the bit-parallel matcher and goes through the guarded DFA.
+    const std::vector<std::pair<std::string, std::string>> patterns = {
+        { "[A-Za-z_][A-Za-z0-9_]*", "ident_42" },
+        { std::string(200, 'a') + "b*", std::string(200, 'a') + "bb" }
+    };
+
+    for (size_t id = 0; id < 8; ++id)
+    {
+        threads.emplace_back([&cache, &patterns]
+        {
+            for (size_t i = 0; i < 200; ++i)
+            {
+                auto& [pattern, match] = patterns[i % patterns.size()];
+                auto regexp = cache.Get(pattern);
+
+                EXPECT_EQ(regexp->LongestMatch(match + " tail"), match);
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    auto stats = cache.GetStats();
+
+    EXPECT_EQ(stats.hits + stats.misses, 8 * 200);
+    EXPECT_EQ(stats.size, 2);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PatternCacheTest, CompileUsesProcessCache)
+{
+    auto before = PatternCache::Instance().GetStats();
+
+    auto first = RegExp::Compile("x(y|z)+");
+    auto second = RegExp::Compile("x(y|z)+");
+
+    EXPECT_EQ(first, second);
+    EXPECT_GE(PatternCache::Instance().GetStats().hits, before.hits + 1);
+}
\ No newline at end of file
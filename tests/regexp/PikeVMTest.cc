@@ -0,0 +1,111 @@
+#include <gtest/gtest.h>
+#include "PikeVM.h"
+#include "TestPatterns.h"
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class PikeVMTest : public testing::Test
+{
+protected:
+    using Slots = std::vector<size_t>;
+
+    constexpr static size_t kNone = CaptureProgram::kNoPosition;
+
+protected:
+    static CaptureProgram Compile(const std::string& pattern)
+    {
+        size_t groupCount = 0;
+        auto ast = ParsePattern(pattern, &groupCount);
+
+        return CaptureProgram(ast, groupCount);
+    }
+
+    static std::optional<Slots> Run(const PikeVM& vm, std::string_view str)
+    {
+        PikeVM::Scratch scratch;
+        Slots slots(vm.Program().SlotCount());
+
+        if (!vm.Match(str, slots, scratch))
+            return std::nullopt;
+
+        return slots;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PikeVMTest, Priority)
+{
+    PikeVM alternatives(Compile("(a|ab)(c|bcd)(d*)"));
+
+    EXPECT_EQ(alternatives.Program().GroupCount(), 3);
+    EXPECT_EQ(Run(alternatives, "abcd"), (Slots{ 0, 4, 0, 1, 1, 4, 4, 4 }));
+    EXPECT_EQ(Run(alternatives, "abcdd"), (Slots{ 0, 5, 0, 1, 1, 4, 4, 5 }));
+    EXPECT_EQ(Run(alternatives, "acdd"), (Slots{ 0, 4, 0, 1, 1, 2, 2, 4 }));
+    EXPECT_EQ(Run(alternatives, "abd"), std::nullopt);
+
+    // Closures repeat as often as the rest of the string allows, the group keeps its last iteration.
+    PikeVM closures(Compile("(a*)(a|b)*((ab)+)"));
+
+    EXPECT_EQ(Run(closures, "aaabab"), (Slots{ 0, 6, 0, 3, 3, 4, 4, 6, 4, 6 }));
+    EXPECT_EQ(Run(closures, "aabbab"), (Slots{ 0, 6, 0, 2, 3, 4, 4, 6, 4, 6 }));
+
+    PikeVM optional(Compile("(x)?(y){2}|(z)"));
+
+    EXPECT_EQ(Run(optional, "yy"), (Slots{ 0, 2, kNone, kNone, 1, 2, kNone, kNone }));
+    EXPECT_EQ(Run(optional, "z"), (Slots{ 0, 1, kNone, kNone, kNone, kNone, 0, 1 }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PikeVMTest, EmptyLoopsTerminate)
+{
+    PikeVM nested(Compile("((a*)*|b)*c"));
+
+    EXPECT_EQ(Run(nested, "aabac"), (Slots{ 0, 5, 3, 4, 3, 4 }));
+    EXPECT_EQ(Run(nested, "c"), (Slots{ 0, 1, kNone, kNone, kNone, kNone }));
+
+    // Every thread is added once per position, so an ambiguous pattern on a long input takes linear time.
+    PikeVM ambiguous(Compile("(a|aa|a*)*(b)"));
+    std::string str(20000, 'a');
+
+    EXPECT_EQ(Run(ambiguous, str), std::nullopt);
+    EXPECT_EQ(Run(ambiguous, str + "b"), (Slots{ 0, 20001, 19999, 20000, 20000, 20001 }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PikeVMTest, OnePass)
+{
+    const std::vector<std::string> patterns = { "a(b|c)*d", "([a-z]+)=([0-9]+)", "((a)|b)+c", "(x)?y{2,3}(z)?" };
+    const std::vector<std::string> inputs = { "ad", "abcbd", "key=42", "abbac", "bc", "yy", "xyyyz", "xyyyy", "a=" };
+
+    for (auto& pattern : patterns)
+    {
+        auto program = Compile(pattern);
+        auto onePass = OnePassMatcher::Make(program);
+
+        ASSERT_TRUE(onePass.has_value()) << pattern;
+
+        PikeVM vm(std::move(program));
+
+        for (auto& input : inputs)
+        {
+            Slots slots(vm.Program().SlotCount());
+            auto expected = Run(vm, input);
+
+            EXPECT_EQ(onePass->Match(input, slots), expected.has_value()) << pattern << " on " << input;
+
+            if (expected.has_value())
+            {
+                EXPECT_EQ(slots, *expected) << pattern << " on " << input;
+            }
+        }
+    }
+
+    for (auto& pattern : { "(a|ab)(c|bcd)", "(a*)(a*)", "(a|b)*(b)", "((a*)*|b)*c" })
+        EXPECT_FALSE(OnePassMatcher::Make(Compile(pattern)).has_value()) << pattern;
+}
\ No newline at end of file
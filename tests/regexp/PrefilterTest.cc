@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include "Prefilter.h"
+#include "RegExp.h"
+#include "TestPatterns.h"
+
+#include <random>
+
+using namespace Regex;
+using namespace Regex::Testing;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class PrefilterTest : public testing::Test
+{
+protected:
+    static Prefilter Make(std::string_view pattern)
+    {
+        return Prefilter::Make(CompileGlushkov(pattern));
+    }
+
+    // FindMatches without any prefilter.
+    static RegExp::MatchList FindAll(const RegExp& regexp, const std::string& str)
+    {
+        RegExp::MatchList result;
+
+        for (size_t pos = 0; pos < str.size();)
+        {
+            auto match = regexp.LongestMatch(str, pos);
+
+            if (match.empty())
+            {
+                ++pos;
+                continue;
+            }
+
+            result.emplace_back(pos, match);
+            pos += match.size();
+        }
+
+        return result;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PrefilterTest, Extraction)
+{
+    EXPECT_EQ(Make("error: [0-9]+").GetKind(), Prefilter::Kind::Literal);
+    EXPECT_EQ(Make("error: [0-9]+").Prefix(), "error: ");
+    EXPECT_EQ(Make("ab+c").Prefix(), "ab");
+    EXPECT_EQ(Make("abc|abd").GetKind(), Prefilter::Kind::FewBytes);
+    EXPECT_EQ(Make("x|y|z*").GetKind(), Prefilter::Kind::FewBytes);
+    EXPECT_EQ(Make("[A-Za-z_][A-Za-z0-9_]*").GetKind(), Prefilter::Kind::ByteSet);
+    EXPECT_EQ(Make(".*").GetKind(), Prefilter::Kind::ByteSet);
+    EXPECT_EQ(Make("[^a]|a").GetKind(), Prefilter::Kind::None);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PrefilterTest, FindsCandidates)
+{
+    std::string text(100, '.');
+    text.replace(37, 5, "needl");
+    text.replace(70, 6, "needle");
+
+    auto literal = Make("needle");
+
+    EXPECT_EQ(literal.Find(text, 0), 70);
+    EXPECT_EQ(literal.Find(text, 71), std::string_view::npos);
+
+    auto fewBytes = Make("x|y");
+    text[95] = 'y';
+
+    EXPECT_EQ(fewBytes.Find(text, 0), 95);
+    EXPECT_EQ(fewBytes.Find(text, 96), std::string_view::npos);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(PrefilterTest, AgreesWithPlainSearch)
+{
+    const std::vector<std::string> patterns = {
+        "ab+c", "abc|abd", "x|y|z*", "[A-Za-z_][A-Za-z0-9_]*", "cab*", "(ab|a)*", "b[ac]+", "aa"
+    };
+
+    std::mt19937 random(42);
+    std::string text;
+
+    for (size_t i = 0; i < 2000; ++i)
+        text += "abcdxyz"[random() % 7];
+
+    for (auto& pattern : patterns)
+    {
+        RegExp regexp(pattern);
+        EXPECT_EQ(regexp.FindMatches(text), FindAll(regexp, text)) << pattern;
+    }
+}
\ No newline at end of file
@@ -3,6 +3,11 @@
 #include "Parser.h"
 #include "Scanner.h"
 
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <thread>
+
 using namespace Regex;
 
 // ---------------------------------------------------------------------------------------------------------------------
@@ -267,4 +272,379 @@ TEST_F(RegExpSearchTest, RegExpD_FindMatches)
     {
         EXPECT_TRUE(matchesE.size() == 0);
     }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, CharacterClasses)
+{
+    RegExp identifier("[A-Za-z_][A-Za-z0-9_]*");
+
+    auto matchesA = identifier.FindMatches("var x_1 = y2 + 42;");
+    {
+        EXPECT_EQ(matchesA.size(), 3);
+        EXPECT_TRUE(matchesA[1] == Match({4, "x_1"}));
+    }
+
+    RegExp negated(R"([^\s;]+)");
+
+    auto matchesB = negated.FindMatches("a = b;\tc");
+    {
+        EXPECT_EQ(matchesB.size(), 4);
+        EXPECT_TRUE(matchesB[1] == Match({2, "="}));
+        EXPECT_TRUE(matchesB[3] == Match({7, "c"}));
+    }
+
+    RegExp dot(R"(\d+\.\d*|a.c)");
+
+    EXPECT_TRUE(dot.Matches("3.14"));
+    EXPECT_TRUE(dot.Matches("3."));
+    EXPECT_TRUE(dot.Matches("a.c"));
+    EXPECT_TRUE(dot.Matches("a+c"));
+
+    EXPECT_FALSE(dot.Matches("3"));
+    EXPECT_FALSE(dot.Matches("3x14"));
+    EXPECT_FALSE(dot.Matches("a\nc"));
+
+    RegExp word(R"(\w+\W\w+)");
+
+    EXPECT_TRUE(word.Matches("ab_9+cd"));
+    EXPECT_FALSE(word.Matches("ab cd ef"));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, CountedRepetition)
+{
+    RegExp date(R"(\d{4}-\d{2}-\d{2})");
+
+    auto matches = date.FindMatches("from 2024-01-31 to 2024-1-2 or 12024-02-290");
+    {
+        EXPECT_EQ(matches.size(), 2);
+        EXPECT_TRUE(matches[0] == Match({5, "2024-01-31"}));
+        EXPECT_TRUE(matches[1] == Match({32, "2024-02-29"}));
+    }
+
+    RegExp bounded("x{2,3}y{1,}");
+
+    EXPECT_TRUE(bounded.Matches("xxy"));
+    EXPECT_TRUE(bounded.Matches("xxxyyy"));
+    EXPECT_FALSE(bounded.Matches("xy"));
+    EXPECT_FALSE(bounded.Matches("xxxxy"));
+    EXPECT_FALSE(bounded.Matches("xxx"));
+
+    // Too many positions for the bit-parallel matcher.
+    RegExp wide("[ab]{150,200}c");
+
+    EXPECT_FALSE(wide.Stats().isBitParallel);
+    EXPECT_TRUE(wide.Matches(std::string(150, 'a') + "c"));
+    EXPECT_TRUE(wide.Matches(std::string(200, 'b') + "c"));
+    EXPECT_FALSE(wide.Matches(std::string(149, 'a') + "c"));
+    EXPECT_FALSE(wide.Matches(std::string(201, 'a') + "c"));
+    EXPECT_EQ(wide.LongestMatch(std::string(180, 'a') + "cc").size(), 181);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, ParallelFindMatches)
+{
+    // Long runs of 'a' make matches cross the chunk boundaries, and "(ab|a)*b?" matches overlap what a chunk search
+    // started in the middle of a match would find.
+    std::string str;
+    std::mt19937 random(7);
+
+    while (str.size() < 4 * RegExp::kMinParallelChunk)
+    {
+        str += std::string(random() % 3000, 'a');
+        str += "b ab abab 12.5 ";
+        str += static_cast<char>('a' + random() % 4);
+    }
+
+    const std::vector<std::string> patterns = {
+        "a+", "(ab|a)*b?", "[0-9]+\\.?[0-9]*", "ab ", "(" + std::string(200, 'a') + ")+|b[ a]"
+    };
+
+    for (auto& pattern : patterns)
+    {
+        RegExp regexp(pattern);
+        auto expected = regexp.FindMatches(str);
+
+        for (size_t threadCount : { 0, 1, 2, 3, 4 })
+            EXPECT_EQ(regexp.FindMatchesParallel(str, threadCount), expected) << pattern << " / " << threadCount;
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, FindMatchesInFile)
+{
+    auto path = (std::filesystem::temp_directory_path() / "RegExpSearchTest.log").string();
+    std::string contents;
+
+    for (int idx = 0; idx < 1000; ++idx)
+        contents += std::format("{} INFO ok\n{} ERROR code={}\n", idx, idx, idx * 7);
+
+    std::ofstream(path, std::ios::binary) << contents;
+
+    RegExp regexp("ERROR code=[0-9]+");
+    RegExp::MatchRangeList expected;
+
+    for (auto& [pos, match] : regexp.FindMatches(contents))
+        expected.push_back({pos, match.size()});
+
+    EXPECT_EQ(expected.size(), 1000);
+    EXPECT_EQ(regexp.FindMatchesInFile(path), expected);
+
+    size_t count = 0;
+
+    regexp.FindMatchesInFile(path, [&](size_t offset, size_t length)
+    {
+        EXPECT_EQ(expected[count], RegExp::MatchRange({offset, length}));
+        ++count;
+    });
+
+    EXPECT_EQ(count, expected.size());
+
+    std::ofstream(path, std::ios::trunc);
+    EXPECT_TRUE(regexp.FindMatchesInFile(path).empty());
+
+    std::filesystem::remove(path);
+    EXPECT_THROW(regexp.FindMatchesInFile(path), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, ZeroCopyResults)
+{
+    const std::string str = "cabacabaabca";
+    std::string_view view = str;
+
+    auto ranges = reA_.FindMatchRanges(view);
+    auto matches = reA_.FindMatches(str);
+
+    ASSERT_EQ(ranges.size(), matches.size());
+
+    for (size_t idx = 0; idx < ranges.size(); ++idx)
+    {
+        EXPECT_EQ(ranges[idx].offset, matches[idx].first);
+        EXPECT_EQ(ranges[idx].Text(view), matches[idx].second);
+    }
+
+    auto longest = reA_.LongestMatchView(view, 5);
+
+    EXPECT_EQ(longest, "abaab");
+    EXPECT_EQ(longest.data(), str.data() + 5);
+    EXPECT_TRUE(reA_.LongestMatchView(view, 0).empty());
+
+    RegExp::MatchRangeList lazy;
+
+    for (auto& match : reA_.Search(view))
+        lazy.push_back(match);
+
+    EXPECT_EQ(lazy, ranges);
+
+    // Only the matches that are looked at are searched for.
+    auto it = reD_.Search("xxabcdxcdyy").begin();
+
+    EXPECT_EQ(*it, RegExp::MatchRange({2, 4}));
+    EXPECT_EQ((++it)->offset, 7);
+    EXPECT_TRUE(++it == std::default_sentinel);
+    EXPECT_TRUE(std::ranges::empty(reD_.Search("xyz")));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, ForwardAndReverseScan)
+{
+    // Each pattern is searched once with a forward and a reverse DFA and once with a budget too small for either, which
+    // tries one start position after another.
+    const std::vector<std::string> patterns =
+    {
+        "ab|bcde|c{2,130}", "abcd|c[a-d]{1,130}", "a|a*b|[b-d]{130,}", "(ab|a)*c|[a-c]{2,130}d", "[a-d ]{5,130}[0-9]"
+    };
+
+    std::mt19937 random(11);
+    std::string text;
+
+    for (size_t i = 0; i < 5000; ++i)
+        text += "abcdabcd01 "[random() % 11];
+
+    for (auto& pattern : patterns)
+    {
+        const RegExp regexp(pattern);
+        const RegExp reference(pattern, 1);
+
+        ASSERT_FALSE(regexp.Stats().isBitParallel) << pattern;
+
+        auto matches = regexp.FindMatches(text);
+
+        EXPECT_FALSE(matches.empty()) << pattern;
+        EXPECT_EQ(matches, reference.FindMatches(text)) << pattern;
+        EXPECT_EQ(regexp.FindMatchesParallel(text, 4), matches) << pattern;
+    }
+
+    // A long run of near misses is scanned once instead of once per start position.
+    const RegExp longRun("a{1,100}b|a{50,100}c");
+    std::string run(200000, 'a');
+
+    EXPECT_TRUE(longRun.FindMatches(run).empty());
+    EXPECT_EQ(longRun.FindMatches(run + "c"), (MatchList{ { 199900, std::string(100, 'a') + "c" } }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, LeftmostSearchOnEveryEngine)
+{
+    // Tried one start position after another, each search would read the run of 'a' once per position.
+    auto dfaPath = (std::filesystem::temp_directory_path() / "RegExpSearchTest.dfa").string();
+    auto runPath = (std::filesystem::temp_directory_path() / "RegExpSearchTest.run").string();
+
+    RegExp("[a-z]*X", RegExp::DfaMode::Full).Save(dfaPath);
+
+    std::vector<RegExp> regexps;
+    regexps.emplace_back("[a-z]*X");
+    regexps.emplace_back("[a-z]*X", RegExp::DfaMode::Full);
+    regexps.emplace_back("[a-z]*X|[a-z]*[0-9]{130}");
+    regexps.push_back(RegExp::Load(dfaPath));
+
+    ASSERT_TRUE(regexps[0].Stats().isBitParallel);
+    ASSERT_TRUE(regexps[1].Stats().isFullDfa);
+    ASSERT_FALSE(regexps[2].Stats().isBitParallel);
+    ASSERT_TRUE(regexps[3].Stats().isFullDfa);
+
+    const std::string run(200000, 'a');
+    const std::string text = run + "X";
+
+    std::ofstream(runPath, std::ios::binary) << run;
+
+    for (auto& regexp : regexps)
+    {
+        EXPECT_TRUE(regexp.FindMatches(run).empty()) << regexp.Pattern();
+        EXPECT_TRUE(regexp.FindMatchesParallel(run, 4).empty()) << regexp.Pattern();
+        EXPECT_TRUE(regexp.FindMatchesInFile(runPath).empty()) << regexp.Pattern();
+        EXPECT_TRUE(regexp.Search(run).empty()) << regexp.Pattern();
+
+        EXPECT_EQ(regexp.FindMatches(text), (MatchList{ { 0, text } })) << regexp.Pattern();
+        EXPECT_EQ(regexp.FindMatchesParallel(text, 4), (MatchList{ { 0, text } })) << regexp.Pattern();
+        EXPECT_EQ(regexp.FindMatchRanges(run + "bX"), (RegExp::MatchRangeList{ { 0, text.size() + 1 } }));
+    }
+
+    std::filesystem::remove(dfaPath);
+    std::filesystem::remove(runPath);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, RepetitionLimit)
+{
+    // Expanded, the nested counters would be a million copies of 'a'.
+    EXPECT_THROW(RegExp("((a{100}){100}){100}"), std::runtime_error);
+    EXPECT_THROW(RegExp("((a{100}){100}){100}", RegExp::DfaMode::Full), std::runtime_error);
+    EXPECT_THROW(RegExp("(a{100}){100}"), std::runtime_error);
+
+    const RegExp raised("(a{100}){100}", LazyDFA::kDefaultMemoryBudget, 10000);
+
+    EXPECT_TRUE(raised.Matches(std::string(10000, 'a')));
+    EXPECT_FALSE(raised.Matches(std::string(9999, 'a')));
+
+    EXPECT_THROW(RegExp("a{10}b{10}", LazyDFA::kDefaultMemoryBudget, 9), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, CaptureGroups)
+{
+    using CaptureList = RegExp::CaptureList;
+
+    const RegExp date("([0-9]{4})-([0-9]{2})-([0-9]{2})");
+    const std::string str = "from 2024-03-15 to 2025-11-02";
+
+    EXPECT_EQ(date.GroupCount(), 3);
+    EXPECT_TRUE(date.Stats().isOnePass);
+
+    auto captures = date.FindCaptures(str);
+
+    ASSERT_TRUE(captures.has_value());
+    EXPECT_EQ(*captures, (CaptureList{ { { 5, 10 } }, { { 5, 4 } }, { { 10, 2 } }, { { 13, 2 } } }));
+    EXPECT_EQ((*captures)[2]->Text(str), "03");
+    EXPECT_EQ((*date.FindCaptures(str, 6))[3]->Text(str), "02");
+    EXPECT_FALSE(date.FindCaptures(str, 20).has_value());
+
+    // Groups within the leftmost-longest match, outside the lazy DFA and without the one-pass matcher.
+    const RegExp pairs("(x|xy)(yz|z)*|([a-z]{1,130})=([0-9]+)");
+    auto all = pairs.FindAllCaptures("xyzz key=42");
+
+    EXPECT_FALSE(pairs.Stats().isBitParallel);
+    EXPECT_FALSE(pairs.Stats().isOnePass);
+    ASSERT_EQ(all.size(), 2);
+    EXPECT_EQ(all[0], (CaptureList{ { { 0, 4 } }, { { 0, 1 } }, { { 3, 1 } }, std::nullopt, std::nullopt }));
+    EXPECT_EQ(all[1], (CaptureList{ { { 5, 6 } }, std::nullopt, std::nullopt, { { 5, 3 } }, { { 9, 2 } } }));
+
+    // An option around a loop, with the match found by the lazy DFA and the groups by the PikeVM.
+    const RegExp loop("((ba+)?c)|" + std::string(140, 'z'));
+
+    EXPECT_EQ(loop.FindCaptures("ac"), (CaptureList{ { { 1, 1 } }, { { 1, 1 } }, std::nullopt }));
+    EXPECT_EQ(loop.FindCaptures("xbaac"), (CaptureList{ { { 1, 4 } }, { { 1, 4 } }, { { 1, 3 } } }));
+
+    const RegExp plain("[a-z]+");
+
+    EXPECT_EQ(plain.GroupCount(), 0);
+    EXPECT_EQ(plain.FindCaptures("12 ab"), (CaptureList{ { { 3, 2 } } }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegExpSearchTest, ConcurrentSearches)
+{
+    // One pattern searched through the lazy DFA, one with a budget too small for any DFA state, so that every search
+    // runs the NFA simulation.
+    const RegExp lazy("[a-z]{2,130}[0-9]");
+    const RegExp nfaOnly("(ab|a)*c|[a-c]{2,130}d", 1);
+
+    ASSERT_FALSE(lazy.Stats().isBitParallel);
+    ASSERT_FALSE(nfaOnly.Stats().isBitParallel);
+
+    std::mt19937 random(7);
+    std::string text;
+
+    for (size_t i = 0; i < 20000; ++i)
+        text += "abcd01 "[random() % 7];
+
+    const auto expectedLazy = lazy.FindMatches(text);
+    const auto expectedNfa = nfaOnly.FindMatches(text);
+
+    ASSERT_FALSE(expectedLazy.empty());
+    ASSERT_FALSE(expectedNfa.empty());
+
+    std::atomic<size_t> failures = 0;
+    std::vector<std::thread> threads;
+
+    for (size_t idx = 0; idx < 8; ++idx)
+    {
+        threads.emplace_back([&, idx]
+        {
+            RegExp::Scratch scratch;
+
+            for (size_t round = 0; round < 20; ++round)
+            {
+                auto& regexp = (idx + round) % 2 == 0 ? lazy : nfaOnly;
+                auto& expected = (idx + round) % 2 == 0 ? expectedLazy : expectedNfa;
+
+                if (regexp.FindMatches(text) != expected)
+                    ++failures;
+
+                // A scratch handed from one pattern to the other is reset on its first use.
+                if (regexp.FindMatchRanges(text, scratch).size() != expected.size())
+                    ++failures;
+
+                if (!regexp.Matches(expected[round].second, scratch) || regexp.Matches(expected[round].second + "+"))
+                    ++failures;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(failures, 0);
 }
\ No newline at end of file
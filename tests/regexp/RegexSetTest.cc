@@ -0,0 +1,161 @@
+#include <gtest/gtest.h>
+#include "Ast.h"
+#include "RegexSet.h"
+
+#include <atomic>
+#include <thread>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class RegexSetTest : public testing::Test
+{
+protected:
+    using SetMatch = RegexSet::SetMatch;
+
+protected:
+    RegexSet set_{{ "GET /[a-z/]*", "[A-Z]+ /api/.*", "(GET|POST) .*", "[0-9]+" }};
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegexSetTest, Matches)
+{
+    EXPECT_EQ(set_.Size(), 4);
+
+    EXPECT_EQ(set_.Matches("GET /index"), std::vector<size_t>({ 0, 2 }));
+    EXPECT_EQ(set_.Matches("GET /api/items"), std::vector<size_t>({ 0, 1, 2 }));
+    EXPECT_EQ(set_.Matches("POST /api/v1"), std::vector<size_t>({ 1, 2 }));
+    EXPECT_EQ(set_.Matches("PUT /api/v1"), std::vector<size_t>({ 1 }));
+    EXPECT_EQ(set_.Matches("404"), std::vector<size_t>({ 3 }));
+    EXPECT_TRUE(set_.Matches("HEAD").empty());
+    EXPECT_TRUE(set_.Matches("").empty());
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegexSetTest, LongestMatches)
+{
+    auto matches = set_.LongestMatches("GET /api/v1 HTTP/1.1");
+
+    EXPECT_EQ(matches.size(), 3);
+    EXPECT_EQ(matches[0], SetMatch({ 0, 10 }));
+    EXPECT_EQ(matches[1], SetMatch({ 1, 20 }));
+    EXPECT_EQ(matches[2], SetMatch({ 2, 20 }));
+
+    EXPECT_EQ(set_.LongestMatches("42 GET"), std::vector<SetMatch>({ { 3, 2 } }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegexSetTest, FromAstAndOverBudget)
+{
+    std::vector<AstNode::AstNodePtr> nodes = {
+        RepetitionAst::Make(SymbolAst::Make('a')),
+        ConcatenationAst::Make(SymbolAst::Make('a'), SymbolAst::Make('b'))
+    };
+
+    RegexSet fromAst(nodes);
+
+    EXPECT_EQ(fromAst.Pattern(0), "a*");
+    EXPECT_EQ(fromAst.Matches(""), std::vector<size_t>({ 0 }));
+    EXPECT_EQ(fromAst.Matches("ab"), std::vector<size_t>({ 1 }));
+
+    // Both engines have to agree when the DFA runs out of its budget.
+    RegexSet tiny({ "(a|b)*a(a|b)(a|b)(a|b)", "(a|b)*b", "a+" }, 256);
+
+    EXPECT_EQ(tiny.Matches("abbbabababbbaaab"), std::vector<size_t>({ 0, 1 }));
+    EXPECT_EQ(tiny.Matches("aaaa"), std::vector<size_t>({ 0, 2 }));
+    EXPECT_EQ(tiny.LongestMatches("aaab"), std::vector<SetMatch>({ { 0, 4 }, { 1, 4 }, { 2, 3 } }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegexSetTest, RepetitionLimit)
+{
+    EXPECT_THROW(RegexSet(std::vector<std::string>{ "a", "((a{100}){100}){100}" }), std::runtime_error);
+
+    RegexSet raised({ "a", "(a{100}){100}" }, LazyDFA::kDefaultMemoryBudget, 10000);
+
+    EXPECT_EQ(raised.Matches(std::string(10000, 'a')), std::vector<size_t>({ 1 }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegexSetTest, ConcurrentSearches)
+{
+    // Every thread searches with a DFA cache of its own, handing its scratch back and forth between two sets.
+    const RegexSet other(std::vector<std::string>{ "[a-z]+=[0-9]+", "[a-z]+=.*" });
+    const std::vector<std::string> inputs = { "GET /api/items", "POST /x", "404", "key=42", "key=value", "" };
+
+    std::vector<std::vector<size_t>> expected;
+    std::vector<std::vector<SetMatch>> expectedLongest;
+
+    for (size_t which = 0; which < 2; ++which)
+    {
+        auto& set = which == 0 ? set_ : other;
+
+        for (auto& input : inputs)
+        {
+            expected.push_back(set.Matches(input));
+            expectedLongest.push_back(set.LongestMatches(input));
+        }
+    }
+
+    std::atomic<size_t> failures = 0;
+    std::vector<std::thread> threads;
+
+    for (size_t idx = 0; idx < 8; ++idx)
+    {
+        threads.emplace_back([&, idx]
+        {
+            RegexSet::Scratch scratch;
+
+            for (size_t round = 0; round < 200; ++round)
+            {
+                auto which = (idx + round) % 2;
+                auto& set = which == 0 ? set_ : other;
+                auto& input = inputs[round % inputs.size()];
+                auto result = which * inputs.size() + round % inputs.size();
+
+                if (set.Matches(input) != expected[result] || set.Matches(input, scratch) != expected[result])
+                    ++failures;
+
+                if (set.LongestMatches(input, scratch) != expectedLongest[result])
+                    ++failures;
+            }
+        });
+    }
+
+    for (auto& thread : threads)
+        thread.join();
+
+    EXPECT_EQ(failures, 0);
+    EXPECT_EQ(other.Matches("key=42"), std::vector<size_t>({ 0, 1 }));
+    EXPECT_EQ(other.LongestMatches("key=42 x"), std::vector<SetMatch>({ { 0, 6 }, { 1, 8 } }));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(RegexSetTest, LiteralMembers)
+{
+    RegexSet keywords({ "if|in|int", "in", "for|foreach", "(x)?y|" });
+    RegexSet mixed({ "if|in|int", "in", "for|foreach", "(x)?y|", "z*" });
+
+    for (std::string str : { "", "in", "int", "integer", "foreach", "fore", "y", "xy", "zz" })
+    {
+        auto expected = mixed.Matches(str);
+        std::erase(expected, 4);
+
+        EXPECT_EQ(keywords.Matches(str), expected) << str;
+
+        auto longest = mixed.LongestMatches(str);
+        std::erase_if(longest, [](const SetMatch& match) { return match.id == 4; });
+
+        EXPECT_EQ(keywords.LongestMatches(str), longest) << str;
+    }
+
+    EXPECT_EQ(keywords.Matches("in"), std::vector<size_t>({ 0, 1 }));
+    EXPECT_EQ(keywords.LongestMatches("integer"), std::vector<SetMatch>({ { 0, 3 }, { 1, 2 } }));
+}
\ No newline at end of file
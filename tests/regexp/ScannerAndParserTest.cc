@@ -114,4 +114,89 @@ TEST_F(ScannerAndParserTest, PatternG)
     auto reNode = parseTreeRoot->ConvertToAst();
 
     EXPECT_TRUE(reNode->ToString() == "(a(c|b))*");
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(ScannerAndParserTest, CharacterClasses)
+{
+    Scanner scanner(R"([a-z_][^0-9]\d.\[)");
+    const auto& tokens = scanner.ScanTokens();
+
+    EXPECT_EQ(tokens.size(), 6);
+    EXPECT_TRUE(tokens[0].IsClass());
+    EXPECT_EQ(tokens[0].Class().count(), 27);
+    EXPECT_EQ(tokens[1].Class().count(), 246);
+    EXPECT_EQ(tokens[2].Class(), CharClass::Digits());
+    EXPECT_EQ(tokens[3].Class(), CharClass::AnyButNewline());
+    EXPECT_FALSE(tokens[4].IsClass());
+    EXPECT_TRUE(tokens[4].IsEscaped());
+
+    Parser parser(tokens);
+    auto reNode = parser.Parse()->ConvertToAst();
+
+    EXPECT_EQ(reNode->ToString(), R"([_a-z][^0-9][0-9].[)");
+
+    EXPECT_EQ(Parser(Scanner(R"([\--?\]]+)").ScanTokens()).Parse()->ConvertToAst()->ToString(), R"([\--?\]]+)");
+    EXPECT_EQ(Parser(Scanner(R"(\(a\|b\))").ScanTokens()).Parse()->ConvertToAst()->ToString(), "(a|b)");
+
+    EXPECT_THROW(Scanner("[a-z").ScanTokens(), std::runtime_error);
+    EXPECT_THROW(Scanner("[z-a]").ScanTokens(), std::runtime_error);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(ScannerAndParserTest, Counters)
+{
+    Scanner scanner(R"(a{3}b{2,}c{0,4}\{1}{x)");
+    const auto& tokens = scanner.ScanTokens();
+
+    EXPECT_EQ(tokens.size(), 12);
+    EXPECT_TRUE(tokens[1].IsCounter());
+    EXPECT_EQ(tokens[1].MinCount(), 3);
+    EXPECT_EQ(tokens[1].MaxCount(), 3);
+    EXPECT_EQ(tokens[3].MinCount(), 2);
+    EXPECT_EQ(tokens[3].MaxCount(), Token::kUnbounded);
+    EXPECT_EQ(tokens[5].MinCount(), 0);
+    EXPECT_EQ(tokens[5].MaxCount(), 4);
+    EXPECT_FALSE(tokens[6].IsCounter());
+    EXPECT_TRUE(tokens[6].IsEscaped());
+    EXPECT_EQ(tokens[8].Symbol(), '}');
+    EXPECT_EQ(tokens[9].Symbol(), '{');
+
+    Parser parser(tokens);
+    auto reNode = parser.Parse()->ConvertToAst();
+
+    EXPECT_EQ(reNode->ToString(), "a{3}b{2,}c{0,4}{1}{x");
+
+    EXPECT_EQ(Parser(Scanner("(ab|c){2,5}").ScanTokens()).Parse()->ConvertToAst()->ToString(), "(ab|c){2,5}");
+
+    EXPECT_THROW(Parser(Scanner("a{2}{3}").ScanTokens()).Parse(), std::runtime_error);
+    EXPECT_THROW(Parser(Scanner("{2}").ScanTokens()).Parse(), std::runtime_error);
+    EXPECT_THROW(Scanner("a{3,2}").ScanTokens(), std::runtime_error);
+    EXPECT_THROW(Scanner("a{1001}").ScanTokens(), std::runtime_error);
+    EXPECT_THROW(Scanner("a{99999999999999999999999}").ScanTokens(), std::runtime_error);
+    EXPECT_THROW(Scanner("a{0,20}", 10).ScanTokens(), std::runtime_error);
+    EXPECT_NO_THROW(Scanner("a{20,}", 20).ScanTokens());
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(ScannerAndParserTest, NestedCounters)
+{
+    auto toAst = [](const std::string& pattern, size_t maxRepeatCount)
+    {
+        return Parser(Scanner(pattern, maxRepeatCount).ScanTokens(), maxRepeatCount).Parse()->ConvertToAst();
+    };
+
+    // Every count is within the limit, their product is not; the pattern is rejected before anything is expanded.
+    EXPECT_THROW(toAst("((a{100}){100}){100}", Scanner::kDefaultMaxRepeatCount), std::runtime_error);
+    EXPECT_THROW(toAst("(ab){501}", Scanner::kDefaultMaxRepeatCount), std::runtime_error);
+    EXPECT_THROW(toAst("(a{10}b){10}", 100), std::runtime_error);
+    EXPECT_THROW(toAst("([ab]{5,}c?){0,10}", 59), std::runtime_error);
+
+    EXPECT_EQ(toAst("(ab){500}", Scanner::kDefaultMaxRepeatCount)->ExpandedSize(), 1000);
+    EXPECT_EQ(toAst("(a{10}|b){9}", 100)->ExpandedSize(), 99);
+    EXPECT_EQ(toAst("([ab]{5,}c?){0,10}", 60)->ExpandedSize(), 60);
+    EXPECT_EQ(toAst("((a{100}){100}){100}", 1000000)->ExpandedSize(), 1000000);
 }
\ No newline at end of file
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+#include "StreamMatcher.h"
+
+#include <random>
+
+using namespace Regex;
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+class StreamMatcherTest : public testing::Test
+{
+protected:
+    using Offsets = std::vector<std::pair<size_t, size_t>>;
+
+protected:
+    static Offsets Expected(const RegExp& regexp, const std::string& str)
+    {
+        Offsets result;
+
+        for (auto& [pos, match] : regexp.FindMatches(str))
+            result.emplace_back(pos, match.size());
+
+        return result;
+    }
+
+    static Offsets Streamed(const RegExp& regexp, const std::string& str, size_t chunkSize)
+    {
+        Offsets result;
+        StreamMatcher matcher(regexp, [&result](size_t offset, size_t length)
+        {
+            result.emplace_back(offset, length);
+        });
+
+        for (size_t pos = 0; pos < str.size(); pos += chunkSize)
+            matcher.Feed(std::string_view(str).substr(pos, chunkSize));
+
+        matcher.Finish();
+        return result;
+    }
+};
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(StreamMatcherTest, SameAsFindMatches)
+{
+    const std::vector<std::string> patterns = {
+        "abc", "a+b*", "(ab|a)(bc|c)*", "[0-9]+\\.?[0-9]*", "ERROR [a-z]+", "x*y?", "(a|b)*a(a|b)(a|b)", "ab|abc|c"
+    };
+
+    std::mt19937 random(42);
+    const std::string alphabet = "abcxy01.ERO ";
+
+    for (auto& pattern : patterns)
+    {
+        RegExp regexp(pattern);
+        RegExp fullRegexp(pattern, RegExp::DfaMode::Full);
+
+        for (int round = 0; round < 20; ++round)
+        {
+            std::string str;
+
+            for (int idx = 0; idx < 300; ++idx)
+                str += alphabet[random() % alphabet.size()];
+
+            str += "ERROR abc 12.5 ";
+            auto expected = Expected(regexp, str);
+
+            for (size_t chunkSize : { 1, 2, 3, 7, 64, 1000 })
+            {
+                EXPECT_EQ(Streamed(regexp, str, chunkSize), expected) << pattern << " / " << chunkSize;
+                EXPECT_EQ(Streamed(fullRegexp, str, chunkSize), expected) << pattern << " / " << chunkSize;
+            }
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(StreamMatcherTest, BoundedBuffer)
+{
+    RegExp regexp("ERROR [0-9]+");
+    size_t count = 0;
+    size_t maxBuffered = 0;
+
+    StreamMatcher matcher(regexp, [&count](size_t offset, size_t length)
+    {
+        EXPECT_EQ(offset % 22, 0);
+        EXPECT_EQ(length, 9);
+        ++count;
+    });
+
+    for (int idx = 0; idx < 10000; ++idx)
+    {
+        matcher.Feed("ERROR 123");
+        matcher.Feed(" ok ok ok ok\n");
+        maxBuffered = std::max(maxBuffered, matcher.BufferedSize());
+    }
+
+    matcher.Finish();
+
+    EXPECT_EQ(count, 10000);
+    EXPECT_LT(maxBuffered, 22);
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(StreamMatcherTest, OverBudget)
+{
+    // The budget does not hold the states of one match, the NFA simulation takes over.
+    RegExp regexp("(a|b)*a(a|b)(a|b)(a|b)(a|b)", 256);
+    std::string str = "babbbabaabababbbabbbbbaabaabbbaaaaabababbb  abbbba b";
+
+    for (size_t chunkSize : { 1, 5, 100 })
+        EXPECT_EQ(Streamed(regexp, str, chunkSize), Expected(regexp, str));
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(StreamMatcherTest, LinearInTheInput)
+{
+    // Restarted at every offset, the search would read the whole run once per offset.
+    std::string run;
+
+    for (int idx = 0; idx < 20000; ++idx)
+        run += "ab";
+
+    for (auto dfaMode : { RegExp::DfaMode::Lazy, RegExp::DfaMode::Full })
+    {
+        RegExp regexp("(a|b)*c", dfaMode);
+
+        EXPECT_TRUE(Streamed(regexp, run, 16).empty());
+        EXPECT_EQ(Streamed(regexp, run + "c", 16), (Offsets{ { 0, run.size() + 1 } }));
+    }
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+
+TEST_F(StreamMatcherTest, TrimsDeadGroups)
+{
+    // Every 'a' starts a group, so the DFA never gets back to its start state, but each group dies within a few bytes.
+    RegExp regexp("ab[0-9]+c");
+    size_t count = 0;
+    size_t maxBuffered = 0;
+
+    StreamMatcher matcher(regexp, [&count](size_t offset, size_t length)
+    {
+        EXPECT_EQ(offset, 30000);
+        EXPECT_EQ(length, 4);
+        ++count;
+    });
+
+    for (int idx = 0; idx < 10000; ++idx)
+    {
+        matcher.Feed("ab1");
+        maxBuffered = std::max(maxBuffered, matcher.BufferedSize());
+    }
+
+    matcher.Feed("ab1c");
+    matcher.Finish();
+
+    EXPECT_EQ(count, 1);
+    EXPECT_LT(maxBuffered, 2 * StreamMatcher::kMinTrimSize);
+}
\ No newline at end of file
@@ -0,0 +1,41 @@
+#pragma once
+#include "Glushkov.h"
+#include "Parser.h"
+#include "Scanner.h"
+
+#include <string>
+#include <string_view>
+
+namespace Regex::Testing
+{
+// ---------------------------------------------------------------------------------------------------------------------
+
+// AST of the pattern as the Parser builds it, before the Optimizer. The number of capture groups is stored to
+// groupCount when given.
+inline AstNode::AstNodePtr ParsePattern(std::string_view pattern, size_t* groupCount = nullptr)
+{
+    Scanner scanner{std::string(pattern)};
+    Parser parser(scanner.ScanTokens());
+    auto ast = parser.Parse()->ConvertToAst();
+
+    if (groupCount != nullptr)
+        *groupCount = parser.GroupCount();
+
+    return ast;
+}
+
+inline NFA CompileNfa(std::string_view pattern)
+{
+    return ParsePattern(pattern)->ToNFA();
+}
+
+inline Glushkov CompileGlushkov(std::string_view pattern)
+{
+    Glushkov glushkov;
+    glushkov.SetRoot(ParsePattern(pattern)->BuildPositions(glushkov));
+
+    return glushkov;
+}
+
+// ---------------------------------------------------------------------------------------------------------------------
+} // namespace Regex::Testing
\ No newline at end of file